@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace runtime {
+
+// Arbitrary precision integer: the sign and the magnitude in base 2^32 digits,
+// the least significant digit first. Zero has no digits and is not negative
+class BigInteger {
+public:
+    BigInteger() = default;
+    BigInteger(int64_t value);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+    // Returns the value of the decimal digits, optionally preceded by a minus.
+    // If there are no digits or something else, invalid_argument is thrown
+    [[nodiscard]] static BigInteger FromString(std::string_view decimal);
+
+    // Returns true if the value is in the range of int64_t
+    [[nodiscard]] bool FitsInt64() const;
+    // Returns the value as int64_t. The value must fit into it
+    [[nodiscard]] int64_t ToInt64() const;
+    // Returns the nearest double value
+    [[nodiscard]] double ToDouble() const;
+
+    [[nodiscard]] bool IsZero() const;
+    [[nodiscard]] bool IsNegative() const;
+
+    // Returns -1, 0 or 1 if this number is less, equal or greater than rhs
+    [[nodiscard]] int Compare(const BigInteger& rhs) const;
+
+    // Returns the hash of the value
+    [[nodiscard]] size_t Hash() const;
+
+    // Returns the decimal representation of the value
+    [[nodiscard]] std::string ToString() const;
+
+    friend BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs);
+    // Multiplication switches from the schoolbook method to the Karatsuba one
+    // for the operands longer than KARATSUBA_THRESHOLD digits
+    friend BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs);
+    // Division truncates towards zero like the division of the builtin integers.
+    // If rhs is 0, a runtime_error exception is thrown
+    friend BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs);
+
+    static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+private:
+    using Digits = std::vector<uint32_t>;
+
+    BigInteger(bool negative, Digits digits);
+
+    bool negative_ = false;
+    Digits digits_;
+};
+
+bool operator==(const BigInteger& lhs, const BigInteger& rhs);
+bool operator<(const BigInteger& lhs, const BigInteger& rhs);
+
+std::ostream& operator<<(std::ostream& os, const BigInteger& value);
+
+}  // namespace runtime
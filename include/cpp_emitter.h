@@ -0,0 +1,23 @@
+#pragma once
+
+#include "statement.h"
+
+#include <ostream>
+
+namespace ast {
+
+/*
+ * Writes the program as a standalone C++17 translation unit (mython --emit-cpp).
+ * Built together with the runtime and statement sources, it writes to stdout exactly what
+ * the interpreter writes to its output file.
+ * The values stay boxed, so the program keeps the semantics of the interpreter: what goes away
+ * is the tree and the lookups. Every statement becomes straight-line C++ code calling the
+ * operations declared in statement.h, every variable becomes a C++ variable and every method
+ * a C++ function, which the classes are created with as method bodies. The calls which can be
+ * resolved from the program call these functions directly, and the operations proven by
+ * InferTypes (see type_inference.h), when it has run before, are made on the C++ values.
+ * If the program contains a statement which can't be written, runtime_error is thrown
+ */
+void EmitCpp(const Statement& program, std::ostream& out);
+
+}  // namespace ast
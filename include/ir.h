@@ -0,0 +1,182 @@
+#pragma once
+
+#include "statement.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ast {
+
+/*
+ * Mid-level IR of the program in SSA form, built from the tree after parsing (see
+ * OptimizeProgram). The program and every method body become a Function: a sequence of
+ * instructions in which every version of a variable is defined once, by an assignment (COPY)
+ * or where the control flow joins (PHI). The control flow stays structured: the branches of if,
+ * the bodies of for and the right operands of and/or are enclosed in markers, so a pass
+ * knows which instructions dominate which.
+ * The passes rewrite the instructions in place. Every instruction keeps the node it was built
+ * from, and the lowering rebuilds the nodes of the changed instructions and removes the
+ * statements of the removed ones. The tree is the input of every backend, so walking it,
+ * lowering it into closures and writing it as C++ all execute the optimized program
+ */
+namespace ir {
+
+struct Instruction;
+
+// The version of every variable at an instruction
+using Environment = std::unordered_map<std::string, Instruction*>;
+
+enum class Opcode : uint8_t {
+    // The value of a variable which has not been assigned: reading it throws
+    UNDEFINED,
+    // A value not known ahead: self, a parameter, a loop item or a class
+    PARAMETER,
+    CONSTANT,
+    // The read of a variable, operands[0] is its version
+    VARIABLE,
+    // The read of the fields of a variable, operands[0] is the version of the variable
+    LOAD,
+    // An assignment, which defines a version of the variable from operands[0]
+    COPY,
+    // The version of the variable where the control flow joins, one operand per path
+    PHI,
+    // An operator (see Operation) on the operands
+    OPERATION,
+    // A method call, a new instance or a builtin object made of the operands
+    CALL,
+    // A field assignment of operands[1] to the object operands[0]
+    STORE,
+    PRINT,
+    RETURN,
+    // Markers of the control flow: IF has the condition as operands[0], LOOP the iterable,
+    // SCOPE encloses the right operand of and/or. Each of them is closed by END
+    IF,
+    ELSE,
+    LOOP,
+    SCOPE,
+    END,
+};
+
+enum class Operation : uint8_t { ADD, SUB, MULT, DIV, COMPARE, AND, OR, NOT, STR };
+
+// The place of a statement in the compound instruction holding it
+struct Position {
+    Compound* compound = nullptr;
+    size_t index = 0;
+    // The number of the compound instructions enclosing the statement
+    size_t depth = 0;
+};
+
+struct Instruction {
+    Opcode opcode = Opcode::UNDEFINED;
+    // The values used by the instruction. Those which are expressions of the same statement
+    // have the instruction as their user
+    std::vector<Instruction*> operands;
+    // The variable defined by COPY, PHI and PARAMETER, the temporary holding a hoisted LOAD
+    std::string name;
+    // The fields of LOAD
+    std::vector<std::string> fields;
+    // The value of CONSTANT
+    runtime::ObjectHolder constant;
+    Operation operation = Operation::ADD;
+    runtime::CompareOperation comparison = runtime::CompareOperation::EQUAL;
+
+    // The node the instruction is built from, the holder owning it and the node owning that.
+    // The slot is nullptr if the node can't be replaced
+    Statement* node = nullptr;
+    std::unique_ptr<Statement>* slot = nullptr;
+    Statement* parent = nullptr;
+    // The instruction whose operand this one is. For a statement it is the marker of the
+    // branch or loop holding it
+    Instruction* user = nullptr;
+    Position position;
+    // The versions of the variables before VARIABLE and LOAD
+    std::shared_ptr<const Environment> environment;
+    // The instruction is a whole statement
+    bool statement = false;
+    // Nothing observable happens in the statement before the LOAD, so it may be moved
+    // in front of the statement
+    bool hoistable = false;
+    // The CALL may run a method of the program, which may assign any field
+    bool writes_memory = false;
+    // The value is printed before the next argument of its PRINT is evaluated, and printing
+    // an instance runs its __str__, which may assign any field
+    bool printed = false;
+
+    // Set by the passes: the node is rebuilt from the instruction, the statement is removed,
+    // the IF whose condition is constant takes the branch
+    bool changed = false;
+    bool removed = false;
+    std::optional<bool> taken;
+};
+
+struct Function {
+    // The class and the method, empty for the program
+    std::string name;
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    // The body is a single return, which stays one so that the calls may still inline it
+    bool single_return = false;
+    // The body has a node the IR does not model, the passes leave it alone
+    bool opaque = false;
+};
+
+// Returns true if the instruction, or one of those whose operand it is, has been removed
+// or replaced by a constant
+[[nodiscard]] bool IsDetached(const Instruction& instruction);
+
+class Pass {
+public:
+    virtual ~Pass() = default;
+
+    [[nodiscard]] virtual std::string_view GetName() const = 0;
+    // Transforms the function and returns the number of the changes made
+    virtual size_t Run(Function& function) = 0;
+};
+
+class PassManager {
+public:
+    // The most times the passes are run over a function
+    static constexpr size_t MAX_ROUNDS = 4;
+
+    void AddPass(std::unique_ptr<Pass> pass);
+    // Runs the passes in order over every function, and again while they change it.
+    // Their changes are added to ir_stats
+    void Run(std::vector<Function>& functions);
+
+private:
+    std::vector<std::unique_ptr<Pass>> passes_;
+};
+
+// Makes the pass of the name: constprop, copyprop, cse or dce.
+// If there is no such pass, runtime_error is thrown
+[[nodiscard]] std::unique_ptr<Pass> MakePass(std::string_view name);
+
+// The passes run by default, in order
+[[nodiscard]] std::vector<std::string> StandardPipeline();
+
+}  // namespace ir
+
+// Counters of the IR, printed by mython --stats
+struct IrStats {
+    struct PassStats {
+        std::string name;
+        uint64_t changes = 0;
+    };
+
+    uint64_t functions = 0;
+    uint64_t instructions = 0;
+    std::vector<PassStats> passes;
+};
+
+inline IrStats ir_stats;
+
+// Builds the IR of the program and of the methods of its classes, runs the passes of the
+// names on it and lowers it back into the tree. With no passes the tree is left as it is
+void OptimizeProgram(Statement& program,
+                     const std::vector<std::string>& passes = ir::StandardPipeline());
+
+}  // namespace ast
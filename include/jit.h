@@ -0,0 +1,41 @@
+#pragma once
+
+#include "statement.h"
+
+#include <cstdint>
+#include <string>
+
+namespace ast {
+
+/*
+ * Baseline JIT of the method bodies, on x86-64 Linux. When a method has become hot (see
+ * Tiering), its body is compiled into machine code from a template per statement: the values
+ * stay boxed in the slots of a native frame, the integer arithmetic and the comparisons
+ * of two Numbers are made inline, and everything else calls the operations of statement.h.
+ * A recursive call in the tail position jumps back to the start of the code, as MethodBody
+ * starts over. A body with a statement the templates don't cover (a loop, a class definition)
+ * is not compiled, and is lowered into closures instead.
+ * With perf_map set, every compiled body is written into /tmp/perf-<pid>.map, so that perf
+ * attributes the samples in the machine code to the Mython methods
+ */
+struct Jit {
+    // Compile the hot method bodies into machine code where the platform allows it,
+    // set by mython --jit
+    bool enabled = false;
+    bool perf_map = false;
+    // The number of the method bodies compiled and the size of their code,
+    // printed by mython --stats
+    uint64_t compiled_methods = 0;
+    uint64_t code_bytes = 0;
+};
+
+inline Jit jit;
+
+// Returns true if the JIT can compile on this platform
+[[nodiscard]] bool IsJitSupported();
+
+// Compiles the body of the method into machine code. The code returns the result of the method.
+// Returns an empty function if the body can't be compiled
+[[nodiscard]] runtime::Compiled CompileNative(const MethodBody& method);
+
+}  // namespace ast
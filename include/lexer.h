@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
@@ -12,7 +13,15 @@ namespace parse {
 
 namespace token_type {
 struct Number {  // Lexeme "number"
-    int value;   // number
+    int64_t value;   // number
+};
+
+struct Float {  // Lexeme "floating point number"
+    double value;
+};
+
+struct BigNumber {  // Lexeme "number" too large for int64_t
+    std::string value;  // decimal digits
 };
 
 struct Id {             // lexeme "identificator"
@@ -47,17 +56,21 @@ struct GreaterOrEq {};  // lexeme «>=»
 struct None {};         // lexeme «None»
 struct True {};         // lexeme «True»
 struct False {};        // lexeme «False»
+struct For {};          // lexeme «for»
+struct In {};           // lexeme «in»
 }  // namespace token_type
 
 
 
 using TokenBase
-    = std::variant<token_type::Number, token_type::Id, token_type::Char, token_type::String,
-                   token_type::Class, token_type::Return, token_type::If, token_type::Else,
+    = std::variant<token_type::Number, token_type::Float, token_type::BigNumber, token_type::Id,
+                   token_type::Char,
+                   token_type::String, token_type::Class, token_type::Return, token_type::If, token_type::Else,
                    token_type::Def, token_type::Newline, token_type::Print, token_type::Indent,
                    token_type::Dedent, token_type::And, token_type::Or, token_type::Not,
                    token_type::Eq, token_type::NotEq, token_type::LessOrEq, token_type::GreaterOrEq,
-                   token_type::None, token_type::True, token_type::False, token_type::Eof>;
+                   token_type::None, token_type::True, token_type::False, token_type::For,
+                   token_type::In, token_type::Eof>;
 
 struct Token : TokenBase {
     using TokenBase::TokenBase;
@@ -160,6 +173,8 @@ private:
     void ParseIndent();
     // processes a meaningful token
     void ParseToken();
+    // processes the number (integer or floating point)
+    void ParseNumber();
     // processes the name (keyword or identifier)
     void ParseName();
     // processes the symbol
@@ -183,7 +198,9 @@ static std::unordered_map<std::string, parse::Token> KeyWords =
  {"not",     parse::token_type::Not{}},
  {"None",    parse::token_type::None{}},
  {"True",    parse::token_type::True{}},
- {"False",   parse::token_type::False{}}
+ {"False",   parse::token_type::False{}},
+ {"for",     parse::token_type::For{}},
+ {"in",      parse::token_type::In{}}
 };
 
 static std::unordered_map<std::string, parse::Token> DualSymbols =
@@ -206,8 +223,11 @@ bool IsAlNumLL(char ch);
 std::string ReadString(std::istream &input);
 // reads an identifier consisting of letters, numbers and underscores
 std::string ReadName(std::istream &input);
-// reads an integer
-int ReadNumber(std::istream &input);
+// reads a sequence of decimal digits
+std::string ReadDigits(std::istream &input);
+// reads a 64-bit integer or, if the literal has a fractional part or an exponent, a double.
+// The digits of an integer too large for int64_t are returned as they are
+std::variant<int64_t, double, std::string> ReadNumber(std::istream &input);
 // counts all consecutive spaces in the string and returns the number of spaces
 size_t CountSpaces(std::istream &input);
 // reads the whole string
@@ -1,9 +1,19 @@
 #pragma once
 
+#include "bigint.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace runtime {
@@ -21,9 +31,33 @@ protected:
 // A base class for all Mython objects
 class Object {
 public:
+    Object() = default;
+    // The reference count belongs to the object location, so it is not copied
+    Object(const Object& /*other*/) noexcept {
+    }
+    Object& operator=(const Object& /*other*/) noexcept {
+        return *this;
+    }
+
     virtual ~Object() = default;
     // outputs its representation as a string to the os
     virtual void Print(std::ostream &os, Context &context) = 0;
+
+    // Objects are allocated from the object pool: most of them are small and short-lived,
+    // so a size class free list or a pointer bump of the current chunk replaces malloc
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size) noexcept;
+
+private:
+    friend class ObjectHolder;
+    friend class Heap;
+
+    // Objects which were not created by ObjectHolder::Own (on the stack, class members,
+    // preallocated values) are immortal: holders never count or delete them
+    static constexpr uint32_t IMMORTAL = UINT32_MAX;
+
+    // Intrusive (non-atomic) count of the holders referring to the object
+    uint32_t ref_count_ = IMMORTAL;
 };
 
 // A special wrapper class for storing an object in a Mython program
@@ -32,15 +66,44 @@ public:
     // Creates an empty value
     ObjectHolder() = default;
 
+    ObjectHolder(const ObjectHolder& other) noexcept
+        : data_(other.data_)
+        , counted_(other.counted_) {
+        Retain();
+    }
+
+    ObjectHolder(ObjectHolder&& other) noexcept
+        : data_(other.data_)
+        , counted_(other.counted_) {
+        other.data_ = nullptr;
+        other.counted_ = false;
+    }
+
+    ObjectHolder& operator=(const ObjectHolder& other) noexcept {
+        ObjectHolder copy(other);
+        Swap(copy);
+        return *this;
+    }
+
+    ObjectHolder& operator=(ObjectHolder&& other) noexcept {
+        Swap(other);
+        return *this;
+    }
+
+    ~ObjectHolder() {
+        Release();
+    }
+
     // Returns an ObjectHolder that owns an object of type T
     // The T type is a specific successor class to Object.
     // object is copied or moved to the heap
     template <typename T>
-    [[nodiscard]] static ObjectHolder Own(T &&object) {
-        return ObjectHolder(std::make_shared<T>(std::forward<T>(object)));
-    }
+    [[nodiscard]] static ObjectHolder Own(T &&object);
 
-    // Creates an ObjectHolder that does not own the object (analogous to a weak reference)
+    // Creates an ObjectHolder that refers to the object.
+    // If the object is owned by other holders, the new holder shares the ownership,
+    // otherwise the holder does not count it and the object must outlive the uses of the holder
+    // (analogous to a weak reference). Destroying such a holder never touches the object
     [[nodiscard]] static ObjectHolder Share(Object &object);
     // Creates an empty ObjectHolder corresponding to the value None
     [[nodiscard]] static ObjectHolder None();
@@ -51,7 +114,9 @@ public:
 
     Object* operator->() const;
 
-    [[nodiscard]] Object* Get() const;
+    [[nodiscard]] Object* Get() const {
+        return data_;
+    }
 
     // Returns a pointer to an object of type T or nullptr if the ObjectHolder does not store
     // object of this type
@@ -61,15 +126,175 @@ public:
     }
 
     // Returns true if ObjectHolder is not empty
-    explicit operator bool() const;
+    explicit operator bool() const {
+        return data_ != nullptr;
+    }
 
 private:
-    explicit ObjectHolder(std::shared_ptr<Object> data);
+    // Takes a new reference to the object
+    explicit ObjectHolder(Object* data) noexcept
+        : data_(data)
+        , counted_(data != nullptr && data->ref_count_ != Object::IMMORTAL) {
+        Retain();
+    }
+
     void AssertIsValid() const;
 
-    std::shared_ptr<Object> data_;
+    void Swap(ObjectHolder& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(counted_, other.counted_);
+    }
+
+    void Retain() noexcept {
+        if (counted_) {
+            ++data_->ref_count_;
+        }
+    }
+
+    // A holder which does not count the object never touches it again: the object may
+    // already be gone, as the holders of an immortal object may outlive it
+    void Release() noexcept {
+        if (counted_ && --data_->ref_count_ == 0) {
+            delete data_;
+        }
+    }
+
+    Object* data_ = nullptr;
+    // The holder counts a reference to the object, i.e. the object was created by Own
+    bool counted_ = false;
+};
+
+/*
+ * A base class for objects referring to other objects (class instances, dictionaries).
+ * The containers created by ObjectHolder::Own are tracked by the heap,
+ * which finds and frees the reference cycles among them
+ */
+class Container : public Object {
+public:
+    Container() = default;
+    // The copy is a different object, so it is not tracked
+    Container(const Container& other) noexcept
+        : Object(other) {
+    }
+    Container& operator=(const Container& /*other*/) noexcept {
+        return *this;
+    }
+
+    ~Container() override;
+
+    // Calls visit for every object holder stored in the container
+    virtual void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) const = 0;
+    // Releases all the stored objects. Used to break unreachable cycles
+    virtual void ClearReferences() = 0;
+
+private:
+    friend class Heap;
+
+    bool tracked_ = false;
+    bool reachable_ = false;
+    uint8_t generation_ = 0;
+    int64_t gc_refs_ = 0;
+    Container* gc_prev_ = nullptr;
+    Container* gc_next_ = nullptr;
+};
+
+/*
+ * Registry of the owned containers and their generational cycle collector.
+ * Reference counting frees all the acyclic garbage right away, the collector is needed
+ * for the cycles only. It does not scan the roots (frames, closures, constants of the AST):
+ * a container is a root if its reference count is greater than the number of references
+ * from other containers of the collected generations, i.e. something outside refers to it.
+ * Everything reachable from the roots survives, and the references of the rest are cleared,
+ * which breaks the cycles and lets the reference counts free them.
+ *
+ * New containers are young. Most of them die young, so a minor collection scans
+ * the young generation only (references from the old containers are roots) and promotes
+ * the survivors to the old generation, which is scanned by the rarer major collections
+ */
+class Heap {
+public:
+    struct Stats {
+        size_t minor_collections = 0;
+        size_t major_collections = 0;
+        // The number of containers freed by the collector
+        size_t collected = 0;
+        // The number of young containers moved to the old generation
+        size_t promoted = 0;
+        // Total and longest collection pauses
+        double total_pause_ms = 0;
+        double max_pause_ms = 0;
+        // Pauses of every minor collection
+        std::vector<double> minor_pauses_ms;
+    };
+
+    // A minor collection starts automatically every DEFAULT_THRESHOLD container allocations
+    static constexpr size_t DEFAULT_THRESHOLD = 10000;
+    // Every MAJOR_COLLECTION_PERIOD automatic collection is a major one
+    static constexpr size_t MAJOR_COLLECTION_PERIOD = 10;
+
+    // Sets the number of container allocations between automatic collections.
+    // 0 turns the automatic collections off
+    void SetThreshold(size_t threshold);
+    [[nodiscard]] size_t GetThreshold() const;
+
+    // Major collection: frees all the unreachable containers and returns their number
+    size_t Collect();
+    // Minor collection: frees the unreachable young containers, promotes the rest to
+    // the old generation and returns the number of freed containers
+    size_t CollectYoung();
+
+    // Called by ObjectHolder::Own before allocating a container
+    void OnAllocation();
+    void Track(Container& container);
+    void Untrack(Container& container);
+
+    // Returns the number of containers currently tracked
+    [[nodiscard]] size_t GetTrackedCount() const;
+    // Returns the number of containers in the young generation
+    [[nodiscard]] size_t GetYoungCount() const;
+    [[nodiscard]] const Stats& GetStats() const;
+    // Returns the given percentile (0-100) of the minor collection pauses
+    [[nodiscard]] double GetMinorPausePercentile(double percentile) const;
+
+private:
+    enum Generation : uint8_t { YOUNG, OLD };
+
+    size_t CollectGenerations(Generation oldest);
+
+    Container* heads_[2] = {nullptr, nullptr};
+    size_t counts_[2] = {0, 0};
+    size_t threshold_ = DEFAULT_THRESHOLD;
+    size_t allocations_ = 0;
+    size_t automatic_collections_ = 0;
+    bool collecting_ = false;
+    Stats stats_;
+};
+
+inline Heap heap;
+
+// Counters of the runtime objects allocations
+struct AllocationStats {
+    // The number of objects placed in the heap by ObjectHolder::Own
+    size_t allocated = 0;
 };
 
+inline AllocationStats allocation_stats;
+
+template <typename T>
+ObjectHolder ObjectHolder::Own(T &&object) {
+    using Type = std::decay_t<T>;
+    ++allocation_stats.allocated;
+    if constexpr (std::is_base_of_v<Container, Type>) {
+        heap.OnAllocation();
+    }
+    Type* data = new Type(std::forward<T>(object));
+    data->ref_count_ = 0;
+    if constexpr (std::is_base_of_v<Container, Type>) {
+        heap.Track(*data);
+    }
+    return ObjectHolder(data);
+}
+
 // A value object storing a value of type T
 template <typename T>
 class ValueObject : public Object {
@@ -97,6 +322,11 @@ using Closure = std::unordered_map<std::string, ObjectHolder>;
 // For non-zero numbers, True and non-empty strings returns true. In other cases it returns false.
 bool IsTrue(const ObjectHolder &object);
 
+// An executable lowered into a callable bound to the data it needs, see Executable::Compile
+using Compiled = std::function<ObjectHolder(Closure&, Context&)>;
+
+class Class;
+
 // Interface to perform actions on Mython objects
 class Executable {
 public:
@@ -104,12 +334,65 @@ public:
     // Performs an action on the objects inside the closure, using the context
     // Returns the resulting value either None
     virtual ObjectHolder Execute(Closure &closure, Context &context) = 0;
+
+    // Returns a callable which performs the same action as Execute. The executable must outlive it.
+    // By default the callable just executes the executable, the statements override it
+    // to call the compiled children directly instead of walking the tree
+    virtual Compiled Compile();
+
+    // Returns true if executing the statement in a method of the class has no effects
+    // and its result depends only on the values of the variables (see Memoization).
+    // By default a statement is not pure, the statements which can be override it
+    [[nodiscard]] virtual bool IsPure(const Class& cls) const;
+
+    // Returns the number of nodes of the statement if it is an expression made only of values,
+    // variables and operators, which can be evaluated in place of a call of the method returning
+    // it, otherwise 0. By default a statement is not such an expression
+    [[nodiscard]] virtual size_t ExpressionSize() const;
+};
+
+/*
+ * String value.
+ * A concatenation does not copy its operands: it makes a rope node referring to both of them.
+ * The rope is flattened into a single std::string only when the value is observed
+ * (GetValue, Print) and the flat value is cached, so building a string by repeated
+ * concatenation takes linear time instead of quadratic
+ */
+class String : public Object {
+public:
+    String(std::string value);  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+
+    // Returns the concatenation lhs + rhs in O(1)
+    [[nodiscard]] static String Concat(const String& lhs, const String& rhs);
+
+    void Print(std::ostream& os, Context& context) override;
+
+    // Returns the flat value, flattening the rope on the first call
+    [[nodiscard]] const std::string& GetValue() const;
+
+    // Returns the length of the string without flattening it
+    [[nodiscard]] size_t Size() const;
+
+private:
+    struct Node;
+
+    explicit String(std::shared_ptr<Node> node);
+
+    std::shared_ptr<Node> node_;
 };
 
-// String value
-using String = ValueObject<std::string>;
 // Numerical value
-using Number = ValueObject<int>;
+using Number = ValueObject<int64_t>;
+// Integer value which does not fit into Number
+using BigInt = ValueObject<BigInteger>;
+
+// Floating point value
+class Float : public ValueObject<double> {
+public:
+    using ValueObject<double>::ValueObject;
+    // Prints the shortest representation which is read back to the same value
+    void Print(std::ostream& os, Context& context) override;
+};
 
 // Logical value
 class Bool : public ValueObject<bool> {
@@ -118,6 +401,153 @@ public:
     void Print(std::ostream& os, Context& context) override;
 };
 
+// Types of the builtin values, told apart by the exact type instead of dynamic_cast
+enum class ValueKind { BOOL, NUMBER, BIG_INT, FLOAT, STRING, OTHER, COUNT };
+
+// Returns the kind of the value. None, class instances and the other objects are OTHER
+[[nodiscard]] ValueKind GetKind(const ObjectHolder& object);
+
+// Returns the canonical True or False object. They are never reallocated
+[[nodiscard]] ObjectHolder MakeBool(bool value);
+
+// Returns a Number object. Values from SMALL_NUMBER_MIN to SMALL_NUMBER_MAX
+// are taken from a preallocated cache, other values are allocated
+[[nodiscard]] ObjectHolder MakeNumber(int64_t value);
+
+constexpr int64_t SMALL_NUMBER_MIN = -5;
+constexpr int64_t SMALL_NUMBER_MAX = 1024;
+
+// Returns a Number if the value fits into it, otherwise a BigInt
+[[nodiscard]] ObjectHolder MakeInteger(const BigInteger& value);
+
+enum class ArithmeticOperation { ADD, SUB, MULT, DIV };
+
+/*
+ * Performs the operation on two integers of any size (Number or BigInt).
+ * The result is promoted to BigInt only if it does not fit into Number.
+ * Returns None if any of the arguments is not an integer.
+ * Division by zero throws a runtime_error exception
+ */
+[[nodiscard]] ObjectHolder IntegerArithmetic(ArithmeticOperation operation, const ObjectHolder& lhs,
+                                             const ObjectHolder& rhs);
+
+/*
+ * Performs the operation on two numbers, at least one of which is Float.
+ * The integer argument is converted to double.
+ * Returns None if any of the arguments is not a number or both are integers.
+ * Division by zero throws a runtime_error exception
+ */
+[[nodiscard]] ObjectHolder FloatArithmetic(ArithmeticOperation operation, const ObjectHolder& lhs,
+                                           const ObjectHolder& rhs);
+
+// Checked arithmetic of the 64-bit integers: returns false if the result overflows
+inline bool CheckedAdd(int64_t lhs, int64_t rhs, int64_t& result) {
+    return !__builtin_add_overflow(lhs, rhs, &result);
+}
+
+inline bool CheckedSub(int64_t lhs, int64_t rhs, int64_t& result) {
+    return !__builtin_sub_overflow(lhs, rhs, &result);
+}
+
+inline bool CheckedMult(int64_t lhs, int64_t rhs, int64_t& result) {
+    return !__builtin_mul_overflow(lhs, rhs, &result);
+}
+
+// rhs must not be zero
+inline bool CheckedDiv(int64_t lhs, int64_t rhs, int64_t& result) {
+    if (lhs == INT64_MIN && rhs == -1) {
+        return false;
+    }
+    result = lhs / rhs;
+    return true;
+}
+
+// Performs the operation on two 64-bit integers.
+// Returns false if the result overflows or the divisor is zero
+inline bool CheckedArithmetic(ArithmeticOperation operation, int64_t lhs, int64_t rhs,
+                              int64_t& result) {
+    switch (operation) {
+        case ArithmeticOperation::ADD:
+            return CheckedAdd(lhs, rhs, result);
+        case ArithmeticOperation::SUB:
+            return CheckedSub(lhs, rhs, result);
+        case ArithmeticOperation::MULT:
+            return CheckedMult(lhs, rhs, result);
+        case ArithmeticOperation::DIV:
+            return rhs != 0 && CheckedDiv(lhs, rhs, result);
+    }
+    return false;
+}
+
+/*
+ * Returns the marker held by the variables of a reused call frame
+ * that have not been assigned yet in the current call.
+ * Such variables are treated as missing
+ */
+[[nodiscard]] const ObjectHolder& Unbound();
+
+// Call frame of a method: the closure of the call and the cached slots
+// of self and of the parameters in it
+struct Frame {
+    Closure closure;
+    ObjectHolder* self = nullptr;
+    std::vector<ObjectHolder*> params;
+};
+
+/*
+ * Memoization of the pure methods, enabled by mython --memoize. A method is pure on a class
+ * if its body, executed on an instance of the class, neither prints nor assigns or reads fields
+ * and calls only the pure methods of the same instance (see Executable::IsPure).
+ * When the arguments of such a call are numbers, strings, bools or None, the result depends
+ * only on them, so a result of the same kind is cached and returned by the next calls with
+ * equal arguments without executing the body. A method keeps at most capacity results
+ * per class, the least recently used one is evicted first
+ */
+struct Memoization {
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    bool enabled = false;
+    size_t capacity = DEFAULT_CAPACITY;
+    // Counters printed by mython --stats
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+inline Memoization memoization;
+
+// The results of the calls of a method on instances of a class, see Memoization
+class MethodResults {
+public:
+    MethodResults(const Class& cls, bool pure)
+        : cls_{&cls}, pure_{pure} {
+    }
+    // The index refers to the keys in the list
+    MethodResults(const MethodResults&) = delete;
+    MethodResults& operator=(const MethodResults&) = delete;
+
+    [[nodiscard]] const Class* GetClass() const {
+        return cls_;
+    }
+
+    [[nodiscard]] bool IsPure() const {
+        return pure_;
+    }
+
+    // Returns the result cached for the arguments, nullptr if there is none
+    [[nodiscard]] const ObjectHolder* Find(std::string_view key);
+    // Caches the result of a call with the arguments, evicting the least recently used one
+    // if the capacity has been reached
+    void Insert(std::string key, ObjectHolder result);
+
+private:
+    const Class* cls_;
+    bool pure_;
+    // The results from the most to the least recently used, with the keys made of the arguments
+    std::list<std::pair<std::string, ObjectHolder>> results_;
+    std::unordered_map<std::string_view, decltype(results_)::iterator> index_;
+};
+
 // Class method
 struct Method {
     // Method name
@@ -126,8 +556,165 @@ struct Method {
     std::vector<std::string> formal_params;
     // The body of the method
     std::unique_ptr<Executable> body;
+    // Frames of the finished calls, reused by the next ones
+    mutable std::vector<std::unique_ptr<Frame>> free_frames = {};
+    // The cached results per class of the instance, used only if memoization is enabled
+    mutable std::list<MethodResults> results = {};
+
+    // Returns a free frame, creating one only if all of them are in use
+    [[nodiscard]] std::unique_ptr<Frame> AcquireFrame() const;
+    // Unbinds all variables of the frame and returns it to the free ones
+    void ReleaseFrame(std::unique_ptr<Frame> frame) const;
+    // Returns the results of the calls on instances of the class, checking on the first call
+    // whether the method is pure on it
+    [[nodiscard]] MethodResults& ResultsFor(const Class& cls) const;
+};
+
+/*
+ * Stack of the arguments of the calls being made.
+ * The caller pushes the arguments, the callee copies them into its frame,
+ * then the caller truncates the stack back. The storage is never shrunk,
+ * so the calls do not allocate once it has grown to the deepest call
+ */
+class ValueStack {
+public:
+    [[nodiscard]] size_t Size() const {
+        return values_.size();
+    }
+
+    void Push(ObjectHolder value) {
+        values_.push_back(std::move(value));
+    }
+
+    // Returns a pointer to the value at the index. It is invalidated by the next Push
+    [[nodiscard]] const ObjectHolder* At(size_t index) const {
+        return values_.data() + index;
+    }
+
+    // Pops the values above the size
+    void Truncate(size_t size) {
+        values_.resize(size);
+    }
+
+private:
+    std::vector<ObjectHolder> values_;
 };
 
+inline ValueStack value_stack;
+
+/*
+ * Depth of the method calls being made and the native stack they run on. When the stack
+ * is about to run out, the body of the call runs on a segment allocated from the heap, so the
+ * stack grows with the calls, and the segments are kept for the next time the calls get as deep.
+ * A call deeper than the maximum depth throws runtime_error, and so does one which finds
+ * no memory for a segment (or no segments on the platform) instead of overflowing the stack.
+ * The native stack used by a call is measured whenever the calls get deeper than ever
+ * before, it is the stack used by all the calls divided by the depth
+ */
+class CallStack {
+public:
+    static constexpr size_t DEFAULT_MAX_DEPTH = 100000;
+    // The size of a segment. A call takes 1-2 KiB, deeply nested expressions more
+    static constexpr size_t SEGMENT_SIZE = 8 * 1024 * 1024;
+    // The stack left free below a call which stays on the current segment: the deepest
+    // expressions and the unwinding of an exception must fit in it
+    static constexpr size_t RED_ZONE = 256 * 1024;
+
+    CallStack();
+    ~CallStack();
+
+    CallStack(const CallStack&) = delete;
+    CallStack& operator=(const CallStack&) = delete;
+
+    void SetMaxDepth(size_t max_depth) {
+        max_depth_ = max_depth;
+    }
+
+    [[nodiscard]] size_t GetMaxDepth() const {
+        return max_depth_;
+    }
+
+    // Enters a call. If the maximum depth has been reached, runtime_error is thrown
+    void Enter() {
+        if (depth_ == max_depth_) {
+            ThrowTooDeep();
+        }
+        ++depth_;
+        if (depth_ == 1 || depth_ > deepest_) {
+            Measure();
+        }
+    }
+
+    void Leave() {
+        --depth_;
+    }
+
+    // Runs the body of the call entered, on a new segment if the stack is about to run out
+    template <typename Body>
+    ObjectHolder Run(Body&& body) {
+        char marker = 0;
+        if (reinterpret_cast<uintptr_t>(&marker) >= limit_) {
+            return body();
+        }
+        return RunOnSegment(std::function<ObjectHolder()>(std::forward<Body>(body)));
+    }
+
+    [[nodiscard]] size_t GetDepth() const {
+        return depth_;
+    }
+
+    // Returns the depth of the deepest call so far
+    [[nodiscard]] size_t GetDeepest() const {
+        return deepest_;
+    }
+
+    // Returns the native stack bytes used per call at the deepest call,
+    // 0 if there have not been nested calls
+    [[nodiscard]] size_t GetBytesPerCall() const {
+        return bytes_per_call_;
+    }
+
+    // Returns the number of the segments allocated
+    [[nodiscard]] size_t GetSegmentCount() const {
+        return segments_.size();
+    }
+
+private:
+    struct Segment;
+
+    [[noreturn]] void ThrowTooDeep() const;
+    [[noreturn]] void ThrowOutOfStack() const;
+    void Measure();
+    // Finds the bounds of the stack of the current thread
+    void FindStack(uintptr_t address);
+    ObjectHolder RunOnSegment(const std::function<ObjectHolder()>& body);
+
+    size_t depth_ = 0;
+    size_t max_depth_ = DEFAULT_MAX_DEPTH;
+    size_t deepest_ = 0;
+    // The bounds of the stack of the thread making the outermost call
+    uintptr_t stack_low_ = 0;
+    uintptr_t stack_high_ = 0;
+    // Below the address the call switches to a new segment, 0 before the outermost call
+    uintptr_t limit_ = 0;
+    // The native stack address of the outermost call or the top of the current segment,
+    // and the stack used by the calls on the segments below it
+    uintptr_t top_ = 0;
+    size_t used_below_ = 0;
+    size_t bytes_per_call_ = 0;
+    std::vector<std::unique_ptr<Segment>> segments_;
+    // The number of segments the calls are running on
+    size_t active_segments_ = 0;
+};
+
+inline CallStack call_stack;
+
+// Methods called by the interpreter itself: constructor, printing, operators and iteration
+enum class SpecialMethod { INIT, STR, EQ, LT, GT, LE, GE, HASH, ADD, SUB, MULT, ITER, NEXT, COUNT };
+
+// Returns the name of the special method, for example "__init__"
+[[nodiscard]] const std::string& GetSpecialMethodName(SpecialMethod method);
+
 // Class
 class Class : public Object {
 public:
@@ -135,9 +722,29 @@ public:
     // If parent is nullptr, a base class is created
     explicit Class(std::string name, std::vector<Method> methods, const Class* parent);
 
+    // The special method slots point into methods_, which a copy would not share
+    Class(const Class&) = delete;
+    Class(Class&&) = default;
+
     // Returns a pointer to the method name or nullptr if there is no method with that name
     [[nodiscard]] const Method* GetMethod(const std::string& name) const;
 
+    // Returns the special method, looked up with the parent classes once at construction,
+    // or nullptr if there is no such method
+    [[nodiscard]] const Method* GetMethod(SpecialMethod method) const {
+        return special_methods_[static_cast<size_t>(method)];
+    }
+
+    // Returns the methods defined in the class itself, without the inherited ones
+    [[nodiscard]] const std::vector<Method>& GetMethods() const {
+        return methods_;
+    }
+
+    // Returns the parent class or nullptr for a base class
+    [[nodiscard]] const Class* GetParent() const {
+        return parent_;
+    }
+
     // Returns the class name
     [[nodiscard]] const std::string& GetName() const;
 
@@ -147,13 +754,17 @@ private:
     std::string name_;
     std::vector<Method> methods_;
     const Class* parent_;
+    std::array<const Method*, static_cast<size_t>(SpecialMethod::COUNT)> special_methods_{};
 };
 
 // A class instance
-class ClassInstance : public Object {
+class ClassInstance : public Container {
 public:
     explicit ClassInstance(const Class& cls);
 
+    void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) const override;
+    void ClearReferences() override;
+
     /*
      * If the object has a __str__ method, outputs the result returned by this method to os.
      * Otherwise it outputs the address of the object to os.
@@ -168,9 +779,21 @@ public:
      */
     ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
                       Context& context);
+    // The same, but takes the count arguments starting from actual_args
+    ObjectHolder Call(const std::string& method, const ObjectHolder* actual_args, size_t count,
+                      Context& context);
+    // The same for a special method, which is not looked up by name
+    ObjectHolder Call(SpecialMethod method, const ObjectHolder* actual_args, size_t count,
+                      Context& context);
 
     // Returns true if the object has a method that accepts argument_count parameters
     [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+    [[nodiscard]] bool HasMethod(SpecialMethod method, size_t argument_count) const;
+
+    // Returns the class of the object
+    [[nodiscard]] const Class& GetClass() const {
+        return cls_;
+    }
 
     // Returns a reference to the Closure containing the object fields
     [[nodiscard]] Closure& Fields();
@@ -182,10 +805,168 @@ public:
     }
 
 private:
+    // Calls the method found by the class. If it is nullptr or takes another number of
+    // parameters, throws runtime_error naming the method name
+    ObjectHolder CallMethod(const Method* mtd, const std::string& name,
+                            const ObjectHolder* actual_args, size_t count, Context& context);
+
     const Class &cls_;
     Closure closure_;
 };
 
+/*
+ * Returns the hash of an object used as a Dict key.
+ * Numbers, strings and Bool values are hashed natively, a class instance must have
+ * a __hash__ method without parameters returning a number.
+ * Otherwise the function throws a runtime_error exception
+ */
+size_t Hash(const ObjectHolder& object, Context& context);
+
+/*
+ * Dictionary of key-value pairs.
+ * Open addressing table in the style of Swiss tables: every slot has a control byte
+ * holding either the Empty/Deleted marker or the low 7 bits of the key hash, so that
+ * the probe sequence scans a group of control bytes before touching any entry.
+ * Entries store the full hash next to the key, so the keys are never rehashed on growth.
+ * Keys are compared with Equal, which calls __eq__ for class instances
+ */
+class Dict : public Container {
+public:
+    Dict();
+
+    void ForEachReference(const std::function<void(const ObjectHolder&)>& visit) const override;
+    void ClearReferences() override;
+
+    // Outputs the pairs in the form {key: value, ...} in table order.
+    // A dictionary reached again while it is being printed is output as {...}
+    void Print(std::ostream& os, Context& context) override;
+
+    // Returns the value stored by the key or None if there is no such key
+    [[nodiscard]] ObjectHolder Get(const ObjectHolder& key, Context& context) const;
+    // Returns true if the dictionary contains the key
+    [[nodiscard]] bool Contains(const ObjectHolder& key, Context& context) const;
+    // Stores the value by the key, replacing the previous one
+    void Set(const ObjectHolder& key, ObjectHolder value, Context& context);
+    // Removes the key. Returns false if there was no such key
+    bool Erase(const ObjectHolder& key, Context& context);
+    // Returns the number of stored pairs
+    [[nodiscard]] size_t Size() const;
+
+    /*
+     * Calls the builtin method of the dictionary:
+     * get(key), set(key, value), contains(key), remove(key), len().
+     * For an unknown method or a wrong number of arguments throws runtime_error
+     */
+    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+                      Context& context);
+    // The same, but takes the count arguments starting from actual_args
+    ObjectHolder Call(const std::string& method, const ObjectHolder* actual_args, size_t count,
+                      Context& context);
+
+    // Calls fn(key, value) for every pair in table order
+    template <typename Fn>
+    void ForEach(Fn fn) const {
+        for (size_t i = 0; i < ctrl_.size(); ++i) {
+            if (IsFull(ctrl_[i])) {
+                fn(slots_[i].key, slots_[i].value);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        size_t hash = 0;
+        ObjectHolder key;
+        ObjectHolder value;
+    };
+
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+
+    static bool IsFull(int8_t ctrl) {
+        return ctrl >= 0;
+    }
+
+    // Returns the slot index of the key or npos
+    size_t Find(const ObjectHolder& key, size_t hash, Context& context) const;
+    // Returns the first empty or deleted slot in the probe sequence of the hash
+    size_t FindFreeSlot(size_t hash) const;
+    void Rehash(size_t group_count);
+
+    std::vector<int8_t> ctrl_;
+    std::vector<Entry> slots_;
+    size_t size_ = 0;
+    size_t deleted_ = 0;
+    // Set while Print outputs the pairs, so that a dictionary containing itself ends
+    bool printing_ = false;
+};
+
+// Lazy sequence of numbers from start (inclusive) to stop (exclusive), created by range(a, b)
+class Range : public Object {
+public:
+    Range(int64_t start, int64_t stop);
+
+    // Outputs the string "range(<start>, <stop>)"
+    void Print(std::ostream& os, Context& context) override;
+
+    [[nodiscard]] int64_t GetStart() const;
+    [[nodiscard]] int64_t GetStop() const;
+
+private:
+    int64_t start_;
+    int64_t stop_;
+};
+
+/*
+ * Calls fn(value) for every element of the iterable object, until fn returns false:
+ * - the numbers of a Range, counted without creating any sequence;
+ * - the keys of a Dict, which are copied before the first call, so the body may modify the dict;
+ * - the values of a class instance with the __iter__ method, which returns an iterator object,
+ *   whose __next__ method returns the next value or None when the sequence is over.
+ * For other objects throws a runtime_error exception
+ */
+template <typename Fn>
+void Iterate(const ObjectHolder& iterable, Context& context, Fn fn) {
+    using namespace std::literals;
+
+    if (auto range = iterable.TryAs<Range>()) {
+        for (int64_t i = range->GetStart(), stop = range->GetStop(); i < stop; ++i) {
+            if (!fn(MakeNumber(i))) {
+                return;
+            }
+        }
+        return;
+    }
+    if (auto dict = iterable.TryAs<Dict>()) {
+        std::vector<ObjectHolder> keys;
+        keys.reserve(dict->Size());
+        dict->ForEach([&keys](const ObjectHolder& key, const ObjectHolder& /*value*/) {
+            keys.push_back(key);
+        });
+        for (auto& key : keys) {
+            if (!fn(std::move(key))) {
+                return;
+            }
+        }
+        return;
+    }
+    if (auto instance = iterable.TryAs<ClassInstance>(); instance && instance->HasMethod(SpecialMethod::ITER, 0U)) {
+        auto iterator = instance->Call(SpecialMethod::ITER, nullptr, 0, context);
+        auto iterator_instance = iterator.TryAs<ClassInstance>();
+        if (!iterator_instance) {
+            throw std::runtime_error("__iter__ must return a class instance"s);
+        }
+        while (auto value = iterator_instance->Call(SpecialMethod::NEXT, nullptr, 0, context)) {
+            if (!fn(std::move(value))) {
+                return;
+            }
+        }
+        return;
+    }
+    throw std::runtime_error("Object is not iterable"s);
+}
+
 /*
  * Returns true if lhs and rhs contain the same numbers, strings or values of type Bool.
  * If lhs is an object with __eq__ method, the function returns the result of calling lhs.__eq__(rhs),
@@ -207,13 +988,25 @@ bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 bool Less(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 // Returns the value opposite Equal(lhs, rhs, context)
 bool NotEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
-// Returns lhs>rhs using the Equal and Less functions
+// Returns lhs>rhs: lhs.__gt__(rhs) if there is such a method, otherwise using the Equal and Less functions
 bool Greater(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
-// Returns lhs<=rhs using the Equal and Less functions
+// Returns lhs<=rhs: lhs.__le__(rhs) if there is such a method, otherwise using the Equal and Less functions
 bool LessOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
-// Returns the value opposite Less(lhs, rhs, context)
+// Returns lhs>=rhs: lhs.__ge__(rhs) if there is such a method, otherwise the value opposite Less
 bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+// Comparison operators
+enum class CompareOperation { EQUAL, NOT_EQUAL, LESS, GREATER, LESS_OR_EQUAL, GREATER_OR_EQUAL };
+
+/*
+ * Applies the comparison operator to lhs and rhs like the functions above.
+ * Numbers, strings and bool values are compared once, in three ways at a time,
+ * and a user object costs one special method call when it has the method
+ * for the operator itself
+ */
+bool Compare(CompareOperation operation, const ObjectHolder& lhs, const ObjectHolder& rhs,
+             Context& context);
+
 // A stub context, used in tests.
 // In this context all output is redirected to the output string
 struct DummyContext : Context {
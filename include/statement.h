@@ -2,16 +2,30 @@
 
 #include "runtime.h"
 
-#include <functional>
+#include <optional>
+
 
 namespace ast {
 
 using Statement = runtime::Executable;
 
+// Writes the statements as C++ code, see cpp_emitter.h
+class CppEmitter;
+class TypeInference;
+// Builds the IR of the statements and lowers it back, see ir.h
+class IrTranslator;
+// Compiles the method bodies into machine code, see jit.h
+class NativeCompiler;
+
 // An expression that returns a value of type T,
 // is used as the basis for creating constants
 template <typename T>
 class ValueStatement : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     explicit ValueStatement(T v)
         : value_(std::move(v)) {
@@ -22,11 +36,27 @@ public:
         return runtime::ObjectHolder::Share(value_);
     }
 
+    runtime::Compiled Compile() override {
+        return [this](runtime::Closure& closure, runtime::Context& context) {
+            return ValueStatement::Execute(closure, context);
+        };
+    }
+
+    [[nodiscard]] bool IsPure([[maybe_unused]] const runtime::Class& cls) const override {
+        return true;
+    }
+
+    [[nodiscard]] size_t ExpressionSize() const override {
+        return 1;
+    }
+
 private:
     T value_;
 };
 
 using NumericConst = ValueStatement<runtime::Number>;
+using FloatConst = ValueStatement<runtime::Float>;
+using BigIntConst = ValueStatement<runtime::BigInt>;
 using StringConst = ValueStatement<runtime::String>;
 using BoolConst = ValueStatement<runtime::Bool>;
 
@@ -34,24 +64,48 @@ using BoolConst = ValueStatement<runtime::Bool>;
 Calculates the value of a variable or a chain of calls of object fields id1.id2.id3.
 For example, the expression circle.center.x is a chain of calls of object fields in the instruction:
 x = circle.center.x
+The chain is split once at construction: each evaluation looks the variable up
+in the closure and then walks the field names, one lookup per hop
 */
 class VariableValue : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     explicit VariableValue(const std::string& var_name);
     explicit VariableValue(std::vector<std::string> dotted_ids);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    // A variable is pure unless it is self: reading the fields or passing self on is not
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+    [[nodiscard]] size_t ExpressionSize() const override;
+
+    // Returns true if the statement is the variable of the name without fields
+    [[nodiscard]] bool IsVariable(const std::string& name) const {
+        return fields_.empty() && var_name_ == name;
+    }
 private:
     std::string var_name_;
-    std::vector<std::string> tail_;
+    // names of the fields following the variable name
+    std::vector<std::string> fields_;
 };
 
 // Assigns the value of the expression rv to the variable whose name is given in the var parameter
 class Assignment : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     Assignment(std::string var, std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
 private:
     std::string var_;
     std::unique_ptr<Statement> rv_;
@@ -59,10 +113,16 @@ private:
 
 // Assigns the value of the expression rv to the object.field_name field
 class FieldAssignment : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 private:
     VariableValue object_;
     std::string field_name_;
@@ -76,10 +136,23 @@ public:
                                   [[maybe_unused]] runtime::Context& context) override {
         return {};
     }
+
+    [[nodiscard]] bool IsPure([[maybe_unused]] const runtime::Class& cls) const override {
+        return true;
+    }
+
+    [[nodiscard]] size_t ExpressionSize() const override {
+        return 1;
+    }
 };
 
 // Print command
 class Print : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     // Initializes the print command to print the value of the argument expression
     explicit Print(std::unique_ptr<Statement> argument);
@@ -92,17 +165,34 @@ public:
     // During the execution of the print command, the output must be in the stream returned from
     // context.GetOutputStream()
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 private:
     std::vector<std::unique_ptr<Statement>> args_;
 };
 
-// Calls method object.method with parameter list args
+// Calls method object.method with parameter list args.
+// The object is either a class instance or a dictionary with its builtin methods
 class MethodCall : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     MethodCall(std::unique_ptr<Statement> object, std::string method,
                std::vector<std::unique_ptr<Statement>> args);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+
+    // Executes the call in the tail position of a method body (return object.method(args)).
+    // A recursive call of that method is not made here: the enclosing MethodBody makes it
+    // after the current call has returned, in the same frame, and None is returned
+    runtime::ObjectHolder ExecuteTail(runtime::Closure& closure, runtime::Context& context);
+    runtime::Compiled CompileTail();
+
+    // Only a call of a method of self which is pure itself is pure
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
 private:
     std::unique_ptr<Statement> object_;
     std::string method_;
@@ -123,24 +213,113 @@ p = Person()
 p.set_name("Ivan")
 */
 class NewInstance : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     explicit NewInstance(const runtime::Class& class_);
     NewInstance(const runtime::Class& class_, std::vector<std::unique_ptr<Statement>> args);
     // Returns an object containing a value of type ClassInstance
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 private:
-    runtime::ClassInstance class_instance_;
+    const runtime::Class& class_;
     std::vector<std::unique_ptr<Statement>> args_;
 };
 
+// Creates a new empty dictionary: d = dict()
+class NewDict : public Statement {
+public:
+    // Returns an object containing a value of type Dict
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+};
+
+// Creates a lazy range of numbers: range(stop) or range(start, stop)
+class NewRange : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
+public:
+    NewRange(std::unique_ptr<Statement> start, std::unique_ptr<Statement> stop);
+
+    // Returns an object containing a value of type Range.
+    // If the bounds are not numbers, a runtime_error exception is thrown
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+private:
+    std::unique_ptr<Statement> start_, stop_;
+};
+
+// The value of an operator which does not escape the enclosing expression, see Operator.
+// A number or a string is kept by value, anything else is an object
+class Temporary {
+public:
+    explicit Temporary(runtime::ObjectHolder object)
+        : object_{std::move(object)} {
+    }
+    explicit Temporary(int64_t number)
+        : number_{number}, unboxed_number_{true} {
+    }
+    explicit Temporary(runtime::String string)
+        : string_{std::move(string)} {
+    }
+
+    // Returns the value if it is a Number, boxed or not
+    [[nodiscard]] std::optional<int64_t> AsNumber() const;
+    // Returns the value if it is a String, boxed or not, otherwise nullptr
+    [[nodiscard]] const runtime::String* AsString() const;
+
+    // Returns the value as an object, placing it in the heap if it is not there yet
+    [[nodiscard]] runtime::ObjectHolder Box() const;
+
+private:
+    runtime::ObjectHolder object_;
+    int64_t number_ = 0;
+    bool unboxed_number_ = false;
+    std::optional<runtime::String> string_;
+};
+
+using CompiledTemporary = std::function<Temporary(runtime::Closure&, runtime::Context&)>;
+
+/*
+ * Base class of the operators, with escape analysis of their values. The value of an
+ * arithmetic operator or of str is used only by the enclosing operator when it is an operand
+ * of another arithmetic operator, of str or of a comparison. Such an operand is calculated
+ * as a Temporary, so the intermediate numbers and strings are not placed in the heap and only
+ * the value of the whole expression is. The operands which are operators are found once,
+ * when the operator is constructed
+ */
+class Operator : public Statement {
+public:
+    // Calculates the value as a Temporary. By default it is the value of Execute
+    virtual Temporary Calculate(runtime::Closure& closure, runtime::Context& context);
+    // Lowers Calculate, see Executable::Compile
+    virtual CompiledTemporary CompileCalculate();
+};
+
 // Base class for unary operations
-class UnaryOperation : public Statement {
+class UnaryOperation : public Operator {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     explicit UnaryOperation(std::unique_ptr<Statement> argument)
-        : argument_{std::move(argument)} {
+        : argument_{std::move(argument)}
+        , argument_operator_{dynamic_cast<Operator*>(argument_.get())} {
     }
+
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+    [[nodiscard]] size_t ExpressionSize() const override;
 protected:
     std::unique_ptr<Statement> argument_;
+    Operator* argument_operator_;
 };
 
 // The str operation, which returns the string value of its argument
@@ -148,16 +327,120 @@ class Stringify : public UnaryOperation {
 public:
     using UnaryOperation::UnaryOperation;
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    Temporary Calculate(runtime::Closure& closure, runtime::Context& context) override;
+    CompiledTemporary CompileCalculate() override;
+};
+
+// The join(separator, iterable) operation, which returns the string values of the iterable
+// elements (see runtime::Iterate) separated by the separator string
+class Join : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
+public:
+    Join(std::unique_ptr<Statement> separator, std::unique_ptr<Statement> iterable);
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+private:
+    std::unique_ptr<Statement> separator_, iterable_;
+};
+
+// Counters of the quickened nodes, printed by mython --stats
+struct QuickeningStats {
+    // Nodes which have specialized themselves for two numbers
+    uint64_t specialized_numbers = 0;
+    // Nodes which have specialized themselves for two strings
+    uint64_t specialized_strings = 0;
+    // Specialized nodes which have met other operands and returned to the generic path
+    uint64_t deoptimized = 0;
+    // Nodes whose operand types have been proven ahead of time (see type_inference.h)
+    uint64_t proven = 0;
+};
+
+inline QuickeningStats quickening_stats;
+
+/*
+ * Specialization state of an arithmetic or comparison node.
+ * The node executes generically for the first THRESHOLD times and records the operand types.
+ * If they were two numbers or two strings every time, the node switches to the fast path
+ * for them, guarded by a type check. When the guard fails, the node returns to the generic
+ * path for good, so that a polymorphic node does not flip back and forth.
+ * A node whose operand types have been proven before the execution starts specialized
+ * and takes the fast path without the guard
+ */
+class Quickening {
+public:
+    enum class Operands : uint8_t { NUMBERS, STRINGS, OTHER };
+
+    static constexpr uint32_t THRESHOLD = 8;
+
+    [[nodiscard]] static Operands Classify(const runtime::ObjectHolder& lhs,
+                                           const runtime::ObjectHolder& rhs);
+
+    // Returns the operands the node is specialized for, OTHER if it executes generically
+    [[nodiscard]] Operands GetSpecialization() const {
+        return state_ == State::SPECIALIZED || state_ == State::PROVEN ? operands_
+                                                                        : Operands::OTHER;
+    }
+
+    // Returns true if the operands are proven to be GetSpecialization() and need no guard
+    [[nodiscard]] bool IsProven() const {
+        return state_ == State::PROVEN;
+    }
+
+    // Specializes the node for the operands, which are proven to be NUMBERS or STRINGS
+    void Prove(Operands operands);
+
+    // Records the operands of a generic execution while the node is warming up
+    void Observe(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs) {
+        if (state_ == State::WARMING) {
+            Record(Classify(lhs, rhs));
+        }
+    }
+
+    // Returns the specialized node to the generic path
+    void Deoptimize();
+
+private:
+    enum class State : uint8_t { WARMING, SPECIALIZED, GENERIC, PROVEN };
+
+    void Record(Operands operands);
+
+    State state_ = State::WARMING;
+    Operands operands_ = Operands::OTHER;
+    uint32_t executions_ = 0;
 };
 
 // Parent class Binary operation with lhs and rhs arguments
-class BinaryOperation : public Statement {
+class BinaryOperation : public Operator {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
-        : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {
+        : lhs_{std::move(lhs)}, rhs_{std::move(rhs)}
+        , lhs_operator_{dynamic_cast<Operator*>(lhs_.get())}
+        , rhs_operator_{dynamic_cast<Operator*>(rhs_.get())} {
     }
+
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+    [[nodiscard]] size_t ExpressionSize() const override;
 protected:
+    // Returns true if an operand is an operator, whose value is then calculated as a Temporary
+    [[nodiscard]] bool HasOperatorOperand() const {
+        return lhs_operator_ != nullptr || rhs_operator_ != nullptr;
+    }
+
     std::unique_ptr<Statement> lhs_, rhs_;
+    Operator* lhs_operator_;
+    Operator* rhs_operator_;
+    Quickening quickening_;
 };
 
 // Returns the result of the + operation on the lhs and rhs arguments
@@ -171,6 +454,9 @@ public:
     // object1 + object2, if object1 has custom class with _add__(rhs) method
     // otherwise, runtime_error is thrown during calculation
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    Temporary Calculate(runtime::Closure& closure, runtime::Context& context) override;
+    CompiledTemporary CompileCalculate() override;
 };
 
 // Returns the result of subtracting the lhs and rhs arguments
@@ -180,8 +466,12 @@ public:
 
     // Subtraction is supported:
     // number - number
-    // If lhs and rhs are not numbers, a runtime_error exception is thrown
+    // object1 - object2, if object1 has custom class with __sub__(rhs) method
+    // otherwise, runtime_error is thrown during calculation
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    Temporary Calculate(runtime::Closure& closure, runtime::Context& context) override;
+    CompiledTemporary CompileCalculate() override;
 };
 
 // Returns the result of multiplying the lhs and rhs arguments
@@ -191,8 +481,12 @@ public:
 
     // Multiplication is supported:
     // number * number
-    // If lhs and rhs are not numbers, a runtime_error exception is thrown
+    // object1 * object2, if object1 has custom class with __mul__(rhs) method
+    // otherwise, runtime_error is thrown during calculation
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    Temporary Calculate(runtime::Closure& closure, runtime::Context& context) override;
+    CompiledTemporary CompileCalculate() override;
 };
 
 // Returns the result of division of lhs and rhs
@@ -205,6 +499,9 @@ public:
     // If lhs and rhs are not numbers, a runtime_error exception is thrown
     // If rhs is 0, a runtime_error exception is thrown
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    Temporary Calculate(runtime::Closure& closure, runtime::Context& context) override;
+    CompiledTemporary CompileCalculate() override;
 };
 
 // Returns the result of calculating the logical operation or over lhs and rhs
@@ -214,6 +511,7 @@ public:
     // The value of the argument rhs is calculated only if the value of lhs
     // after being cast to Bool is False
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 };
 
 // Returns the result of calculating the logical operation and over lhs and rhs
@@ -223,6 +521,7 @@ public:
     // The value of the argument rhs is calculated only if the value of lhs
     // after converting to Bool is True
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 };
 
 // Returns the result of calculating the logical operation not over the single argument of the operation
@@ -230,10 +529,17 @@ class Not : public UnaryOperation {
 public:
     using UnaryOperation::UnaryOperation;
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 };
 
 // Component instruction (for example: method body, contents of if branch, or else)
 class Compound : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+    friend class MethodBody;
+
 public:
     // Constructs Compound from several instructions of type unique_ptr<Statement>
     template <typename... Args>
@@ -247,6 +553,8 @@ public:
 
     // Executes the added instructions sequentially. Returns None
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
 private:
     std::vector<std::unique_ptr<Statement>> args_;
 
@@ -259,35 +567,109 @@ private:
     }
 };
 
+/*
+ * Tiering of the method bodies. A body is executed by walking the tree until the method
+ * has been called threshold times, then it is compiled into machine code if the JIT is
+ * enabled (see jit.h) or otherwise lowered into closures (see Executable::Compile), and
+ * the following calls execute the compiled body
+ */
+struct Tiering {
+    static constexpr uint32_t DEFAULT_THRESHOLD = 1000;
+
+    // The number of calls after which a method body is compiled, 0 disables the tiering
+    uint32_t threshold = DEFAULT_THRESHOLD;
+    // The number of the method bodies compiled so far either way, printed by mython --stats
+    uint64_t compiled_methods = 0;
+};
+
+inline Tiering tiering;
+
+/*
+ * Inlining of the small methods into the compiled code. A compiled call remembers the class
+ * of its receiver, and if the method called is a single return of an expression of at most
+ * max_size values, variables and operators, the expression is evaluated in place of the call
+ */
+struct Inlining {
+    static constexpr size_t DEFAULT_MAX_SIZE = 8;
+
+    // The largest expression inlined, 0 disables the inlining
+    size_t max_size = DEFAULT_MAX_SIZE;
+    // The number of the calls made in place so far, printed by mython --stats
+    uint64_t inlined_calls = 0;
+};
+
+inline Inlining inlining;
+
 // The body of the method. As a rule, it contains a compound instruction
 class MethodBody : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
-    explicit MethodBody(std::unique_ptr<Statement>&& body);
+    // The name, Class.method, labels the machine code of the body for the profilers
+    explicit MethodBody(std::unique_ptr<Statement>&& body, std::string name = {});
 
-    // Calculates the instruction passed as body.
+    // Calculates the instruction passed as body, compiling it first if the method has become hot:
+    // into machine code if the JIT is enabled and can (see jit.h), otherwise into closures.
     // If the return instruction has been executed inside the body, it returns result return
-    // otherwise, it returns None
+    // otherwise, it returns None.
+    // A recursive call returned by the body (see MethodCall::ExecuteTail) is made in a loop,
+    // rebinding the variables of the frame, so the recursion does not grow the stack
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    // Lowers the body. From then on the method calls execute the lowered body instead of the tree
+    runtime::Compiled Compile() override;
+    // A method calling itself is pure if the rest of the body is
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+
+    // Returns the expression if the body is a single return of an expression of at most
+    // max_size nodes (see Executable::ExpressionSize), otherwise nullptr
+    [[nodiscard]] Statement* InlineExpression(size_t max_size) const;
+
+    [[nodiscard]] const std::string& GetName() const {
+        return name_;
+    }
 private:
     std::unique_ptr<Statement> body_;
+    std::string name_;
+    runtime::Compiled compiled_body_;
+    runtime::Compiled native_body_;
+    uint32_t calls_ = 0;
 };
 
 // Executes the return instruction with a statement
 class Return : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+    friend class MethodBody;
+
 public:
     explicit Return(std::unique_ptr<Statement> statement)
-        : statement_{std::move(statement)} {
+        : statement_{std::move(statement)}
+        , tail_call_{dynamic_cast<MethodCall*>(statement_.get())} {
     }
 
     // Stops execution of the current method. After the return instruction has been executed, the method,
     // within which it was executed, must return the result of calculating the statement expression.
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
 private:
     std::unique_ptr<Statement> statement_;
+    // The statement if it is a method call, which is then in the tail position
+    MethodCall* tail_call_;
 };
 
 // Declares class
 class ClassDefinition : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     // It is guaranteed that ObjectHolder contains an object of type runtime::Class
     explicit ClassDefinition(runtime::ObjectHolder cls);
@@ -295,36 +677,115 @@ public:
     // Creates a new object inside the class that matches the name of the class and the value passed in the
     // constructor
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 private:
     runtime::ObjectHolder cls_;
 };
 
 // Instruction if <condition> <if_body> else <else_body>
 class IfElse : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
 public:
     // The else_body parameter can be nullptr
     IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
            std::unique_ptr<Statement> else_body);
 
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
 private:
     std::unique_ptr<Statement> condition_, if_body_, else_body_;
+    // The condition is proven to be a Bool, so it is not converted by runtime::IsTrue
+    bool bool_condition_ = false;
+};
+
+// Instruction for <var> in <iterable>: <body>
+class ForIn : public Statement {
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
+
+public:
+    ForIn(std::string var, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body);
+
+    // Assigns every value of the iterable (see runtime::Iterate) to the variable var
+    // and executes the body. Returns None
+    runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
+    [[nodiscard]] bool IsPure(const runtime::Class& cls) const override;
+private:
+    std::string var_;
+    std::unique_ptr<Statement> iterable_, body_;
 };
 
 // Comparison operation
 class Comparison : public BinaryOperation {
-public:
-    // Comparator defines a function that compares the values of the arguments
-    using Comparator = std::function<bool(const runtime::ObjectHolder&,
-                                          const runtime::ObjectHolder&, runtime::Context&)>;
+    friend class CppEmitter;
+    friend class NativeCompiler;
+    friend class TypeInference;
+    friend class IrTranslator;
 
-    Comparison(Comparator cmp, std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
+public:
+    Comparison(runtime::CompareOperation operation, std::unique_ptr<Statement> lhs,
+               std::unique_ptr<Statement> rhs);
 
-    // Calculates the value of lhs and rhs expressions and returns the result of the comparator,
-    // reduced to runtime::Bool type
+    // Calculates the value of lhs and rhs expressions and returns the result of the operation
+    // applied by runtime::Compare, reduced to runtime::Bool type
     runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    runtime::Compiled Compile() override;
 private:
-    Comparator cmp_;
+    runtime::CompareOperation operation_;
 };
 
+/*
+ * Operations of the statements on the calculated values. Both backends execute the statements
+ * through them, and the machine code of the JIT (see jit.h) and the C++ code written
+ * by EmitCpp (see cpp_emitter.h) call them directly
+ */
+
+// Returns the value of the variable. If there is no such variable, runtime_error is thrown
+const runtime::ObjectHolder& LoadVariable(const runtime::Closure& closure, const std::string& name);
+// Returns the field of the object named object_name. If the object is not a class instance
+// or it has no such field, runtime_error is thrown
+const runtime::ObjectHolder& LoadField(const runtime::ObjectHolder& object, const std::string& field,
+                                       const std::string& object_name);
+// Returns the class instance whose field is assigned. If it is something else,
+// runtime_error is thrown
+runtime::ClassInstance& FieldOwner(const runtime::ObjectHolder& object);
+
+// Prints the value or None to context.GetOutputStream()
+void PrintValue(const runtime::ObjectHolder& value, runtime::Context& context);
+// Throws runtime_error if the object has no methods to call
+void CheckMethodReceiver(const runtime::ObjectHolder& object);
+runtime::ObjectHolder CallMethod(const runtime::ObjectHolder& object, const std::string& method,
+                                 const runtime::ObjectHolder* args, size_t count,
+                                 runtime::Context& context);
+
+runtime::ObjectHolder StringValue(const runtime::ObjectHolder& value, runtime::Context& context);
+// Returns the separator of join. If it is not a string, runtime_error is thrown
+const runtime::String& SeparatorOf(const runtime::ObjectHolder& separator);
+runtime::ObjectHolder JoinValues(const runtime::String& separator, runtime::ObjectHolder iterable,
+                                 runtime::Context& context);
+runtime::ObjectHolder MakeRange(const runtime::ObjectHolder& start,
+                                const runtime::ObjectHolder& stop);
+
+// The arithmetic operations (see Add, Sub, Mult and Div)
+runtime::ObjectHolder AddObjects(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                                 runtime::Context& context);
+runtime::ObjectHolder SubtractObjects(const runtime::ObjectHolder& lhs,
+                                      const runtime::ObjectHolder& rhs, runtime::Context& context);
+runtime::ObjectHolder MultiplyObjects(const runtime::ObjectHolder& lhs,
+                                      const runtime::ObjectHolder& rhs, runtime::Context& context);
+runtime::ObjectHolder DivideObjects(const runtime::ObjectHolder& lhs,
+                                    const runtime::ObjectHolder& rhs, runtime::Context& context);
+// Returns the result of runtime::Compare as a Bool
+runtime::ObjectHolder CompareObjects(runtime::CompareOperation operation,
+                                     const runtime::ObjectHolder& lhs,
+                                     const runtime::ObjectHolder& rhs, runtime::Context& context);
+
 }  // namespace ast
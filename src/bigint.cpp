@@ -0,0 +1,351 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+namespace {
+using Digits = vector<uint32_t>;
+
+constexpr uint64_t BASE = uint64_t{1} << 32;
+constexpr uint32_t DECIMAL_CHUNK = 1'000'000'000;
+constexpr int DECIMAL_CHUNK_DIGITS = 9;
+
+void Trim(Digits& digits) {
+    while (!digits.empty() && digits.back() == 0) {
+        digits.pop_back();
+    }
+}
+
+int CompareMagnitudes(const Digits& lhs, const Digits& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    for (size_t i = lhs.size(); i-- > 0;) {
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+Digits AddMagnitudes(const Digits& lhs, const Digits& rhs) {
+    const Digits& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+    const Digits& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+    Digits result;
+    result.reserve(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        uint64_t sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+        result.push_back(static_cast<uint32_t>(sum));
+        carry = sum >> 32;
+    }
+    if (carry != 0) {
+        result.push_back(static_cast<uint32_t>(carry));
+    }
+    return result;
+}
+
+// lhs must not be less than rhs
+Digits SubtractMagnitudes(const Digits& lhs, const Digits& rhs) {
+    Digits result;
+    result.reserve(lhs.size());
+    int64_t borrow = 0;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        int64_t difference = static_cast<int64_t>(lhs[i]) - borrow - (i < rhs.size() ? rhs[i] : 0);
+        borrow = difference < 0 ? 1 : 0;
+        result.push_back(static_cast<uint32_t>(difference + borrow * static_cast<int64_t>(BASE)));
+    }
+    assert(borrow == 0);
+    Trim(result);
+    return result;
+}
+
+// Adds addend * BASE^shift to the result, which is long enough to hold the sum
+void AddShifted(Digits& result, const Digits& addend, size_t shift) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < addend.size() || carry != 0; ++i) {
+        assert(shift + i < result.size());
+        uint64_t sum = carry + result[shift + i] + (i < addend.size() ? addend[i] : 0);
+        result[shift + i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+Digits MultiplySchoolbook(const Digits& lhs, const Digits& rhs) {
+    Digits result(lhs.size() + rhs.size(), 0);
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.size(); ++j) {
+            uint64_t current = static_cast<uint64_t>(lhs[i]) * rhs[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        result[i + rhs.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(result);
+    return result;
+}
+
+pair<Digits, Digits> Split(const Digits& digits, size_t low_size) {
+    if (digits.size() <= low_size) {
+        return {digits, {}};
+    }
+    Digits low(digits.begin(), digits.begin() + static_cast<ptrdiff_t>(low_size));
+    Digits high(digits.begin() + static_cast<ptrdiff_t>(low_size), digits.end());
+    Trim(low);
+    return {std::move(low), std::move(high)};
+}
+
+Digits MultiplyMagnitudes(const Digits& lhs, const Digits& rhs) {
+    if (lhs.empty() || rhs.empty()) {
+        return {};
+    }
+    if (min(lhs.size(), rhs.size()) < BigInteger::KARATSUBA_THRESHOLD) {
+        return MultiplySchoolbook(lhs, rhs);
+    }
+    // lhs = a1 * BASE^m + a0, rhs = b1 * BASE^m + b0
+    // lhs * rhs = z2 * BASE^2m + z1 * BASE^m + z0, where
+    // z2 = a1 * b1, z0 = a0 * b0, z1 = (a0 + a1) * (b0 + b1) - z2 - z0
+    const size_t m = max(lhs.size(), rhs.size()) / 2;
+    auto [a0, a1] = Split(lhs, m);
+    auto [b0, b1] = Split(rhs, m);
+    Digits z0 = MultiplyMagnitudes(a0, b0);
+    Digits z2 = MultiplyMagnitudes(a1, b1);
+    Digits z1 = MultiplyMagnitudes(AddMagnitudes(a0, a1), AddMagnitudes(b0, b1));
+    z1 = SubtractMagnitudes(SubtractMagnitudes(z1, z0), z2);
+
+    Digits result(lhs.size() + rhs.size(), 0);
+    AddShifted(result, z0, 0);
+    AddShifted(result, z1, m);
+    AddShifted(result, z2, 2 * m);
+    Trim(result);
+    return result;
+}
+
+Digits DivideBySmall(const Digits& dividend, uint32_t divisor, uint32_t& remainder) {
+    Digits result(dividend.size(), 0);
+    uint64_t rest = 0;
+    for (size_t i = dividend.size(); i-- > 0;) {
+        uint64_t current = (rest << 32) | dividend[i];
+        result[i] = static_cast<uint32_t>(current / divisor);
+        rest = current % divisor;
+    }
+    remainder = static_cast<uint32_t>(rest);
+    Trim(result);
+    return result;
+}
+
+void ShiftLeftByOneBit(Digits& digits) {
+    uint32_t carry = 0;
+    for (auto& digit : digits) {
+        uint32_t next_carry = digit >> 31;
+        digit = (digit << 1) | carry;
+        carry = next_carry;
+    }
+    if (carry != 0) {
+        digits.push_back(carry);
+    }
+}
+
+// Binary long division of the magnitudes
+Digits DivideMagnitudes(const Digits& dividend, const Digits& divisor) {
+    if (CompareMagnitudes(dividend, divisor) < 0) {
+        return {};
+    }
+    if (divisor.size() == 1) {
+        uint32_t remainder = 0;
+        return DivideBySmall(dividend, divisor[0], remainder);
+    }
+    Digits quotient(dividend.size(), 0);
+    Digits remainder;
+    for (size_t bit = dividend.size() * 32; bit-- > 0;) {
+        ShiftLeftByOneBit(remainder);
+        if ((dividend[bit / 32] >> (bit % 32)) & 1U) {
+            if (remainder.empty()) {
+                remainder.push_back(1);
+            } else {
+                remainder[0] |= 1U;
+            }
+        }
+        if (CompareMagnitudes(remainder, divisor) >= 0) {
+            remainder = SubtractMagnitudes(remainder, divisor);
+            quotient[bit / 32] |= 1U << (bit % 32);
+        }
+    }
+    Trim(quotient);
+    return quotient;
+}
+
+uint64_t ToMagnitude64(const Digits& digits) {
+    uint64_t result = 0;
+    for (size_t i = digits.size(); i-- > 0;) {
+        result = (result << 32) | digits[i];
+    }
+    return result;
+}
+}  // namespace
+
+BigInteger::BigInteger(int64_t value)
+    : negative_{value < 0} {
+    uint64_t magnitude = negative_ ? uint64_t{0} - static_cast<uint64_t>(value)
+                                   : static_cast<uint64_t>(value);
+    while (magnitude != 0) {
+        digits_.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+BigInteger::BigInteger(bool negative, Digits digits)
+    : negative_{negative}, digits_{std::move(digits)} {
+    Trim(digits_);
+    if (digits_.empty()) {
+        negative_ = false;
+    }
+}
+
+BigInteger BigInteger::FromString(string_view decimal) {
+    const bool negative = !decimal.empty() && decimal.front() == '-';
+    decimal.remove_prefix(negative ? 1 : 0);
+    if (decimal.empty() || decimal.find_first_not_of("0123456789"sv) != string_view::npos) {
+        throw invalid_argument("Not a decimal integer: "s + string(decimal));
+    }
+    // the magnitude is multiplied by 10^9 and the next chunk of nine digits is added
+    Digits digits;
+    size_t chunk_size = decimal.size() % DECIMAL_CHUNK_DIGITS;
+    chunk_size = chunk_size == 0 ? DECIMAL_CHUNK_DIGITS : chunk_size;
+    for (; !decimal.empty(); chunk_size = DECIMAL_CHUNK_DIGITS) {
+        uint64_t carry = 0;
+        for (char c : decimal.substr(0, chunk_size)) {
+            carry = carry * 10 + static_cast<uint64_t>(c - '0');
+        }
+        uint64_t multiplier = 1;
+        for (size_t i = 0; i < chunk_size; ++i) {
+            multiplier *= 10;
+        }
+        for (auto& digit : digits) {
+            carry += digit * multiplier;
+            digit = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            digits.push_back(static_cast<uint32_t>(carry));
+        }
+        decimal.remove_prefix(chunk_size);
+    }
+    return BigInteger(negative, std::move(digits));
+}
+
+bool BigInteger::FitsInt64() const {
+    if (digits_.size() > 2) {
+        return false;
+    }
+    const uint64_t magnitude = ToMagnitude64(digits_);
+    const uint64_t limit = uint64_t{1} << 63;
+    return negative_ ? magnitude <= limit : magnitude < limit;
+}
+
+int64_t BigInteger::ToInt64() const {
+    assert(FitsInt64());
+    const uint64_t magnitude = ToMagnitude64(digits_);
+    return static_cast<int64_t>(negative_ ? uint64_t{0} - magnitude : magnitude);
+}
+
+double BigInteger::ToDouble() const {
+    double result = 0;
+    for (size_t i = digits_.size(); i-- > 0;) {
+        result = result * static_cast<double>(BASE) + digits_[i];
+    }
+    return negative_ ? -result : result;
+}
+
+bool BigInteger::IsZero() const {
+    return digits_.empty();
+}
+
+bool BigInteger::IsNegative() const {
+    return negative_;
+}
+
+int BigInteger::Compare(const BigInteger& rhs) const {
+    if (negative_ != rhs.negative_) {
+        return negative_ ? -1 : 1;
+    }
+    const int magnitude = CompareMagnitudes(digits_, rhs.digits_);
+    return negative_ ? -magnitude : magnitude;
+}
+
+size_t BigInteger::Hash() const {
+    size_t result = negative_ ? 1 : 0;
+    for (auto digit : digits_) {
+        result = result * 1'000'003 + digit;
+    }
+    return result;
+}
+
+string BigInteger::ToString() const {
+    if (digits_.empty()) {
+        return "0"s;
+    }
+    vector<uint32_t> chunks;
+    Digits rest = digits_;
+    while (!rest.empty()) {
+        uint32_t chunk = 0;
+        rest = DivideBySmall(rest, DECIMAL_CHUNK, chunk);
+        chunks.push_back(chunk);
+    }
+    string result = negative_ ? "-"s : ""s;
+    result += to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        string chunk = to_string(chunks[i]);
+        result.append(DECIMAL_CHUNK_DIGITS - chunk.size(), '0');
+        result += chunk;
+    }
+    return result;
+}
+
+BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs) {
+    if (lhs.negative_ == rhs.negative_) {
+        return BigInteger(lhs.negative_, AddMagnitudes(lhs.digits_, rhs.digits_));
+    }
+    if (CompareMagnitudes(lhs.digits_, rhs.digits_) >= 0) {
+        return BigInteger(lhs.negative_, SubtractMagnitudes(lhs.digits_, rhs.digits_));
+    }
+    return BigInteger(rhs.negative_, SubtractMagnitudes(rhs.digits_, lhs.digits_));
+}
+
+BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs) {
+    return lhs + BigInteger(!rhs.negative_, rhs.digits_);
+}
+
+BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger(lhs.negative_ != rhs.negative_,
+                      MultiplyMagnitudes(lhs.digits_, rhs.digits_));
+}
+
+BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs) {
+    if (rhs.IsZero()) {
+        throw runtime_error("Division by zero"s);
+    }
+    return BigInteger(lhs.negative_ != rhs.negative_, DivideMagnitudes(lhs.digits_, rhs.digits_));
+}
+
+bool operator==(const BigInteger& lhs, const BigInteger& rhs) {
+    return lhs.Compare(rhs) == 0;
+}
+
+bool operator<(const BigInteger& lhs, const BigInteger& rhs) {
+    return lhs.Compare(rhs) < 0;
+}
+
+ostream& operator<<(ostream& os, const BigInteger& value) {
+    return os << value.ToString();
+}
+
+}  // namespace runtime
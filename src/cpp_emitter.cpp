@@ -0,0 +1,884 @@
+#include "cpp_emitter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ios>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+const char* const PREAMBLE = R"(// Generated by mython --emit-cpp. Build it with the Mython runtime:
+// c++ -std=c++17 -O2 -pthread -I<mython>/include <this file> <mython>/src/runtime.cpp
+//     <mython>/src/bigint.cpp <mython>/src/statement.cpp <mython>/src/jit.cpp
+#include "runtime.h"
+#include "statement.h"
+
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+using runtime::Closure;
+using runtime::Context;
+using runtime::ObjectHolder;
+
+// The body of a method emitted as a function
+class NativeBody : public runtime::Executable {
+public:
+    using Function = ObjectHolder (*)(Closure&, Context&);
+
+    explicit NativeBody(Function function)
+        : function_{function} {
+    }
+
+    ObjectHolder Execute(Closure& closure, Context& context) override {
+        return function_(closure, context);
+    }
+
+    [[nodiscard]] bool Runs(Function function) const {
+        return function_ == function;
+    }
+
+private:
+    Function function_;
+};
+
+// Returns true if the call of the method is a recursive call of the function, which the
+// function makes by rebinding its parameters and starting over, as MethodBody does
+[[maybe_unused]] bool IsSelfCall(const ObjectHolder& object, const std::string& method, size_t count,
+                NativeBody::Function function) {
+    const auto* instance = object.TryAs<runtime::ClassInstance>();
+    const auto* callee = instance ? instance->GetClass().GetMethod(method) : nullptr;
+    const auto* body = callee ? dynamic_cast<const NativeBody*>(callee->body.get()) : nullptr;
+    return body != nullptr && callee->formal_params.size() == count && body->Runs(function);
+}
+
+// The variables are C++ variables holding Unbound until they are assigned
+const runtime::Object* const UNBOUND = runtime::Unbound().Get();
+
+// Throws as ast::LoadVariable does if the variable has not been assigned
+[[maybe_unused]] void CheckAssigned(const ObjectHolder& variable, const std::string& name) {
+    if (variable.Get() == UNBOUND) {
+        throw std::runtime_error("Variable "s + name + " not found"s);
+    }
+}
+
+// The loop variable which has not been assigned before the loop is None, as in ForIn
+[[maybe_unused]] void DeclareLoopVariable(ObjectHolder& variable) {
+    if (variable.Get() == UNBOUND) {
+        variable = ObjectHolder::None();
+    }
+}
+
+// Calls the function of a method resolved while the code was written, entering the call
+// as ClassInstance::CallMethod does
+template <typename Body>
+ObjectHolder CallResolved(Body&& body) {
+    struct Call {
+        Call() {
+            runtime::call_stack.Enter();
+        }
+        ~Call() {
+            runtime::call_stack.Leave();
+        }
+    } call;
+    return runtime::call_stack.Run(std::forward<Body>(body));
+}
+
+// The values which the type inference has proven to be numbers, strings or bools
+[[maybe_unused]] int64_t NumberOf(const ObjectHolder& value) {
+    return static_cast<const runtime::Number*>(value.Get())->GetValue();
+}
+
+[[maybe_unused]] const std::string& StringOf(const ObjectHolder& value) {
+    return static_cast<const runtime::String*>(value.Get())->GetValue();
+}
+
+[[maybe_unused]] bool BoolOf(const ObjectHolder& value) {
+    return static_cast<const runtime::Bool*>(value.Get())->GetValue();
+}
+
+// Applies the operation to the numbers, falling back to the generic operation on the overflow
+// and the division by zero, as the proven operations of the interpreter do
+template <runtime::ArithmeticOperation operation>
+ObjectHolder NumberArithmetic(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context,
+                              ObjectHolder (*generic)(const ObjectHolder&, const ObjectHolder&,
+                                                      Context&)) {
+    int64_t result = 0;
+    if (runtime::CheckedArithmetic(operation, NumberOf(lhs), NumberOf(rhs), result)) {
+        return runtime::MakeNumber(result);
+    }
+    return generic(lhs, rhs, context);
+}
+)";
+
+const char* const MAIN = R"(
+int main() {
+    runtime::SimpleContext context{std::cout};
+    try {
+        RunProgram(context);
+    } catch (const std::exception& e) {
+        std::cout.flush();
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+)";
+
+const string NONE = "ObjectHolder::None()"s;
+
+// Returns the C++ literal of the string
+string Quote(const string& value) {
+    string result = "\""s;
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"':
+                result += "\\\""s;
+                break;
+            case '\\':
+                result += "\\\\"s;
+                break;
+            case '\n':
+                result += "\\n"s;
+                break;
+            case '\t':
+                result += "\\t"s;
+                break;
+            default:
+                if (c < 0x20 || c >= 0x7f) {
+                    char escaped[5];
+                    snprintf(escaped, sizeof(escaped), "\\%03o", c);
+                    result += escaped;
+                } else {
+                    result += static_cast<char>(c);
+                }
+        }
+    }
+    return result + "\""s;
+}
+
+string IntegerLiteral(int64_t value) {
+    if (value == numeric_limits<int64_t>::min()) {
+        return "std::numeric_limits<int64_t>::min()"s;
+    }
+    return "int64_t{"s + to_string(value) + "}"s;
+}
+
+string FloatLiteral(double value) {
+    ostringstream os;
+    os << hexfloat << value;
+    return os.str();
+}
+
+string BoolLiteral(bool value) {
+    return value ? "true"s : "false"s;
+}
+
+string OperationName(runtime::CompareOperation operation) {
+    switch (operation) {
+        case runtime::CompareOperation::EQUAL:
+            return "EQUAL"s;
+        case runtime::CompareOperation::NOT_EQUAL:
+            return "NOT_EQUAL"s;
+        case runtime::CompareOperation::LESS:
+            return "LESS"s;
+        case runtime::CompareOperation::GREATER:
+            return "GREATER"s;
+        case runtime::CompareOperation::LESS_OR_EQUAL:
+            return "LESS_OR_EQUAL"s;
+        case runtime::CompareOperation::GREATER_OR_EQUAL:
+            return "GREATER_OR_EQUAL"s;
+    }
+    return {};
+}
+
+string OperatorOf(runtime::CompareOperation operation) {
+    switch (operation) {
+        case runtime::CompareOperation::EQUAL:
+            return "=="s;
+        case runtime::CompareOperation::NOT_EQUAL:
+            return "!="s;
+        case runtime::CompareOperation::LESS:
+            return "<"s;
+        case runtime::CompareOperation::GREATER:
+            return ">"s;
+        case runtime::CompareOperation::LESS_OR_EQUAL:
+            return "<="s;
+        case runtime::CompareOperation::GREATER_OR_EQUAL:
+            return ">="s;
+    }
+    return {};
+}
+
+// Returns true if the class is derived from the base one
+bool IsDerived(const runtime::Class& cls, const runtime::Class& base) {
+    for (const auto* parent = cls.GetParent(); parent != nullptr; parent = parent->GetParent()) {
+        if (parent == &base) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+/*
+ * Every statement is written as a sequence of C++ statements which leave its value in a
+ * temporary, and the statements of a compound are put into blocks of their own,
+ * so that the temporaries are released when the interpreter would release them.
+ * A method body sees only its own variables, so the variables of the program and of every
+ * method are C++ variables, and a method becomes a function of self and its parameters.
+ * A call made on self, or on a variable which is assigned only instances of a class, calls
+ * that function directly if no class of the program derived from the class overrides
+ * the method. The operations which the type inference has proven to be made on numbers
+ * or strings are made on their values, and a comparison in a condition is not boxed.
+ * A return inside a loop can't return from the lambda passed to runtime::Iterate:
+ * it stores the value, stops the iteration and is returned after the loop.
+ * A method calling itself in the tail position jumps back to the start of its function
+ * instead, so the recursion does not grow the stack, as in MethodBody
+ */
+class CppEmitter {
+public:
+    void EmitProgram(const Statement& program, ostream& out) {
+        CollectClasses(program);
+        for (const auto* cls : classes_) {
+            EmitClass(*cls);
+        }
+        const string body = EmitFunction(program);
+        out << PREAMBLE << '\n' << declarations_.str() << '\n' << prototypes_.str() << '\n'
+            << classes_code_.str() << functions_.str()
+            << "ObjectHolder RunProgram(Context& context) {\n"sv << body
+            << "}\n\n}  // namespace\n"sv << MAIN;
+    }
+
+private:
+    // The state of the function being written
+    struct Function {
+        ostringstream body;
+        int indent = 1;
+        int loop_depth = 0;
+        int temporaries = 0;
+        bool returns_from_loop = false;
+        // The method, nullptr for the program
+        const runtime::Method* method = nullptr;
+        // The variables used except self and the parameters, declared at the start
+        set<string> variables;
+        // The class whose instances or those of its derived classes the variable holds,
+        // nullptr if it may hold something else
+        unordered_map<string, const runtime::Class*> instances;
+        // A recursive call in the tail position jumps to the start of the body
+        bool tail_calls = false;
+        bool restarts_from_loop = false;
+    };
+
+    // Writes the statements of the function body and returns them
+    string EmitFunction(const Statement& statement, const runtime::Class* cls = nullptr,
+                        const runtime::Method* method = nullptr) {
+        Function function;
+        function.method = method;
+        if (method != nullptr) {
+            function.instances["self"s] = cls;
+            for (const auto& param : method->formal_params) {
+                function.instances[param] = nullptr;
+            }
+        }
+        FindInstances(statement, function);
+        Function* enclosing = std::exchange(function_, &function);
+        Emit(statement);
+        Line("return "s + NONE + ";"s);
+        function_ = enclosing;
+
+        // the jump back declares the variables again, so they are unbound as in a new frame
+        string result = function.tail_calls ? "tail_call:\n"s : ""s;
+        for (const auto& variable : function.variables) {
+            result += "    ObjectHolder "s + CppName(variable) + " = runtime::Unbound();\n"s;
+        }
+        if (function.returns_from_loop) {
+            result += "    bool returning = false;\n    ObjectHolder returned;\n"s;
+        }
+        if (function.restarts_from_loop) {
+            result += "    bool restarting = false;\n"s;
+        }
+        return result + function.body.str();
+    }
+
+    // Finds the classes of the instances which the variables of the function hold
+    static void FindInstances(const Statement& statement, Function& function) {
+        if (auto compound = dynamic_cast<const Compound*>(&statement)) {
+            for (const auto& arg : compound->args_) {
+                FindInstances(*arg, function);
+            }
+        } else if (auto body = dynamic_cast<const MethodBody*>(&statement)) {
+            FindInstances(*body->body_, function);
+        } else if (auto if_else = dynamic_cast<const IfElse*>(&statement)) {
+            FindInstances(*if_else->if_body_, function);
+            if (if_else->else_body_) {
+                FindInstances(*if_else->else_body_, function);
+            }
+        } else if (auto for_in = dynamic_cast<const ForIn*>(&statement)) {
+            function.instances[for_in->var_] = nullptr;
+            FindInstances(*for_in->body_, function);
+        } else if (auto assignment = dynamic_cast<const Assignment*>(&statement)) {
+            const auto* new_instance = dynamic_cast<const NewInstance*>(assignment->rv_.get());
+            const auto* cls = new_instance ? &new_instance->class_ : nullptr;
+            auto [it, inserted] = function.instances.emplace(assignment->var_, cls);
+            if (!inserted && it->second != cls) {
+                it->second = nullptr;
+            }
+        } else if (auto definition = dynamic_cast<const ClassDefinition*>(&statement)) {
+            function.instances[definition->cls_.TryAs<runtime::Class>()->GetName()] = nullptr;
+        }
+    }
+
+    // Finds the classes defined in the program and names the functions of their methods
+    void CollectClasses(const Statement& statement) {
+        if (auto compound = dynamic_cast<const Compound*>(&statement)) {
+            for (const auto& arg : compound->args_) {
+                CollectClasses(*arg);
+            }
+        } else if (auto body = dynamic_cast<const MethodBody*>(&statement)) {
+            CollectClasses(*body->body_);
+        } else if (auto if_else = dynamic_cast<const IfElse*>(&statement)) {
+            CollectClasses(*if_else->if_body_);
+            if (if_else->else_body_) {
+                CollectClasses(*if_else->else_body_);
+            }
+        } else if (auto for_in = dynamic_cast<const ForIn*>(&statement)) {
+            CollectClasses(*for_in->body_);
+        } else if (auto definition = dynamic_cast<const ClassDefinition*>(&statement)) {
+            const auto& cls = *definition->cls_.TryAs<runtime::Class>();
+            const string number = to_string(classes_.size());
+            if (!classes_ids_.emplace(&cls, "Class"s + number).second) {
+                return;
+            }
+            classes_.push_back(&cls);
+            for (const auto& method : cls.GetMethods()) {
+                methods_.emplace(&method, "Class"s + number + "_"s + method.name);
+                entries_.emplace(&method, "Entry"s + number + "_"s + method.name);
+                CollectClasses(*method.body);
+            }
+        }
+    }
+
+    // Returns the method which the call always calls, nullptr if it is not known
+    const runtime::Method* Resolve(const MethodCall& call) const {
+        const auto* variable = dynamic_cast<const VariableValue*>(call.object_.get());
+        if (variable == nullptr || !variable->fields_.empty()) {
+            return nullptr;
+        }
+        auto it = function_->instances.find(variable->var_name_);
+        if (it == function_->instances.end() || it->second == nullptr) {
+            return nullptr;
+        }
+        const auto* method = it->second->GetMethod(call.method_);
+        if (method == nullptr || method->formal_params.size() != call.args_.size()
+            || methods_.count(method) == 0) {
+            return nullptr;
+        }
+        for (const auto* cls : classes_) {
+            if (IsDerived(*cls, *it->second) && cls->GetMethod(call.method_) != method) {
+                return nullptr;
+            }
+        }
+        return method;
+    }
+
+    void Line(const string& code) {
+        function_->body << string(function_->indent * 4, ' ') << code << '\n';
+    }
+
+    void Open(const string& code) {
+        Line(code);
+        ++function_->indent;
+    }
+
+    void Close(const string& code = "}"s) {
+        --function_->indent;
+        Line(code);
+    }
+
+    string NewTemporary() {
+        return "t"s + to_string(function_->temporaries++);
+    }
+
+    // Stores the value into a new temporary and returns its name
+    string Temporary(const string& value) {
+        string name = NewTemporary();
+        Line("ObjectHolder "s + name + " = "s + value + ";"s);
+        return name;
+    }
+
+    // Returns the constant holding the identifier
+    string Name(const string& id) {
+        auto [it, inserted] = names_.emplace(id, "name_"s + to_string(names_.size()));
+        if (inserted) {
+            declarations_ << "const std::string "sv << it->second << " = "sv << Quote(id) << ";\n"sv;
+        }
+        return it->second;
+    }
+
+    // Returns true if the variable is self or a parameter of the method, which are always bound
+    bool IsParameter(const string& name) const {
+        if (function_->method == nullptr) {
+            return false;
+        }
+        const auto& params = function_->method->formal_params;
+        return name == "self"s || find(params.begin(), params.end(), name) != params.end();
+    }
+
+    // Returns the C++ variable of the variable
+    string Variable(const string& name) {
+        if (!IsParameter(name)) {
+            function_->variables.insert(name);
+        }
+        return CppName(name);
+    }
+
+    // The variables of the program become v_<name>, the temporaries $<n> of the IR become
+    // t_<n>, so that the two never clash and $ does not reach the C++ code
+    static string CppName(const string& name) {
+        if (!name.empty() && name[0] == '$') {
+            return "t_"s + name.substr(1);
+        }
+        return "v_"s + name;
+    }
+
+    // Declares the constant object and returns an expression sharing it
+    string Constant(const string& type, const string& value) {
+        string name = "constant_"s + to_string(constants_++);
+        declarations_ << type << ' ' << name << '{' << value << "};\n"sv;
+        return "ObjectHolder::Share("s + name + ")"s;
+    }
+
+    // Writes the values of the arguments into an array and returns its name and size
+    string Arguments(const vector<unique_ptr<Statement>>& args) {
+        if (args.empty()) {
+            return "nullptr, 0"s;
+        }
+        vector<string> values;
+        for (const auto& arg : args) {
+            values.push_back(Emit(*arg));
+        }
+        string array = NewTemporary();
+        string list;
+        for (const auto& value : values) {
+            list += (list.empty() ? ""s : ", "s) + value;
+        }
+        Line("const ObjectHolder "s + array + "[] = {"s + list + "};"s);
+        return array + ", "s + to_string(args.size());
+    }
+
+    string ClassOf(const runtime::Class& cls) const {
+        auto it = classes_ids_.find(&cls);
+        if (it == classes_ids_.end()) {
+            throw runtime_error("Class "s + cls.GetName() + " is used before its definition"s);
+        }
+        return it->second + "()"s;
+    }
+
+    // Writes the statement and returns an expression of its value, which is either a temporary
+    // or has no side effects, so that it can be evaluated at any moment
+    string Emit(const Statement& statement) {
+        if (auto constant = dynamic_cast<const NumericConst*>(&statement)) {
+            return Constant("runtime::Number"s, IntegerLiteral(constant->value_.GetValue()));
+        }
+        if (auto constant = dynamic_cast<const BigIntConst*>(&statement)) {
+            return Constant("runtime::BigInt"s, "runtime::BigInteger::FromString("s
+                                                    + Quote(constant->value_.GetValue().ToString())
+                                                    + "sv)"s);
+        }
+        if (auto constant = dynamic_cast<const FloatConst*>(&statement)) {
+            return Constant("runtime::Float"s, FloatLiteral(constant->value_.GetValue()));
+        }
+        if (auto constant = dynamic_cast<const StringConst*>(&statement)) {
+            return Constant("runtime::String"s, Quote(constant->value_.GetValue()) + "s"s);
+        }
+        if (auto constant = dynamic_cast<const BoolConst*>(&statement)) {
+            return Constant("runtime::Bool"s, BoolLiteral(constant->value_.GetValue()));
+        }
+        if (dynamic_cast<const None*>(&statement)) {
+            return NONE;
+        }
+        if (auto variable = dynamic_cast<const VariableValue*>(&statement)) {
+            return EmitVariable(*variable);
+        }
+        if (auto assignment = dynamic_cast<const Assignment*>(&statement)) {
+            string value = Emit(*assignment->rv_);
+            Line(Variable(assignment->var_) + " = "s + value + ";"s);
+            return value;
+        }
+        if (auto assignment = dynamic_cast<const FieldAssignment*>(&statement)) {
+            string fields = NewTemporary();
+            Line("auto& "s + fields + " = ast::FieldOwner("s + EmitVariable(assignment->object_)
+                 + ").Fields();"s);
+            string value = Emit(*assignment->rv_);
+            Line(fields + "["s + Name(assignment->field_name_) + "] = "s + value + ";"s);
+            return value;
+        }
+        if (auto print = dynamic_cast<const Print*>(&statement)) {
+            bool first = true;
+            for (const auto& arg : print->args_) {
+                if (!first) {
+                    Line("context.GetOutputStream() << \" \";"s);
+                }
+                Line("ast::PrintValue("s + Emit(*arg) + ", context);"s);
+                first = false;
+            }
+            Line("context.GetOutputStream() << \"\\n\";"s);
+            return NONE;
+        }
+        if (auto call = dynamic_cast<const MethodCall*>(&statement)) {
+            if (const auto* method = Resolve(*call)) {
+                return EmitResolvedCall(*method, Emit(*call->object_), call->args_);
+            }
+            string object = Emit(*call->object_);
+            Line("ast::CheckMethodReceiver("s + object + ");"s);
+            string args = Arguments(call->args_);
+            return Temporary("ast::CallMethod("s + object + ", "s + Name(call->method_) + ", "s
+                             + args + ", context)"s);
+        }
+        if (auto new_instance = dynamic_cast<const NewInstance*>(&statement)) {
+            const auto& cls = new_instance->class_;
+            string instance = Temporary("ObjectHolder::Own(runtime::ClassInstance("s
+                                        + ClassOf(cls) + "))"s);
+            // the class is known, so is its constructor
+            const auto* init = cls.GetMethod(runtime::SpecialMethod::INIT);
+            if (init != nullptr && init->formal_params.size() == new_instance->args_.size()) {
+                EmitResolvedCall(*init, instance, new_instance->args_);
+            }
+            return instance;
+        }
+        if (dynamic_cast<const NewDict*>(&statement)) {
+            return Temporary("ObjectHolder::Own(runtime::Dict())"s);
+        }
+        if (auto range = dynamic_cast<const NewRange*>(&statement)) {
+            string start = Emit(*range->start_);
+            string stop = Emit(*range->stop_);
+            return Temporary("ast::MakeRange("s + start + ", "s + stop + ")"s);
+        }
+        if (auto stringify = dynamic_cast<const Stringify*>(&statement)) {
+            return Temporary("ast::StringValue("s + Emit(*stringify->argument_) + ", context)"s);
+        }
+        if (auto join = dynamic_cast<const Join*>(&statement)) {
+            string separator = NewTemporary();
+            Line("const runtime::String& "s + separator + " = ast::SeparatorOf("s
+                 + Emit(*join->separator_) + ");"s);
+            string iterable = Emit(*join->iterable_);
+            return Temporary("ast::JoinValues("s + separator + ", "s + iterable + ", context)"s);
+        }
+        if (dynamic_cast<const Add*>(&statement)) {
+            return EmitArithmetic(statement, "ADD"s, "ast::AddObjects"s);
+        }
+        if (dynamic_cast<const Sub*>(&statement)) {
+            return EmitArithmetic(statement, "SUB"s, "ast::SubtractObjects"s);
+        }
+        if (dynamic_cast<const Mult*>(&statement)) {
+            return EmitArithmetic(statement, "MULT"s, "ast::MultiplyObjects"s);
+        }
+        if (dynamic_cast<const Div*>(&statement)) {
+            return EmitArithmetic(statement, "DIV"s, "ast::DivideObjects"s);
+        }
+        if (auto comparison = dynamic_cast<const Comparison*>(&statement)) {
+            return Temporary("runtime::MakeBool("s + EmitComparison(*comparison) + ")"s);
+        }
+        if (dynamic_cast<const Or*>(&statement)) {
+            return EmitLogical(statement, true);
+        }
+        if (dynamic_cast<const And*>(&statement)) {
+            return EmitLogical(statement, false);
+        }
+        if (auto negation = dynamic_cast<const Not*>(&statement)) {
+            return Temporary("runtime::MakeBool(!runtime::IsTrue("s + Emit(*negation->argument_)
+                             + "))"s);
+        }
+        if (auto compound = dynamic_cast<const Compound*>(&statement)) {
+            for (const auto& arg : compound->args_) {
+                Open("{"s);
+                Emit(*arg);
+                Close();
+            }
+            return NONE;
+        }
+        if (auto body = dynamic_cast<const MethodBody*>(&statement)) {
+            return Emit(*body->body_);
+        }
+        if (auto return_statement = dynamic_cast<const Return*>(&statement)) {
+            string value = return_statement->tail_call_ && function_->method
+                ? EmitTailCall(*return_statement->tail_call_)
+                : Emit(*return_statement->statement_);
+            if (value.empty()) {
+                // the body has started over
+            } else if (function_->loop_depth == 0) {
+                Line("return "s + value + ";"s);
+            } else {
+                function_->returns_from_loop = true;
+                Line("returned = "s + value + ";"s);
+                Line("returning = true;"s);
+                Line("return false;"s);
+            }
+            return NONE;
+        }
+        if (auto definition = dynamic_cast<const ClassDefinition*>(&statement)) {
+            const auto& cls = *definition->cls_.TryAs<runtime::Class>();
+            Line(Variable(cls.GetName()) + " = ObjectHolder::Share("s + ClassOf(cls) + ");"s);
+            return NONE;
+        }
+        if (auto if_else = dynamic_cast<const IfElse*>(&statement)) {
+            Open("if ("s + EmitCondition(*if_else) + ") {"s);
+            Emit(*if_else->if_body_);
+            if (if_else->else_body_) {
+                Close("} else {"s);
+                ++function_->indent;
+                Emit(*if_else->else_body_);
+            }
+            Close();
+            return NONE;
+        }
+        if (auto for_in = dynamic_cast<const ForIn*>(&statement)) {
+            return EmitForIn(*for_in);
+        }
+        throw runtime_error("Can't emit C++ code for statement "s + typeid(statement).name());
+    }
+
+    // Writes the call of the method resolved ahead, which calls its function directly
+    string EmitResolvedCall(const runtime::Method& method, const string& object,
+                            const vector<unique_ptr<Statement>>& args) {
+        string list = object;
+        for (const auto& arg : args) {
+            list += ", "s + Emit(*arg);
+        }
+        return Temporary("CallResolved([&] { return "s + methods_.at(&method) + "("s + list
+                         + ", context); })"s);
+    }
+
+    // Writes the call in the tail position of a method body. If it calls the method itself,
+    // self and the parameters are rebound and the body starts over as if the call had got
+    // a fresh frame (inside a loop the iteration stops first), and an empty string is returned
+    string EmitTailCall(const MethodCall& call) {
+        const auto* method = Resolve(call);
+        if (method != nullptr && method != function_->method) {
+            return EmitResolvedCall(*method, Emit(*call.object_), call.args_);
+        }
+        const auto& params = function_->method->formal_params;
+        string object = Emit(*call.object_);
+        if (method != nullptr) {
+            vector<string> values{Temporary(object)};
+            for (const auto& arg : call.args_) {
+                values.push_back(Temporary(Emit(*arg)));
+            }
+            Line("v_self = std::move("s + values[0] + ");"s);
+            for (size_t i = 0; i < params.size(); ++i) {
+                Line("v_"s + params[i] + " = std::move("s + values[i + 1] + ");"s);
+            }
+            StartOver();
+            return {};
+        }
+        Line("ast::CheckMethodReceiver("s + object + ");"s);
+        string args = Arguments(call.args_);
+        if (call.args_.size() == params.size()) {
+            Open("if (IsSelfCall("s + object + ", "s + Name(call.method_) + ", "s
+                 + to_string(call.args_.size()) + ", "s + entries_.at(function_->method) + ")) {"s);
+            Line("v_self = "s + object + ";"s);
+            for (size_t i = 0; i < params.size(); ++i) {
+                Line("v_"s + params[i] + " = "s + args.substr(0, args.find(',')) + "["s
+                     + to_string(i) + "];"s);
+            }
+            StartOver();
+            Close();
+        }
+        return Temporary("ast::CallMethod("s + object + ", "s + Name(call.method_) + ", "s + args
+                         + ", context)"s);
+    }
+
+    // Jumps to the start of the function body, after the loops have stopped
+    void StartOver() {
+        function_->tail_calls = true;
+        if (function_->loop_depth == 0) {
+            Line("goto tail_call;"s);
+        } else {
+            function_->restarts_from_loop = true;
+            Line("restarting = true;"s);
+            Line("return false;"s);
+        }
+    }
+
+    string EmitVariable(const VariableValue& variable) {
+        string value = Variable(variable.var_name_);
+        if (!IsParameter(variable.var_name_)) {
+            Line("CheckAssigned("s + value + ", "s + Name(variable.var_name_) + ");"s);
+        }
+        if (variable.fields_.empty()) {
+            return value;
+        }
+        const string* name = &variable.var_name_;
+        for (const auto& field : variable.fields_) {
+            value = "ast::LoadField("s + value + ", "s + Name(field) + ", "s + Name(*name) + ")"s;
+            name = &field;
+        }
+        return Temporary(value);
+    }
+
+    string EmitArithmetic(const Statement& statement, const string& operation,
+                          const string& generic) {
+        const auto& binary = static_cast<const BinaryOperation&>(statement);
+        string lhs = Emit(*binary.lhs_);
+        string rhs = Emit(*binary.rhs_);
+        if (!binary.quickening_.IsProven()) {
+            return Temporary(generic + "("s + lhs + ", "s + rhs + ", context)"s);
+        }
+        if (binary.quickening_.GetSpecialization() == Quickening::Operands::STRINGS) {
+            return Temporary("ObjectHolder::Own(runtime::String::Concat("s
+                             + "*static_cast<const runtime::String*>("s + lhs + ".Get()), "s
+                             + "*static_cast<const runtime::String*>("s + rhs + ".Get())))"s);
+        }
+        return Temporary("NumberArithmetic<runtime::ArithmeticOperation::"s + operation + ">("s
+                         + lhs + ", "s + rhs + ", context, "s + generic + ")"s);
+    }
+
+    // Writes the operands of the comparison and returns the C++ expression of its result
+    string EmitComparison(const Comparison& comparison) {
+        string lhs = Emit(*comparison.lhs_);
+        string rhs = Emit(*comparison.rhs_);
+        if (!comparison.quickening_.IsProven()) {
+            return "runtime::Compare(runtime::CompareOperation::"s
+                + OperationName(comparison.operation_) + ", "s + lhs + ", "s + rhs
+                + ", context)"s;
+        }
+        const string value =
+            comparison.quickening_.GetSpecialization() == Quickening::Operands::STRINGS
+            ? "StringOf"s
+            : "NumberOf"s;
+        return value + "("s + lhs + ") "s + OperatorOf(comparison.operation_) + " "s + value
+            + "("s + rhs + ")"s;
+    }
+
+    // Writes the condition of if and returns the C++ expression of its truth
+    string EmitCondition(const IfElse& if_else) {
+        if (auto comparison = dynamic_cast<const Comparison*>(if_else.condition_.get())) {
+            return EmitComparison(*comparison);
+        }
+        string value = Emit(*if_else.condition_);
+        return (if_else.bool_condition_ ? "BoolOf("s : "runtime::IsTrue("s) + value + ")"s;
+    }
+
+    // Writes or (is_or) or and with the short circuit evaluation of rhs
+    string EmitLogical(const Statement& statement, bool is_or) {
+        const auto& operation = static_cast<const BinaryOperation&>(statement);
+        string result = NewTemporary();
+        Line("ObjectHolder "s + result + ";"s);
+        string lhs = Emit(*operation.lhs_);
+        Open("if ("s + (is_or ? ""s : "!"s) + "runtime::IsTrue("s + lhs + ")) {"s);
+        Line(result + " = runtime::MakeBool("s + BoolLiteral(is_or) + ");"s);
+        Close("} else {"s);
+        ++function_->indent;
+        string rhs = Emit(*operation.rhs_);
+        Line(result + " = runtime::MakeBool(runtime::IsTrue("s + rhs + "));"s);
+        Close();
+        return result;
+    }
+
+    string EmitForIn(const ForIn& for_in) {
+        Open("{"s);
+        const string variable = Variable(for_in.var_);
+        Line("DeclareLoopVariable("s + variable + ");"s);
+        // the body may assign the variable holding the iterable
+        string iterable = Temporary(Emit(*for_in.iterable_));
+        string item = NewTemporary();
+        Open("runtime::Iterate("s + iterable + ", context, [&](ObjectHolder "s + item + ") {"s);
+        ++function_->loop_depth;
+        Line(variable + " = std::move("s + item + ");"s);
+        Emit(*for_in.body_);
+        Line("return true;"s);
+        --function_->loop_depth;
+        Close("});"s);
+        if (function_->returns_from_loop) {
+            Open("if (returning) {"s);
+            Line(function_->loop_depth == 0 ? "return returned;"s : "return false;"s);
+            Close();
+        }
+        if (function_->restarts_from_loop) {
+            Open("if (restarting) {"s);
+            Line(function_->loop_depth == 0 ? "goto tail_call;"s : "return false;"s);
+            Close();
+        }
+        Close();
+        return NONE;
+    }
+
+    void EmitClass(const runtime::Class& cls) {
+        const string& id = classes_ids_.at(&cls);
+        ostringstream methods;
+        for (const auto& method : cls.GetMethods()) {
+            const string& function = methods_.at(&method);
+            const string& entry = entries_.at(&method);
+            string params = "ObjectHolder v_self"s;
+            string args = "ast::LoadVariable(closure, "s + Name("self"s) + ")"s;
+            string names;
+            for (const auto& param : method.formal_params) {
+                params += ", ObjectHolder v_"s + param;
+                args += ", ast::LoadVariable(closure, "s + Name(param) + ")"s;
+                names += (names.empty() ? ""s : ", "s) + Quote(param) + "s"s;
+            }
+            prototypes_ << "ObjectHolder "sv << function << '(' << params
+                        << ", Context& context);\n"sv;
+            prototypes_ << "ObjectHolder "sv << entry << "(Closure& closure, Context& context);\n"sv;
+            functions_ << "ObjectHolder "sv << function << '(' << params
+                       << ", Context& context) {\n"sv << EmitFunction(*method.body, &cls, &method)
+                       << "}\n\n"sv;
+            // the body called by the runtime takes self and the parameters from the frame
+            functions_ << "ObjectHolder "sv << entry << "(Closure& closure, Context& context) {\n"sv
+                       << "    return "sv << function << '(' << args << ", context);\n}\n\n"sv;
+            methods << "        methods.push_back({"sv << Quote(method.name) << "s, {"sv << names
+                    << "}, std::make_unique<NativeBody>("sv << entry << ")});\n"sv;
+        }
+
+        const string parent = cls.GetParent() ? "&"s + ClassOf(*cls.GetParent()) : "nullptr"s;
+        classes_code_ << "runtime::Class& "sv << id << "() {\n"sv
+                      << "    static runtime::Class cls = [] {\n"sv
+                      << "        std::vector<runtime::Method> methods;\n"sv << methods.str()
+                      << "        return runtime::Class("sv << Quote(cls.GetName())
+                      << "s, std::move(methods), "sv << parent << ");\n"sv
+                      << "    }();\n"sv
+                      << "    return cls;\n"sv
+                      << "}\n\n"sv;
+        prototypes_ << "runtime::Class& "sv << id << "();\n"sv;
+    }
+
+    ostringstream declarations_;
+    ostringstream prototypes_;
+    ostringstream classes_code_;
+    ostringstream functions_;
+    unordered_map<string, string> names_;
+    // The classes of the program in the order of their definitions
+    vector<const runtime::Class*> classes_;
+    unordered_map<const runtime::Class*, string> classes_ids_;
+    // The functions of the methods and the bodies called by the runtime
+    unordered_map<const runtime::Method*, string> methods_;
+    unordered_map<const runtime::Method*, string> entries_;
+    int constants_ = 0;
+    Function* function_ = nullptr;
+};
+
+void EmitCpp(const Statement& program, ostream& out) {
+    CppEmitter emitter;
+    emitter.EmitProgram(program, out);
+}
+
+}  // namespace ast
@@ -0,0 +1,1172 @@
+#include "ir.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+using namespace std;
+
+namespace ast {
+
+namespace ir {
+
+bool IsDetached(const Instruction& instruction) {
+    if (instruction.removed) {
+        return true;
+    }
+    for (const Instruction* user = instruction.user; user != nullptr; user = user->user) {
+        if (user->removed || user->opcode == Opcode::CONSTANT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// Follows the assignments and the reads of the variables to the instruction calculating the value
+const Instruction* Root(const Instruction* instruction) {
+    while (instruction->opcode == Opcode::COPY || instruction->opcode == Opcode::VARIABLE) {
+        instruction = instruction->operands[0];
+    }
+    return instruction;
+}
+
+// Returns true if the version is assigned on every path, so reading it does not throw
+bool IsDefined(const Instruction* version, unordered_set<const Instruction*>& visited) {
+    if (version->opcode == Opcode::UNDEFINED) {
+        return false;
+    }
+    if (version->opcode != Opcode::PHI || !visited.insert(version).second) {
+        return true;
+    }
+    return all_of(version->operands.begin(), version->operands.end(),
+                  [&visited](const Instruction* operand) {
+                      return IsDefined(operand, visited);
+                  });
+}
+
+bool IsDefined(const Instruction* version) {
+    unordered_set<const Instruction*> visited;
+    return IsDefined(version, visited);
+}
+
+// Returns true if the variable of the version holds it in the environment
+bool IsBound(const Environment& environment, const Instruction* version) {
+    if (version->name.empty()) {
+        return false;
+    }
+    const auto it = environment.find(version->name);
+    return it != environment.end() && it->second == version;
+}
+
+// Returns true if the value may be a class instance: it is not a constant, a range or a dict
+bool MayBeInstance(const Instruction* value) {
+    const Instruction* root = Root(value);
+    if (root->opcode == Opcode::CONSTANT) {
+        return false;
+    }
+    return root->opcode != Opcode::CALL
+           || (dynamic_cast<NewRange*>(root->node) == nullptr
+               && dynamic_cast<NewDict*>(root->node) == nullptr);
+}
+
+/*
+ * Returns true if a method of the program may run in the instruction. A LOOP over an
+ * instance calls its __iter__ once and its __next__ before every iteration
+ */
+bool WritesMemory(const Instruction& instruction) {
+    switch (instruction.opcode) {
+        case Opcode::CALL:
+            return instruction.writes_memory;
+        case Opcode::LOOP:
+            return MayBeInstance(instruction.operands[0]);
+        case Opcode::STORE:
+        case Opcode::PRINT:
+            return true;
+        case Opcode::OPERATION:
+            // the operators of the instances call their special methods
+            if (instruction.operation == Operation::AND || instruction.operation == Operation::OR
+                || instruction.operation == Operation::NOT) {
+                return false;
+            }
+            return any_of(instruction.operands.begin(), instruction.operands.end(),
+                          [](const Instruction* operand) {
+                              return operand->opcode != Opcode::CONSTANT;
+                          });
+        default:
+            return false;
+    }
+}
+
+/*
+ * Replaces the values calculated from constants alone by the constants. A value is unknown
+ * until its operands are known, so the versions of the variables going around the loops
+ * are found constant unless the loop changes them
+ */
+class ConstantPropagation : public Pass {
+public:
+    [[nodiscard]] string_view GetName() const override {
+        return "constprop"sv;
+    }
+
+    size_t Run(Function& function) override {
+        values_.clear();
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto& instruction : function.instructions) {
+                changed = Update(*instruction) || changed;
+            }
+        }
+
+        // the users come after their operands, which are not rewritten once the user is
+        size_t changes = 0;
+        for (auto it = function.instructions.rbegin(); it != function.instructions.rend(); ++it) {
+            auto& instruction = *it;
+            const auto opcode = instruction->opcode;
+            if ((opcode != Opcode::VARIABLE && opcode != Opcode::OPERATION)
+                || instruction->slot == nullptr || IsDetached(*instruction)) {
+                continue;
+            }
+            if (const auto& value = values_[instruction.get()]; value.state == State::CONSTANT) {
+                instruction->opcode = Opcode::CONSTANT;
+                instruction->constant = value.constant;
+                instruction->operands.clear();
+                instruction->changed = true;
+                ++changes;
+            }
+        }
+        return changes;
+    }
+
+private:
+    enum class State : uint8_t { UNKNOWN, CONSTANT, VARYING };
+
+    struct Value {
+        State state = State::UNKNOWN;
+        runtime::ObjectHolder constant;
+    };
+
+    static bool IsSame(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs) {
+        if (!lhs || !rhs) {
+            return !lhs && !rhs;
+        }
+        const auto kind = runtime::GetKind(lhs);
+        if (kind != runtime::GetKind(rhs)) {
+            return false;
+        }
+        switch (kind) {
+            case runtime::ValueKind::BOOL:
+                return lhs.TryAs<runtime::Bool>()->GetValue()
+                    == rhs.TryAs<runtime::Bool>()->GetValue();
+            case runtime::ValueKind::NUMBER:
+                return lhs.TryAs<runtime::Number>()->GetValue()
+                    == rhs.TryAs<runtime::Number>()->GetValue();
+            case runtime::ValueKind::BIG_INT:
+                return lhs.TryAs<runtime::BigInt>()->GetValue()
+                    == rhs.TryAs<runtime::BigInt>()->GetValue();
+            case runtime::ValueKind::FLOAT: {
+                // 0.0 and -0.0 are equal, but they print differently
+                const double left = lhs.TryAs<runtime::Float>()->GetValue();
+                const double right = rhs.TryAs<runtime::Float>()->GetValue();
+                return left == right && std::signbit(left) == std::signbit(right);
+            }
+            case runtime::ValueKind::STRING:
+                return lhs.TryAs<runtime::String>()->GetValue()
+                    == rhs.TryAs<runtime::String>()->GetValue();
+            default:
+                return false;
+        }
+    }
+
+    // Returns true if the value of the instruction has moved up the lattice
+    bool Update(const Instruction& instruction) {
+        const Value value = Evaluate(instruction);
+        auto& current = values_[&instruction];
+        if (value.state == State::UNKNOWN || current.state == State::VARYING) {
+            return false;
+        }
+        if (current.state == State::CONSTANT) {
+            if (value.state == State::CONSTANT && IsSame(current.constant, value.constant)) {
+                return false;
+            }
+            current = {State::VARYING, {}};
+            return true;
+        }
+        current = value;
+        return true;
+    }
+
+    Value Evaluate(const Instruction& instruction) {
+        switch (instruction.opcode) {
+            case Opcode::CONSTANT:
+                return {State::CONSTANT, instruction.constant};
+            case Opcode::VARIABLE:
+            case Opcode::COPY:
+                return values_[instruction.operands[0]];
+            case Opcode::PHI:
+                return Meet(instruction.operands);
+            case Opcode::OPERATION:
+                return Fold(instruction);
+            default:
+                return {State::VARYING, {}};
+        }
+    }
+
+    Value Meet(const vector<Instruction*>& operands) {
+        Value result;
+        for (const auto* operand : operands) {
+            if (operand->opcode == Opcode::UNDEFINED) {
+                return {State::VARYING, {}};
+            }
+            const auto& value = values_[operand];
+            if (value.state == State::VARYING
+                || (value.state == State::CONSTANT && result.state == State::CONSTANT
+                    && !IsSame(value.constant, result.constant))) {
+                return {State::VARYING, {}};
+            }
+            if (value.state == State::CONSTANT) {
+                result = value;
+            }
+        }
+        return result;
+    }
+
+    Value Fold(const Instruction& instruction) {
+        const auto operand = [this, &instruction](size_t index) -> const Value& {
+            return values_[instruction.operands[index]];
+        };
+        // and and or do not need the right operand if the left one decides
+        if (instruction.operation == Operation::AND || instruction.operation == Operation::OR) {
+            const auto& lhs = operand(0);
+            if (lhs.state != State::CONSTANT) {
+                return {lhs.state, {}};
+            }
+            const bool is_or = instruction.operation == Operation::OR;
+            if (runtime::IsTrue(lhs.constant) == is_or) {
+                return {State::CONSTANT, runtime::MakeBool(is_or)};
+            }
+            const auto& rhs = operand(1);
+            if (rhs.state != State::CONSTANT) {
+                return {rhs.state, {}};
+            }
+            return {State::CONSTANT, runtime::MakeBool(runtime::IsTrue(rhs.constant))};
+        }
+
+        vector<runtime::ObjectHolder> operands;
+        for (size_t i = 0; i < instruction.operands.size(); ++i) {
+            const auto& value = operand(i);
+            if (value.state != State::CONSTANT) {
+                return {value.state, {}};
+            }
+            operands.push_back(value.constant);
+        }
+
+        // a constant expression which throws is left to throw when it is executed
+        runtime::ObjectHolder result;
+        try {
+            result = Calculate(instruction, operands);
+        } catch (const exception&) {
+            return {State::VARYING, {}};
+        }
+        switch (runtime::GetKind(result)) {
+            case runtime::ValueKind::BOOL:
+            case runtime::ValueKind::NUMBER:
+            case runtime::ValueKind::BIG_INT:
+            case runtime::ValueKind::FLOAT:
+            case runtime::ValueKind::STRING:
+                return {State::CONSTANT, std::move(result)};
+            default:
+                return {State::VARYING, {}};
+        }
+    }
+
+    runtime::ObjectHolder Calculate(const Instruction& instruction,
+                                    const vector<runtime::ObjectHolder>& operands) {
+        switch (instruction.operation) {
+            case Operation::ADD:
+                return AddObjects(operands[0], operands[1], context_);
+            case Operation::SUB:
+                return SubtractObjects(operands[0], operands[1], context_);
+            case Operation::MULT:
+                return MultiplyObjects(operands[0], operands[1], context_);
+            case Operation::DIV:
+                return DivideObjects(operands[0], operands[1], context_);
+            case Operation::COMPARE:
+                return CompareObjects(instruction.comparison, operands[0], operands[1], context_);
+            case Operation::NOT:
+                return runtime::MakeBool(!runtime::IsTrue(operands[0]));
+            case Operation::STR:
+                return StringValue(operands[0], context_);
+            default:
+                throw runtime_error("Unexpected operation"s);
+        }
+    }
+
+    unordered_map<const Instruction*, Value> values_;
+    ostringstream output_;
+    runtime::SimpleContext context_{output_};
+};
+
+// Replaces the reads of a variable assigned from another one (y = x) by the reads of that one,
+// where it still holds the same version
+class CopyPropagation : public Pass {
+public:
+    [[nodiscard]] string_view GetName() const override {
+        return "copyprop"sv;
+    }
+
+    size_t Run(Function& function) override {
+        size_t changes = 0;
+        for (const auto& instruction : function.instructions) {
+            if (instruction->opcode != Opcode::VARIABLE || instruction->slot == nullptr
+                || IsDetached(*instruction)) {
+                continue;
+            }
+            Instruction* const version = instruction->operands[0];
+            Instruction* source = version;
+            for (const Instruction* copy = version; copy->opcode == Opcode::COPY
+                 && copy->operands[0]->opcode == Opcode::VARIABLE;) {
+                Instruction* copied = copy->operands[0]->operands[0];
+                if (IsBound(*instruction->environment, copied)) {
+                    source = copied;
+                }
+                copy = copied;
+            }
+            if (source != version) {
+                instruction->operands[0] = source;
+                instruction->changed = true;
+                ++changes;
+            }
+        }
+        return changes;
+    }
+};
+
+/*
+ * Replaces a repeated read of the same fields of the same object (self.x) by the value read
+ * first, while it dominates the repeated one and nothing in between may assign a field.
+ * The value is taken from a variable assigned from the first read, or else the first read
+ * is moved into a temporary in front of its statement
+ */
+class LoadElimination : public Pass {
+public:
+    [[nodiscard]] string_view GetName() const override {
+        return "cse"sv;
+    }
+
+    size_t Run(Function& function) override {
+        const auto& instructions = function.instructions;
+        map<pair<const Instruction*, string>, Available> available;
+        // the keys added in each enclosing branch, removed when it ends
+        vector<vector<pair<const Instruction*, string>>> scopes(1);
+        uint64_t epoch = 0;
+        size_t changes = 0;
+
+        for (size_t i = 0; i < instructions.size(); ++i) {
+            auto& instruction = *instructions[i];
+            // the loads of an argument printed before are not available after it
+            if (i > 0 && instructions[i - 1]->printed) {
+                ++epoch;
+            }
+            switch (instruction.opcode) {
+                case Opcode::LOOP:
+                    // the loads before the loop are not available after a write going around it,
+                    // or after __iter__ and __next__ of a user iterator, which may assign fields
+                    if (WritesMemory(instruction) || RegionWritesMemory(instructions, i)) {
+                        ++epoch;
+                    }
+                    scopes.emplace_back();
+                    continue;
+                case Opcode::IF:
+                case Opcode::SCOPE:
+                    scopes.emplace_back();
+                    continue;
+                case Opcode::ELSE:
+                case Opcode::END:
+                    for (const auto& key : scopes.back()) {
+                        available.erase(key);
+                    }
+                    scopes.pop_back();
+                    if (instruction.opcode == Opcode::ELSE) {
+                        scopes.emplace_back();
+                    }
+                    continue;
+                default:
+                    break;
+            }
+            if (IsDetached(instruction)) {
+                continue;
+            }
+            if (WritesMemory(instruction)) {
+                ++epoch;
+                continue;
+            }
+            if (instruction.opcode != Opcode::LOAD) {
+                continue;
+            }
+            const Instruction* object = Root(instruction.operands[0]);
+            if (object->opcode == Opcode::UNDEFINED) {
+                continue;
+            }
+            string fields;
+            for (const auto& field : instruction.fields) {
+                fields += field + "."s;
+            }
+            auto key = make_pair(object, std::move(fields));
+            const auto it = available.find(key);
+            if (it != available.end() && it->second.epoch == epoch) {
+                if (Reuse(function, *it->second.load, instruction)) {
+                    ++changes;
+                }
+                continue;
+            }
+            available[key] = {&instruction, epoch};
+            scopes.back().push_back(std::move(key));
+        }
+        return changes;
+    }
+
+private:
+    struct Available {
+        Instruction* load;
+        uint64_t epoch;
+    };
+
+    // Returns true if an instruction between the marker and its END may assign a field
+    static bool RegionWritesMemory(const vector<unique_ptr<Instruction>>& instructions,
+                                   size_t marker) {
+        size_t depth = 0;
+        for (size_t i = marker + 1; i < instructions.size(); ++i) {
+            const auto& instruction = *instructions[i];
+            const auto opcode = instruction.opcode;
+            if (WritesMemory(instruction)) {
+                return true;
+            }
+            if (opcode == Opcode::IF || opcode == Opcode::LOOP || opcode == Opcode::SCOPE) {
+                ++depth;
+            } else if (opcode == Opcode::END) {
+                if (depth == 0) {
+                    return false;
+                }
+                --depth;
+            }
+        }
+        return false;
+    }
+
+    bool Reuse(const Function& function, Instruction& first, Instruction& load) {
+        // the variable with the least name, so the choice does not depend on the hashing
+        Instruction* holder = nullptr;
+        for (const auto& [name, version] : *load.environment) {
+            if (Root(version) == &first && IsDefined(version)
+                && (holder == nullptr || name < holder->name)) {
+                holder = version;
+            }
+        }
+        if (holder == nullptr) {
+            if (first.name.empty()) {
+                if (!first.hoistable || first.slot == nullptr
+                    || first.position.compound == nullptr || function.single_return) {
+                    return false;
+                }
+                first.name = "$"s + to_string(++temporaries_);
+            }
+            holder = &first;
+        }
+        load.opcode = Opcode::VARIABLE;
+        load.operands = {holder};
+        load.fields.clear();
+        load.changed = true;
+        return true;
+    }
+
+    size_t temporaries_ = 0;
+};
+
+/*
+ * Removes the code which is never executed or whose result is never used: the branch not
+ * taken by an if with a constant condition, the statements after a return and the assignments
+ * of constants or variables to the variables which are not read afterwards
+ */
+class DeadCodeElimination : public Pass {
+public:
+    [[nodiscard]] string_view GetName() const override {
+        return "dce"sv;
+    }
+
+    size_t Run(Function& function) override {
+        size_t changes = 0;
+        const auto& instructions = function.instructions;
+        for (const auto& instruction : instructions) {
+            if (IsDetached(*instruction)) {
+                continue;
+            }
+            if (instruction->opcode == Opcode::IF
+                && instruction->operands[0]->opcode == Opcode::CONSTANT && !instruction->taken) {
+                const bool taken = runtime::IsTrue(instruction->operands[0]->constant);
+                instruction->taken = taken;
+                const Instruction* else_marker = nullptr;
+                for (const auto& other : instructions) {
+                    if (other->opcode == Opcode::ELSE && other->user == instruction.get()) {
+                        else_marker = other.get();
+                    }
+                }
+                const Instruction* branch = taken ? else_marker : instruction.get();
+                for (const auto& other : instructions) {
+                    if (other->statement && other->user == branch) {
+                        other->removed = true;
+                    } else if (other->opcode == Opcode::PHI && other->user == instruction.get()) {
+                        // the join after the if keeps the version of the branch taken
+                        other->operands = {other->operands[taken ? 0 : 1]};
+                    }
+                }
+                ++changes;
+            } else if (instruction->opcode == Opcode::RETURN) {
+                for (const auto& other : instructions) {
+                    if (other->statement && !other->removed
+                        && other->position.compound == instruction->position.compound
+                        && other->position.index > instruction->position.index) {
+                        other->removed = true;
+                        ++changes;
+                    }
+                }
+            }
+        }
+
+        bool removed = true;
+        while (removed) {
+            removed = false;
+            const auto live = LiveVersions(function);
+            for (const auto& instruction : instructions) {
+                if (instruction->opcode == Opcode::COPY && live.count(instruction.get()) == 0
+                    && !IsDetached(*instruction) && IsRemovable(*instruction->operands[0])) {
+                    instruction->removed = true;
+                    removed = true;
+                    ++changes;
+                }
+            }
+        }
+        return changes;
+    }
+
+private:
+    // Returns the versions which are read, directly or through the joins
+    static unordered_set<const Instruction*> LiveVersions(const Function& function) {
+        unordered_set<const Instruction*> live;
+        vector<const Instruction*> joins;
+        const auto mark = [&live, &joins](const Instruction* version) {
+            if (live.insert(version).second && version->opcode == Opcode::PHI) {
+                joins.push_back(version);
+            }
+        };
+        for (const auto& instruction : function.instructions) {
+            if ((instruction->opcode == Opcode::VARIABLE || instruction->opcode == Opcode::LOAD)
+                && !IsDetached(*instruction)) {
+                mark(instruction->operands[0]);
+            }
+        }
+        while (!joins.empty()) {
+            const auto* join = joins.back();
+            joins.pop_back();
+            for (const auto* operand : join->operands) {
+                mark(operand);
+            }
+        }
+        return live;
+    }
+
+    // Returns true if calculating the value has no effect and can't throw
+    static bool IsRemovable(const Instruction& value) {
+        return value.opcode == Opcode::CONSTANT
+            || (value.opcode == Opcode::VARIABLE && IsDefined(value.operands[0]));
+    }
+};
+
+}  // namespace
+
+void PassManager::AddPass(unique_ptr<Pass> pass) {
+    passes_.push_back(std::move(pass));
+}
+
+void PassManager::Run(vector<Function>& functions) {
+    // the index of the counter of every pass in ir_stats
+    vector<size_t> stats;
+    auto& passes = ir_stats.passes;
+    for (const auto& pass : passes_) {
+        const auto it = find_if(passes.begin(), passes.end(), [&pass](const auto& pass_stats) {
+            return pass_stats.name == pass->GetName();
+        });
+        stats.push_back(it - passes.begin());
+        if (it == passes.end()) {
+            passes.push_back({string(pass->GetName()), 0});
+        }
+    }
+
+    for (auto& function : functions) {
+        if (function.opaque) {
+            continue;
+        }
+        // a pass may enable the earlier ones: a branch removed makes a variable constant
+        bool changed = true;
+        for (size_t round = 0; changed && round < MAX_ROUNDS; ++round) {
+            changed = false;
+            for (size_t i = 0; i < passes_.size(); ++i) {
+                const size_t changes = passes_[i]->Run(function);
+                passes[stats[i]].changes += changes;
+                changed = changed || changes != 0;
+            }
+        }
+    }
+}
+
+unique_ptr<Pass> MakePass(string_view name) {
+    if (name == "constprop"sv) {
+        return make_unique<ConstantPropagation>();
+    }
+    if (name == "copyprop"sv) {
+        return make_unique<CopyPropagation>();
+    }
+    if (name == "cse"sv) {
+        return make_unique<LoadElimination>();
+    }
+    if (name == "dce"sv) {
+        return make_unique<DeadCodeElimination>();
+    }
+    throw runtime_error("Unknown IR pass "s + string(name));
+}
+
+vector<string> StandardPipeline() {
+    return {"constprop"s, "copyprop"s, "cse"s, "dce"s};
+}
+
+}  // namespace ir
+
+using ir::Instruction;
+using ir::Opcode;
+
+class IrTranslator {
+public:
+    vector<ir::Function> Build(Statement& program) {
+        vector<ir::Function> functions;
+        if (auto* compound = dynamic_cast<Compound*>(&program)) {
+            BuildFunction(functions.emplace_back(), *compound, {});
+        }
+        // the class definitions add their methods while the functions are built
+        for (size_t i = 0; i < methods_.size(); ++i) {
+            const auto [name, method] = methods_[i];
+            auto& function = functions.emplace_back();
+            function.name = name;
+            auto* body = dynamic_cast<MethodBody*>(method->body.get());
+            auto* compound = body ? dynamic_cast<Compound*>(body->body_.get()) : nullptr;
+            if (compound == nullptr) {
+                function.opaque = true;
+                continue;
+            }
+            function.single_return = compound->args_.size() == 1
+                && dynamic_cast<Return*>(compound->args_[0].get()) != nullptr;
+            vector<string> parameters{"self"s};
+            parameters.insert(parameters.end(), method->formal_params.begin(),
+                              method->formal_params.end());
+            BuildFunction(function, *compound, parameters);
+        }
+        return functions;
+    }
+
+    void Lower(vector<ir::Function>& functions) {
+        for (auto& function : functions) {
+            if (function.opaque) {
+                continue;
+            }
+            for (const auto& instruction : function.instructions) {
+                Lower(*instruction);
+            }
+        }
+
+        // the inner compound instructions first, as the outer ones may take their statements
+        vector<pair<Compound*, Edits*>> compounds;
+        for (auto& [compound, edits] : edits_) {
+            compounds.emplace_back(compound, &edits);
+        }
+        sort(compounds.begin(), compounds.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second->depth > rhs.second->depth;
+        });
+        for (const auto& [compound, edits] : compounds) {
+            Apply(*compound, *edits);
+        }
+    }
+
+private:
+    // The changes of the statements of a compound instruction, made once all nodes are lowered
+    struct Edit {
+        // The assignments of the hoisted loads, placed in front of the statement
+        vector<unique_ptr<Statement>> before;
+        bool remove = false;
+        // The if is replaced by the branch taken, if there is one
+        bool replace = false;
+        unique_ptr<Statement> replacement;
+    };
+
+    struct Edits {
+        size_t depth = 0;
+        map<size_t, Edit> statements;
+    };
+
+    void BuildFunction(ir::Function& function, Compound& body, const vector<string>& parameters) {
+        function_ = &function;
+        environment_ = make_shared<ir::Environment>();
+        region_ = nullptr;
+        depth_ = 0;
+        undefined_ = Append(Opcode::UNDEFINED);
+        for (const auto& name : parameters) {
+            auto* parameter = Append(Opcode::PARAMETER);
+            parameter->name = name;
+            Define(name, parameter);
+        }
+        BuildCompound(body);
+        ir_stats.instructions += function.instructions.size();
+        ++ir_stats.functions;
+    }
+
+    Instruction* Append(Opcode opcode, vector<Instruction*> operands = {}) {
+        auto& instruction = function_->instructions.emplace_back(make_unique<Instruction>());
+        instruction->opcode = opcode;
+        instruction->operands = std::move(operands);
+        instruction->position = position_;
+        return instruction.get();
+    }
+
+    // Adds the instruction with the expressions as operands
+    Instruction* AppendUser(Opcode opcode, Statement& node, vector<Instruction*> operands) {
+        auto* instruction = Append(opcode, std::move(operands));
+        instruction->node = &node;
+        for (auto* operand : instruction->operands) {
+            operand->user = instruction;
+        }
+        return instruction;
+    }
+
+    Instruction* Lookup(const string& name) const {
+        const auto it = environment_->find(name);
+        return it == environment_->end() ? undefined_ : it->second;
+    }
+
+    void Define(const string& name, Instruction* version) {
+        // the environment is shared with the instructions which have seen it
+        if (environment_.use_count() > 1) {
+            environment_ = make_shared<ir::Environment>(*environment_);
+        }
+        (*environment_)[name] = version;
+    }
+
+    void BuildCompound(Compound& compound) {
+        ++depth_;
+        for (size_t i = 0; i < compound.args_.size(); ++i) {
+            position_ = {&compound, i, depth_};
+            effects_ = false;
+            Instruction* region = region_;
+            auto* instruction = BuildStatement(compound.args_[i], compound);
+            instruction->statement = true;
+            instruction->user = region;
+            region_ = region;
+        }
+        --depth_;
+    }
+
+    // Builds a branch or a loop body, which the parser makes a compound instruction
+    void BuildBody(Statement& body, Instruction* region) {
+        const auto position = position_;
+        region_ = region;
+        if (auto* compound = dynamic_cast<Compound*>(&body)) {
+            BuildCompound(*compound);
+        } else {
+            function_->opaque = true;
+        }
+        position_ = position;
+    }
+
+    Instruction* BuildStatement(unique_ptr<Statement>& slot, Statement& parent) {
+        Statement& node = *slot;
+        Instruction* instruction = nullptr;
+        if (auto* assignment = dynamic_cast<Assignment*>(&node)) {
+            instruction = AppendUser(Opcode::COPY, node, {Expression(assignment->rv_, node)});
+            instruction->name = assignment->var_;
+            Define(assignment->var_, instruction);
+        } else if (auto* field_assignment = dynamic_cast<FieldAssignment*>(&node)) {
+            auto* object = Expression(field_assignment->object_);
+            auto* value = Expression(field_assignment->rv_, node);
+            instruction = AppendUser(Opcode::STORE, node, {object, value});
+        } else if (auto* print = dynamic_cast<Print*>(&node)) {
+            // every argument is printed before the next one is evaluated
+            vector<Instruction*> args;
+            for (auto& arg : print->args_) {
+                if (!args.empty()) {
+                    args.back()->printed = true;
+                }
+                args.push_back(Expression(arg, node));
+                effects_ = true;
+            }
+            instruction = AppendUser(Opcode::PRINT, node, std::move(args));
+        } else if (auto* return_statement = dynamic_cast<Return*>(&node)) {
+            instruction = AppendUser(Opcode::RETURN, node,
+                                  {Expression(return_statement->statement_, node)});
+        } else if (auto* definition = dynamic_cast<ClassDefinition*>(&node)) {
+            const auto& cls = *definition->cls_.TryAs<runtime::Class>();
+            for (const auto& method : cls.GetMethods()) {
+                methods_.emplace_back(cls.GetName() + "."s + method.name, &method);
+            }
+            instruction = AppendUser(Opcode::PARAMETER, node, {});
+            instruction->name = cls.GetName();
+            Define(cls.GetName(), instruction);
+        } else if (auto* if_else = dynamic_cast<IfElse*>(&node)) {
+            instruction = BuildIfElse(*if_else);
+        } else if (auto* for_in = dynamic_cast<ForIn*>(&node)) {
+            instruction = BuildForIn(*for_in);
+        } else {
+            return Expression(slot, parent);
+        }
+        instruction->slot = &slot;
+        instruction->parent = &parent;
+        return instruction;
+    }
+
+    Instruction* BuildIfElse(IfElse& node) {
+        auto* marker = AppendUser(Opcode::IF, node, {Expression(node.condition_, node)});
+        const auto before = environment_;
+        BuildBody(*node.if_body_, marker);
+        const auto after_if = environment_;
+        auto* else_marker = Append(Opcode::ELSE);
+        else_marker->user = marker;
+        environment_ = before;
+        if (node.else_body_) {
+            BuildBody(*node.else_body_, else_marker);
+        }
+        Append(Opcode::END);
+
+        // the variables assigned differently in the branches are joined in a sorted order
+        set<string> names;
+        for (const auto* environment : {after_if.get(), environment_.get()}) {
+            for (const auto& [name, version] : *environment) {
+                names.insert(name);
+            }
+        }
+        const auto version_in = [this](const ir::Environment& environment, const string& name) {
+            const auto it = environment.find(name);
+            return it == environment.end() ? undefined_ : it->second;
+        };
+        const auto after_else = environment_;
+        for (const auto& name : names) {
+            auto* if_version = version_in(*after_if, name);
+            auto* else_version = version_in(*after_else, name);
+            if (if_version != else_version) {
+                auto* phi = Append(Opcode::PHI, {if_version, else_version});
+                phi->name = name;
+                phi->user = marker;
+                Define(name, phi);
+            }
+        }
+        return marker;
+    }
+
+    Instruction* BuildForIn(ForIn& node) {
+        auto* marker = AppendUser(Opcode::LOOP, node, {Expression(node.iterable_, node)});
+        set<string> assigned{node.var_};
+        AssignedVariables(*node.body_, assigned);
+        // the variables assigned in the body come to its beginning from before the loop
+        // and from the end of the previous iteration
+        vector<Instruction*> joins;
+        for (const auto& name : assigned) {
+            auto* phi = Append(Opcode::PHI, {Lookup(name)});
+            phi->name = name;
+            phi->user = marker;
+            joins.push_back(phi);
+            Define(name, phi);
+        }
+        auto* item = Append(Opcode::PARAMETER);
+        item->name = node.var_;
+        item->user = marker;
+        Define(node.var_, item);
+        BuildBody(*node.body_, marker);
+        Append(Opcode::END);
+        for (auto* phi : joins) {
+            phi->operands.push_back(Lookup(phi->name));
+            Define(phi->name, phi);
+        }
+        return marker;
+    }
+
+    static void AssignedVariables(const Statement& statement, set<string>& names) {
+        if (const auto* compound = dynamic_cast<const Compound*>(&statement)) {
+            for (const auto& arg : compound->args_) {
+                AssignedVariables(*arg, names);
+            }
+        } else if (const auto* assignment = dynamic_cast<const Assignment*>(&statement)) {
+            names.insert(assignment->var_);
+        } else if (const auto* if_else = dynamic_cast<const IfElse*>(&statement)) {
+            AssignedVariables(*if_else->if_body_, names);
+            if (if_else->else_body_) {
+                AssignedVariables(*if_else->else_body_, names);
+            }
+        } else if (const auto* for_in = dynamic_cast<const ForIn*>(&statement)) {
+            names.insert(for_in->var_);
+            AssignedVariables(*for_in->body_, names);
+        }
+    }
+
+    vector<Instruction*> Expressions(vector<unique_ptr<Statement>>& slots, Statement& parent) {
+        vector<Instruction*> instructions;
+        for (auto& slot : slots) {
+            instructions.push_back(Expression(slot, parent));
+        }
+        return instructions;
+    }
+
+    Instruction* Expression(unique_ptr<Statement>& slot, Statement& parent) {
+        auto* instruction = Expression(*slot);
+        instruction->slot = &slot;
+        instruction->parent = &parent;
+        return instruction;
+    }
+
+    Instruction* Expression(Statement& node) {
+        if (dynamic_cast<NumericConst*>(&node) || dynamic_cast<StringConst*>(&node)
+            || dynamic_cast<BoolConst*>(&node) || dynamic_cast<FloatConst*>(&node)
+            || dynamic_cast<BigIntConst*>(&node) || dynamic_cast<None*>(&node)) {
+            auto* instruction = AppendUser(Opcode::CONSTANT, node, {});
+            instruction->constant = node.Execute(closure_, context_);
+            return instruction;
+        }
+        if (auto* variable = dynamic_cast<VariableValue*>(&node)) {
+            auto* version = Lookup(variable->var_name_);
+            auto* instruction = AppendUser(variable->fields_.empty() ? Opcode::VARIABLE : Opcode::LOAD,
+                                        node, {});
+            instruction->operands.push_back(version);
+            instruction->fields = variable->fields_;
+            instruction->environment = environment_;
+            instruction->hoistable = !effects_;
+            effects_ = effects_ || !variable->fields_.empty() || !ir::IsDefined(version);
+            return instruction;
+        }
+        if (auto* stringify = dynamic_cast<Stringify*>(&node)) {
+            return Operation(node, ir::Operation::STR, {Expression(stringify->argument_, node)});
+        }
+        if (auto* negation = dynamic_cast<Not*>(&node)) {
+            return Operation(node, ir::Operation::NOT, {Expression(negation->argument_, node)});
+        }
+        if (dynamic_cast<Or*>(&node) || dynamic_cast<And*>(&node)) {
+            auto& operation = static_cast<BinaryOperation&>(node);
+            auto* lhs = Expression(operation.lhs_, node);
+            // the right operand is executed only if the left one does not decide
+            Append(Opcode::SCOPE);
+            effects_ = true;
+            auto* rhs = Expression(operation.rhs_, node);
+            Append(Opcode::END);
+            return Operation(node, dynamic_cast<Or*>(&node) ? ir::Operation::OR
+                                                            : ir::Operation::AND, {lhs, rhs});
+        }
+        if (auto* comparison = dynamic_cast<Comparison*>(&node)) {
+            auto* instruction = Operation(node, ir::Operation::COMPARE,
+                                          Operands(*comparison));
+            instruction->comparison = comparison->operation_;
+            return instruction;
+        }
+        if (dynamic_cast<Add*>(&node)) {
+            return Operation(node, ir::Operation::ADD, Operands(node));
+        }
+        if (dynamic_cast<Sub*>(&node)) {
+            return Operation(node, ir::Operation::SUB, Operands(node));
+        }
+        if (dynamic_cast<Mult*>(&node)) {
+            return Operation(node, ir::Operation::MULT, Operands(node));
+        }
+        if (dynamic_cast<Div*>(&node)) {
+            return Operation(node, ir::Operation::DIV, Operands(node));
+        }
+
+        Instruction* instruction = nullptr;
+        if (auto* call = dynamic_cast<MethodCall*>(&node)) {
+            vector<Instruction*> operands{Expression(call->object_, node)};
+            const auto args = Expressions(call->args_, node);
+            operands.insert(operands.end(), args.begin(), args.end());
+            instruction = AppendUser(Opcode::CALL, node, std::move(operands));
+            instruction->writes_memory = true;
+        } else if (auto* new_instance = dynamic_cast<NewInstance*>(&node)) {
+            instruction = AppendUser(Opcode::CALL, node, Expressions(new_instance->args_, node));
+            instruction->writes_memory = true;
+        } else if (dynamic_cast<NewDict*>(&node)) {
+            instruction = AppendUser(Opcode::CALL, node, {});
+        } else if (auto* range = dynamic_cast<NewRange*>(&node)) {
+            instruction = AppendUser(Opcode::CALL, node, {Expression(range->start_, node),
+                                                       Expression(range->stop_, node)});
+        } else if (auto* join = dynamic_cast<Join*>(&node)) {
+            instruction = AppendUser(Opcode::CALL, node, {Expression(join->separator_, node),
+                                                       Expression(join->iterable_, node)});
+            instruction->writes_memory = true;
+        } else {
+            function_->opaque = true;
+            instruction = AppendUser(Opcode::CALL, node, {});
+            instruction->writes_memory = true;
+        }
+        effects_ = true;
+        return instruction;
+    }
+
+    vector<Instruction*> Operands(Statement& node) {
+        auto& operation = static_cast<BinaryOperation&>(node);
+        auto* lhs = Expression(operation.lhs_, node);
+        return {lhs, Expression(operation.rhs_, node)};
+    }
+
+    Instruction* Operation(Statement& node, ir::Operation operation,
+                           vector<Instruction*> operands) {
+        auto* instruction = AppendUser(Opcode::OPERATION, node, std::move(operands));
+        instruction->operation = operation;
+        // an operator may call a special method of an instance or throw
+        effects_ = effects_ || operation != ir::Operation::NOT;
+        return instruction;
+    }
+
+    static unique_ptr<Statement> MakeConstant(const runtime::ObjectHolder& value) {
+        if (const auto* number = value.TryAs<runtime::Number>()) {
+            return make_unique<NumericConst>(runtime::Number(number->GetValue()));
+        }
+        if (const auto* string = value.TryAs<runtime::String>()) {
+            return make_unique<StringConst>(runtime::String(string->GetValue()));
+        }
+        if (const auto* boolean = value.TryAs<runtime::Bool>()) {
+            return make_unique<BoolConst>(runtime::Bool(boolean->GetValue()));
+        }
+        if (const auto* number = value.TryAs<runtime::Float>()) {
+            return make_unique<FloatConst>(runtime::Float(number->GetValue()));
+        }
+        if (const auto* number = value.TryAs<runtime::BigInt>()) {
+            return make_unique<BigIntConst>(runtime::BigInt(number->GetValue()));
+        }
+        return make_unique<None>();
+    }
+
+    // The operands which are operators are found when the node is constructed
+    static void RefreshOperands(Statement* parent) {
+        if (auto* binary = dynamic_cast<BinaryOperation*>(parent)) {
+            binary->lhs_operator_ = dynamic_cast<Operator*>(binary->lhs_.get());
+            binary->rhs_operator_ = dynamic_cast<Operator*>(binary->rhs_.get());
+        } else if (auto* unary = dynamic_cast<UnaryOperation*>(parent)) {
+            unary->argument_operator_ = dynamic_cast<Operator*>(unary->argument_.get());
+        } else if (auto* return_statement = dynamic_cast<Return*>(parent)) {
+            return_statement->tail_call_
+                = dynamic_cast<MethodCall*>(return_statement->statement_.get());
+        }
+    }
+
+    Edit& EditAt(const ir::Position& position) {
+        auto& edits = edits_[position.compound];
+        edits.depth = position.depth;
+        return edits.statements[position.index];
+    }
+
+    void Lower(Instruction& instruction) {
+        if (instruction.statement && instruction.removed && instruction.position.compound) {
+            EditAt(instruction.position).remove = true;
+            return;
+        }
+        if (ir::IsDetached(instruction) || instruction.slot == nullptr) {
+            return;
+        }
+        if (instruction.changed) {
+            // the constants of the instructions lowered later may be values of the node
+            replaced_.push_back(std::move(*instruction.slot));
+            if (instruction.opcode == Opcode::CONSTANT) {
+                *instruction.slot = MakeConstant(instruction.constant);
+            } else {
+                *instruction.slot = make_unique<VariableValue>(instruction.operands[0]->name);
+            }
+            RefreshOperands(instruction.parent);
+        }
+        if (instruction.opcode == Opcode::LOAD && !instruction.name.empty()) {
+            auto load = std::move(*instruction.slot);
+            *instruction.slot = make_unique<VariableValue>(instruction.name);
+            RefreshOperands(instruction.parent);
+            EditAt(instruction.position)
+                .before.push_back(make_unique<Assignment>(instruction.name, std::move(load)));
+        }
+        if (instruction.taken && instruction.position.compound) {
+            auto& if_else = static_cast<IfElse&>(*instruction.node);
+            auto& edit = EditAt(instruction.position);
+            edit.replace = true;
+            edit.replacement = std::move(*instruction.taken ? if_else.if_body_
+                                                            : if_else.else_body_);
+        }
+    }
+
+    static void Apply(Compound& compound, Edits& edits) {
+        vector<unique_ptr<Statement>> args;
+        for (size_t i = 0; i < compound.args_.size(); ++i) {
+            const auto it = edits.statements.find(i);
+            if (it == edits.statements.end()) {
+                args.push_back(std::move(compound.args_[i]));
+                continue;
+            }
+            auto& edit = it->second;
+            for (auto& statement : edit.before) {
+                args.push_back(std::move(statement));
+            }
+            if (edit.remove) {
+                continue;
+            }
+            if (!edit.replace) {
+                args.push_back(std::move(compound.args_[i]));
+            } else if (auto* branch = dynamic_cast<Compound*>(edit.replacement.get())) {
+                for (auto& statement : branch->args_) {
+                    args.push_back(std::move(statement));
+                }
+            } else if (edit.replacement) {
+                args.push_back(std::move(edit.replacement));
+            }
+        }
+        compound.args_ = std::move(args);
+    }
+
+    ir::Function* function_ = nullptr;
+    shared_ptr<ir::Environment> environment_;
+    ir::Position position_;
+    // The marker of the branch or loop holding the statements being built
+    Instruction* region_ = nullptr;
+    Instruction* undefined_ = nullptr;
+    size_t depth_ = 0;
+    // Something observable has happened in the statement being built
+    bool effects_ = false;
+    vector<pair<string, const runtime::Method*>> methods_;
+    unordered_map<Compound*, Edits> edits_;
+    // The nodes replaced by the lowering, kept while the IR refers to their values
+    vector<unique_ptr<Statement>> replaced_;
+
+    runtime::Closure closure_;
+    ostringstream output_;
+    runtime::SimpleContext context_{output_};
+};
+
+void OptimizeProgram(Statement& program, const vector<string>& passes) {
+    if (passes.empty()) {
+        return;
+    }
+    ir::PassManager manager;
+    for (const auto& name : passes) {
+        manager.AddPass(ir::MakePass(name));
+    }
+    // the values computed ahead are not allocations of the program
+    const size_t allocated = runtime::allocation_stats.allocated;
+    IrTranslator translator;
+    auto functions = translator.Build(program);
+    manager.Run(functions);
+    translator.Lower(functions);
+    runtime::allocation_stats.allocated = allocated;
+}
+
+}  // namespace ast
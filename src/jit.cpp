@@ -0,0 +1,1086 @@
+#include "jit.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define MYTHON_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace ast {
+
+using runtime::Closure;
+using runtime::Context;
+using runtime::ObjectHolder;
+
+#ifdef MYTHON_JIT
+
+namespace {
+
+enum Register : uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// The conditions of the jumps as encoded in jcc. A condition and its negation differ
+// in the lowest bit
+enum class Condition : uint8_t {
+    IF_OVERFLOW = 0x0,
+    IF_EQUAL = 0x4,
+    IF_NOT_EQUAL = 0x5,
+    IF_LESS = 0xC,
+    IF_GREATER_OR_EQUAL = 0xD,
+    IF_LESS_OR_EQUAL = 0xE,
+    IF_GREATER = 0xF,
+};
+
+Condition Negate(Condition condition) {
+    return static_cast<Condition>(static_cast<uint8_t>(condition) ^ 1U);
+}
+
+Condition ConditionOf(runtime::CompareOperation operation) {
+    switch (operation) {
+        case runtime::CompareOperation::EQUAL:
+            return Condition::IF_EQUAL;
+        case runtime::CompareOperation::NOT_EQUAL:
+            return Condition::IF_NOT_EQUAL;
+        case runtime::CompareOperation::LESS:
+            return Condition::IF_LESS;
+        case runtime::CompareOperation::GREATER:
+            return Condition::IF_GREATER;
+        case runtime::CompareOperation::LESS_OR_EQUAL:
+            return Condition::IF_LESS_OR_EQUAL;
+        case runtime::CompareOperation::GREATER_OR_EQUAL:
+            return Condition::IF_GREATER_OR_EQUAL;
+    }
+    return Condition::IF_EQUAL;
+}
+
+// A place in the code. The jumps to it made before it is bound are patched by Bind
+struct Label {
+    static constexpr size_t UNBOUND = numeric_limits<size_t>::max();
+
+    size_t position = UNBOUND;
+    vector<size_t> jumps;
+};
+
+// Writes the instructions of x86-64. The memory operands are [base + disp32]
+class Assembler {
+public:
+    void Push(Register r) {
+        Extend(r);
+        Byte(0x50 + (r & 7));
+    }
+    void Pop(Register r) {
+        Extend(r);
+        Byte(0x58 + (r & 7));
+    }
+    void Return() {
+        Byte(0xC3);
+    }
+    // mov dst, value
+    void MoveImmediate(Register dst, uint64_t value) {
+        Rex(RAX, dst);
+        Byte(0xB8 + (dst & 7));
+        Immediate(value, 8);
+    }
+    // mov dst, src
+    void Move(Register dst, Register src) {
+        Rex(src, dst);
+        Byte(0x89);
+        Byte(0xC0 | (src & 7) << 3 | (dst & 7));
+    }
+    // mov dst, [base + offset]
+    void Load(Register dst, Register base, int32_t offset) {
+        Memory({0x8B}, dst, base, offset);
+    }
+    // lea dst, [base + offset]
+    void LoadAddress(Register dst, Register base, int32_t offset) {
+        Memory({0x8D}, dst, base, offset);
+    }
+    // add, sub and imul dst, [base + offset]
+    void AddMemory(Register dst, Register base, int32_t offset) {
+        Memory({0x03}, dst, base, offset);
+    }
+    void SubtractMemory(Register dst, Register base, int32_t offset) {
+        Memory({0x2B}, dst, base, offset);
+    }
+    void MultiplyMemory(Register dst, Register base, int32_t offset) {
+        Memory({0x0F, 0xAF}, dst, base, offset);
+    }
+    // cmp lhs, [base + offset]
+    void CompareMemory(Register lhs, Register base, int32_t offset) {
+        Memory({0x3B}, lhs, base, offset);
+    }
+    // cmp lhs, rhs
+    void Compare(Register lhs, Register rhs) {
+        Rex(rhs, lhs);
+        Byte(0x39);
+        Byte(0xC0 | (rhs & 7) << 3 | (lhs & 7));
+    }
+    // test r, r
+    void Test(Register r) {
+        Rex(r, r);
+        Byte(0x85);
+        Byte(0xC0 | (r & 7) << 3 | (r & 7));
+    }
+    // cmp eax, value
+    void CompareStatus(int8_t value) {
+        Byte(0x83);
+        Byte(0xF8);
+        Byte(static_cast<uint8_t>(value));
+    }
+    // mov eax, value
+    void SetStatus(int32_t value) {
+        Byte(0xB8);
+        Immediate(static_cast<uint32_t>(value), 4);
+    }
+    // call r
+    void Call(Register r) {
+        Extend(r);
+        Byte(0xFF);
+        Byte(0xD0 | (r & 7));
+    }
+    void Jump(Label& label) {
+        Byte(0xE9);
+        Target(label);
+    }
+    void JumpIf(Condition condition, Label& label) {
+        Byte(0x0F);
+        Byte(0x80 | static_cast<uint8_t>(condition));
+        Target(label);
+    }
+    void Bind(Label& label) {
+        label.position = code_.size();
+        for (size_t jump : label.jumps) {
+            Patch(jump, label.position);
+        }
+        label.jumps.clear();
+    }
+
+    [[nodiscard]] const vector<uint8_t>& GetCode() const {
+        return code_;
+    }
+
+private:
+    void Byte(unsigned value) {
+        code_.push_back(static_cast<uint8_t>(value));
+    }
+    void Immediate(uint64_t value, int size) {
+        for (int i = 0; i < size; ++i) {
+            Byte(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    // REX.B of the 32-bit instructions on r8-r15
+    void Extend(Register r) {
+        if (r >= R8) {
+            Byte(0x41);
+        }
+    }
+    // REX.W with the high bits of the reg and rm fields
+    void Rex(Register reg, Register rm) {
+        Byte(0x48 | (reg >> 3) << 2 | (rm >> 3));
+    }
+    void Memory(initializer_list<uint8_t> opcode, Register reg, Register base, int32_t offset) {
+        Rex(reg, base);
+        for (uint8_t byte : opcode) {
+            Byte(byte);
+        }
+        Byte(0x80 | (reg & 7) << 3 | (base & 7));
+        // rsp and r12 as the base need the SIB byte
+        if ((base & 7) == RSP) {
+            Byte(0x24);
+        }
+        Immediate(static_cast<uint32_t>(offset), 4);
+    }
+    void Target(Label& label) {
+        const size_t at = code_.size();
+        Immediate(0, 4);
+        if (label.position == Label::UNBOUND) {
+            label.jumps.push_back(at);
+        } else {
+            Patch(at, label.position);
+        }
+    }
+    void Patch(size_t at, size_t target) {
+        const auto distance =
+            static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(at + 4));
+        memcpy(&code_[at], &distance, sizeof(distance));
+    }
+
+    vector<uint8_t> code_;
+};
+
+// The layout of the objects the code reads inline: a holder starts with the pointer
+// to its object and a Number with its virtual table. It is checked once on live objects,
+// and the JIT is off if the compiler has laid them out otherwise
+struct Layout {
+    bool valid = false;
+    const void* number_table = nullptr;
+    int32_t number_value = 0;
+};
+
+const Layout& GetLayout() {
+    static const Layout layout = [] {
+        Layout result;
+        const ObjectHolder small = runtime::MakeNumber(1);
+        const ObjectHolder large = runtime::MakeNumber(numeric_limits<int64_t>::max());
+        for (const ObjectHolder* holder : {&small, &large}) {
+            const runtime::Object* stored = nullptr;
+            memcpy(&stored, static_cast<const void*>(holder), sizeof(stored));
+            if (stored == nullptr || stored != holder->Get()) {
+                return result;
+            }
+        }
+        const void* small_table = nullptr;
+        const void* large_table = nullptr;
+        memcpy(&small_table, static_cast<const void*>(small.Get()), sizeof(small_table));
+        memcpy(&large_table, static_cast<const void*>(large.Get()), sizeof(large_table));
+        const auto& number = static_cast<const runtime::Number&>(*large.Get());
+        const auto value = reinterpret_cast<const char*>(&number.GetValue())
+                           - reinterpret_cast<const char*>(&number);
+        if (small_table != large_table || value < static_cast<ptrdiff_t>(sizeof(void*))
+            || value + sizeof(int64_t) > sizeof(runtime::Number)) {
+            return result;
+        }
+        result.valid = true;
+        result.number_table = small_table;
+        result.number_value = static_cast<int32_t>(value);
+        return result;
+    }();
+    return layout;
+}
+
+constexpr int64_t FAILED = -1;
+constexpr int64_t RESTART = 1;
+
+class NativeCode;
+
+// The state of a call of the compiled code, passed to every helper
+struct NativeFrame {
+    Context& context;
+    const NativeCode& code;
+    ObjectHolder* variables;
+    ObjectHolder result;
+    // The exception thrown by a helper, rethrown once the code has returned FAILED
+    exception_ptr error;
+};
+
+// The slots of a call, on the stack unless there are many of them
+class FrameSlots {
+public:
+    static constexpr size_t INLINE = 16;
+
+    explicit FrameSlots(size_t count) {
+        if (count > INLINE) {
+            heap_ = make_unique<ObjectHolder[]>(count);
+            data_ = heap_.get();
+        } else {
+            data_ = reinterpret_cast<ObjectHolder*>(storage_);
+            uninitialized_value_construct_n(data_, count);
+            count_ = count;
+        }
+    }
+    FrameSlots(const FrameSlots&) = delete;
+    FrameSlots& operator=(const FrameSlots&) = delete;
+    ~FrameSlots() {
+        destroy_n(data_, count_);
+    }
+
+    [[nodiscard]] ObjectHolder* Data() const {
+        return data_;
+    }
+
+private:
+    alignas(ObjectHolder) unsigned char storage_[INLINE * sizeof(ObjectHolder)];
+    unique_ptr<ObjectHolder[]> heap_;
+    ObjectHolder* data_ = nullptr;
+    // The number of the holders constructed in storage_
+    size_t count_ = 0;
+};
+
+// The machine code of a method body, with the names of its variables and the constants it uses
+class NativeCode {
+public:
+    // The code sets eax alone, so the status is 32-bit
+    using Entry = int32_t (*)(NativeFrame* frame, ObjectHolder* variables,
+                              const ObjectHolder* constants, ObjectHolder* temporaries);
+
+    NativeCode(const MethodBody& method, void* memory, size_t size, vector<string> variables,
+               vector<ObjectHolder> constants, size_t temporaries)
+        : method_{method}
+        , memory_{memory}
+        , size_{size}
+        , variables_{std::move(variables)}
+        , constants_{std::move(constants)}
+        , temporaries_{temporaries} {
+    }
+    NativeCode(const NativeCode&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+    ~NativeCode() {
+        munmap(memory_, size_);
+    }
+
+    ObjectHolder Run(Closure& closure, Context& context) const {
+        FrameSlots slots(variables_.size() + temporaries_);
+        ObjectHolder* variables = slots.Data();
+        for (size_t i = 0; i < variables_.size(); ++i) {
+            const auto it = closure.find(variables_[i]);
+            variables[i] = it != closure.end() ? it->second : runtime::Unbound();
+        }
+        NativeFrame frame{context, *this, variables, {}, {}};
+        const auto entry = reinterpret_cast<Entry>(memory_);
+        if (entry(&frame, variables, constants_.data(), variables + variables_.size()) == FAILED) {
+            rethrow_exception(frame.error);
+        }
+        return std::move(frame.result);
+    }
+
+    // Rebinds the variables as if the recursive call had got a fresh frame
+    // (see MethodBody::Execute). block holds self and the arguments
+    void Rebind(ObjectHolder* variables, ObjectHolder* block,
+                const vector<string>& formal_params) const {
+        for (size_t i = 0; i < variables_.size(); ++i) {
+            variables[i] = runtime::Unbound();
+        }
+        Bind(variables, "self"s, std::move(block[0]));
+        for (size_t i = 0; i < formal_params.size(); ++i) {
+            Bind(variables, formal_params[i], std::move(block[i + 1]));
+        }
+    }
+
+    [[nodiscard]] const MethodBody& GetMethod() const {
+        return method_;
+    }
+
+private:
+    void Bind(ObjectHolder* variables, const string& name, ObjectHolder value) const {
+        for (size_t i = 0; i < variables_.size(); ++i) {
+            if (variables_[i] == name) {
+                variables[i] = std::move(value);
+                return;
+            }
+        }
+    }
+
+    const MethodBody& method_;
+    void* memory_;
+    size_t size_;
+    vector<string> variables_;
+    vector<ObjectHolder> constants_;
+    size_t temporaries_;
+};
+
+void WritePerfMap(const void* code, size_t size, const string& name) {
+    const string path = "/tmp/perf-"s + to_string(getpid()) + ".map"s;
+    if (FILE* file = fopen(path.c_str(), "a")) {
+        fprintf(file, "%lx %zx mython:%s\n", reinterpret_cast<unsigned long>(code), size,
+                name.empty() ? "method" : name.c_str());
+        fclose(file);
+    }
+}
+
+}  // namespace
+
+/*
+ * Translates a method body into machine code, statement by statement. The variables and the
+ * intermediate values live in the slots of the frame: rbx points to the variables, r14 to the
+ * temporaries and r13 to the constants, r12 holds the NativeFrame. The code calls the helpers
+ * below for everything but the arithmetic and the comparisons of Numbers. A helper returns
+ * FAILED after an exception, and the code leaves at once
+ */
+class NativeCompiler {
+public:
+    explicit NativeCompiler(const MethodBody& method)
+        : method_{method} {
+    }
+
+    // Returns nullptr if the body has a statement the templates don't cover
+    unique_ptr<NativeCode> Compile();
+
+private:
+    using Operands = Quickening::Operands;
+    using Generic = ObjectHolder (*)(const ObjectHolder&, const ObjectHolder&, Context&);
+    using GenericHelper = int64_t (*)(NativeFrame*, ObjectHolder*, const ObjectHolder*,
+                                      const ObjectHolder*);
+
+    // Thrown when the body can't be compiled
+    struct Unsupported {};
+
+    struct Operand {
+        Register base;
+        int32_t offset;
+    };
+
+    struct Argument {
+        enum class Kind : uint8_t { ADDRESS, VALUE, KEPT };
+
+        Kind kind;
+        Operand operand;
+        uint64_t value;
+    };
+
+    static Argument Address(Operand operand) {
+        return {Argument::Kind::ADDRESS, operand, 0};
+    }
+    template <typename T>
+    static Argument Value(T* pointer) {
+        return {Argument::Kind::VALUE, {}, reinterpret_cast<uint64_t>(pointer)};
+    }
+    static Argument Value(uint64_t value) {
+        return {Argument::Kind::VALUE, {}, value};
+    }
+    // The argument has been computed in its register already
+    static Argument Kept() {
+        return {Argument::Kind::KEPT, {}, 0};
+    }
+
+    void Execute(const Statement& statement);
+    void Evaluate(const Statement& expression, Operand dst);
+    // Returns the slot holding the value: the variable or the constant itself if it is one
+    Operand ValueOf(const Statement& expression);
+    // Jumps to target if the truth of the condition is when
+    void Branch(const Statement& condition, Label& target, bool when);
+    void CompareBranch(const Comparison& comparison, Label& target, bool when);
+    // Adds, subtracts or multiplies two Numbers inline, anything else and an overflow
+    // go to the helper of the generic operation
+    void Arithmetic(const BinaryOperation& operation, Operand dst, GenericHelper generic);
+    // Loads the objects of the operands into rax and rcx, jumps to slow unless both are Numbers
+    void LoadNumbers(Operand lhs, Operand rhs, bool proven, Label& slow);
+    // Evaluates self and the arguments of the call into consecutive temporaries
+    Operand Arguments(const MethodCall& call);
+
+    Operand Variable(const string& name);
+    Operand LoadVariable(const string& name);
+    const Operand* Constant(const Statement& expression);
+    Operand Temporaries(size_t count);
+    // Calls the helper with the frame and the arguments, and leaves the code if it has failed
+    template <typename Helper>
+    void CallHelper(Helper helper, initializer_list<Argument> arguments);
+
+    template <typename Body>
+    static int64_t Guard(NativeFrame* frame, Body body) {
+        try {
+            return body();
+        } catch (...) {
+            frame->error = current_exception();
+            return FAILED;
+        }
+    }
+
+    // The helpers. The results are copied before they are stored, as the slot written may hold
+    // the only reference to the object they come from
+    static int64_t Copy(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* src);
+    static int64_t Unassigned(NativeFrame* frame, const string* name);
+    static int64_t LoadFields(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* object,
+                              const VariableValue* variable);
+    static int64_t CheckFieldOwner(NativeFrame* frame, const ObjectHolder* object);
+    static int64_t StoreField(NativeFrame* frame, const ObjectHolder* object,
+                              const ObjectHolder* value, const string* field);
+    template <Generic generic>
+    static int64_t GenericArithmetic(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* lhs,
+                                     const ObjectHolder* rhs);
+    static int64_t BoxNumber(NativeFrame* frame, ObjectHolder* dst, int64_t value);
+    static int64_t Compare(NativeFrame* frame, const ObjectHolder* lhs, const ObjectHolder* rhs,
+                           uint64_t operation);
+    static int64_t StoreBool(NativeFrame* frame, ObjectHolder* dst, uint64_t value);
+    static int64_t IsTrue(NativeFrame* frame, const ObjectHolder* value);
+    static int64_t CheckReceiver(NativeFrame* frame, const ObjectHolder* object);
+    static int64_t Call(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* block,
+                        const string* method, uint64_t count);
+    // Returns RESTART after rebinding the frame for a recursive call, otherwise makes the call
+    // and sets its result
+    static int64_t TailCall(NativeFrame* frame, ObjectHolder* block, const string* method,
+                            uint64_t count);
+    static int64_t SetResult(NativeFrame* frame, const ObjectHolder* value);
+    static int64_t Write(NativeFrame* frame, const char* text);
+    static int64_t Print(NativeFrame* frame, const ObjectHolder* value);
+    static int64_t Stringify(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* value);
+    static int64_t NewInstance(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* args,
+                               const runtime::Class* cls, uint64_t count, uint64_t init);
+
+    const MethodBody& method_;
+    const Layout& layout_ = GetLayout();
+    Assembler assembler_;
+    vector<string> variables_;
+    vector<ObjectHolder> constants_;
+    // The constant slots of the nodes, so that a constant in a loop is not added again
+    vector<pair<const Statement*, Operand>> constant_slots_;
+    size_t temporaries_ = 0;
+    size_t max_temporaries_ = 0;
+    Label start_, returned_, failed_;
+};
+
+unique_ptr<NativeCode> NativeCompiler::Compile() {
+    auto& a = assembler_;
+    for (Register r : {RBX, R12, R13, R14, R15}) {
+        a.Push(r);
+    }
+    a.Move(R12, RDI);
+    a.Move(RBX, RSI);
+    a.Move(R13, RDX);
+    a.Move(R14, RCX);
+    a.Bind(start_);
+    try {
+        Execute(*method_.body_);
+    } catch (const Unsupported&) {
+        return nullptr;
+    }
+    // falling off the end returns None
+    a.Bind(returned_);
+    a.SetStatus(0);
+    Label leave;
+    a.Bind(leave);
+    for (Register r : {R15, R14, R13, R12, RBX}) {
+        a.Pop(r);
+    }
+    a.Return();
+    a.Bind(failed_);
+    a.SetStatus(static_cast<int32_t>(FAILED));
+    a.Jump(leave);
+
+    const auto& code = a.GetCode();
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t size = (code.size() + page - 1) / page * page;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    if (jit.perf_map) {
+        WritePerfMap(memory, code.size(), method_.GetName());
+    }
+    ++jit.compiled_methods;
+    jit.code_bytes += code.size();
+    return make_unique<NativeCode>(method_, memory, size, std::move(variables_),
+                                   std::move(constants_), max_temporaries_);
+}
+
+void NativeCompiler::Execute(const Statement& statement) {
+    auto& a = assembler_;
+    const size_t temporaries = temporaries_;
+    if (const auto* compound = dynamic_cast<const Compound*>(&statement)) {
+        for (const auto& child : compound->args_) {
+            Execute(*child);
+        }
+    } else if (const auto* assignment = dynamic_cast<const Assignment*>(&statement)) {
+        Evaluate(*assignment->rv_, Variable(assignment->var_));
+    } else if (const auto* field = dynamic_cast<const FieldAssignment*>(&statement)) {
+        const Operand object = ValueOf(field->object_);
+        CallHelper(&CheckFieldOwner, {Address(object)});
+        const Operand value = ValueOf(*field->rv_);
+        CallHelper(&StoreField, {Address(object), Address(value), Value(&field->field_name_)});
+    } else if (const auto* return_statement = dynamic_cast<const Return*>(&statement)) {
+        if (const MethodCall* call = return_statement->tail_call_) {
+            const Operand block = Arguments(*call);
+            CallHelper(&TailCall, {Address(block), Value(&call->method_),
+                                   Value(uint64_t{call->args_.size()})});
+            a.CompareStatus(static_cast<int8_t>(RESTART));
+            a.JumpIf(Condition::IF_EQUAL, start_);
+        } else {
+            CallHelper(&SetResult, {Address(ValueOf(*return_statement->statement_))});
+        }
+        a.Jump(returned_);
+    } else if (const auto* if_else = dynamic_cast<const IfElse*>(&statement)) {
+        Label otherwise;
+        Branch(*if_else->condition_, otherwise, false);
+        Execute(*if_else->if_body_);
+        if (if_else->else_body_) {
+            Label done;
+            a.Jump(done);
+            a.Bind(otherwise);
+            Execute(*if_else->else_body_);
+            a.Bind(done);
+        } else {
+            a.Bind(otherwise);
+        }
+    } else if (const auto* print = dynamic_cast<const ast::Print*>(&statement)) {
+        // the values are printed as they are evaluated, as Print::Execute does
+        for (size_t i = 0; i < print->args_.size(); ++i) {
+            if (i > 0) {
+                CallHelper(&Write, {Value(" ")});
+            }
+            CallHelper(&NativeCompiler::Print, {Address(ValueOf(*print->args_[i]))});
+            temporaries_ = temporaries;
+        }
+        CallHelper(&Write, {Value("\n")});
+    } else {
+        Evaluate(statement, Temporaries(1));
+    }
+    temporaries_ = temporaries;
+}
+
+void NativeCompiler::Evaluate(const Statement& expression, Operand dst) {
+    auto& a = assembler_;
+    if (const auto* variable = dynamic_cast<const VariableValue*>(&expression)) {
+        const Operand object = LoadVariable(variable->var_name_);
+        if (variable->fields_.empty()) {
+            CallHelper(&Copy, {Address(dst), Address(object)});
+        } else {
+            CallHelper(&LoadFields, {Address(dst), Address(object), Value(variable)});
+        }
+    } else if (const Operand* constant = Constant(expression)) {
+        CallHelper(&Copy, {Address(dst), Address(*constant)});
+    } else if (const auto* add = dynamic_cast<const Add*>(&expression)) {
+        Arithmetic(*add, dst, &GenericArithmetic<&AddObjects>);
+    } else if (const auto* sub = dynamic_cast<const Sub*>(&expression)) {
+        Arithmetic(*sub, dst, &GenericArithmetic<&SubtractObjects>);
+    } else if (const auto* mult = dynamic_cast<const Mult*>(&expression)) {
+        Arithmetic(*mult, dst, &GenericArithmetic<&MultiplyObjects>);
+    } else if (const auto* div = dynamic_cast<const Div*>(&expression)) {
+        const Operand lhs = ValueOf(*div->lhs_);
+        const Operand rhs = ValueOf(*div->rhs_);
+        CallHelper(&GenericArithmetic<&DivideObjects>, {Address(dst), Address(lhs), Address(rhs)});
+    } else if (dynamic_cast<const Comparison*>(&expression) || dynamic_cast<const And*>(&expression)
+               || dynamic_cast<const Or*>(&expression) || dynamic_cast<const Not*>(&expression)) {
+        Label is_false;
+        Label done;
+        Branch(expression, is_false, false);
+        CallHelper(&StoreBool, {Address(dst), Value(uint64_t{1})});
+        a.Jump(done);
+        a.Bind(is_false);
+        CallHelper(&StoreBool, {Address(dst), Value(uint64_t{0})});
+        a.Bind(done);
+    } else if (const auto* call = dynamic_cast<const MethodCall*>(&expression)) {
+        const Operand block = Arguments(*call);
+        CallHelper(&Call, {Address(dst), Address(block), Value(&call->method_),
+                           Value(uint64_t{call->args_.size()})});
+    } else if (const auto* instance = dynamic_cast<const ast::NewInstance*>(&expression)) {
+        const size_t count = instance->args_.size();
+        const auto* init = instance->class_.GetMethod(runtime::SpecialMethod::INIT);
+        // the arguments are evaluated only if __init__ takes them, as in CreateInstance
+        const bool with_init = init != nullptr && init->formal_params.size() == count;
+        const Operand args = Temporaries(with_init ? count : 0);
+        if (with_init) {
+            for (size_t i = 0; i < count; ++i) {
+                Evaluate(*instance->args_[i],
+                         {args.base, args.offset + static_cast<int32_t>(i * sizeof(ObjectHolder))});
+            }
+        }
+        CallHelper(&NativeCompiler::NewInstance,
+                   {Address(dst), Address(args), Value(&instance->class_), Value(uint64_t{count}),
+                    Value(uint64_t{with_init})});
+    } else if (const auto* stringify = dynamic_cast<const ast::Stringify*>(&expression)) {
+        CallHelper(&NativeCompiler::Stringify,
+                   {Address(dst), Address(ValueOf(*stringify->argument_))});
+    } else {
+        throw Unsupported{};
+    }
+}
+
+NativeCompiler::Operand NativeCompiler::ValueOf(const Statement& expression) {
+    if (const auto* variable = dynamic_cast<const VariableValue*>(&expression);
+        variable != nullptr && variable->fields_.empty()) {
+        return LoadVariable(variable->var_name_);
+    }
+    if (const Operand* constant = Constant(expression)) {
+        return *constant;
+    }
+    const Operand result = Temporaries(1);
+    Evaluate(expression, result);
+    return result;
+}
+
+void NativeCompiler::Branch(const Statement& condition, Label& target, bool when) {
+    auto& a = assembler_;
+    if (const auto* negation = dynamic_cast<const Not*>(&condition)) {
+        Branch(*negation->argument_, target, !when);
+        return;
+    }
+    const auto* both = dynamic_cast<const And*>(&condition);
+    const auto* either = dynamic_cast<const Or*>(&condition);
+    if (both != nullptr || either != nullptr) {
+        const auto& operation = both != nullptr ? static_cast<const BinaryOperation&>(*both)
+                                                : static_cast<const BinaryOperation&>(*either);
+        // a false operand decides and, a true one decides or
+        const bool decisive = either != nullptr;
+        if (when == decisive) {
+            Branch(*operation.lhs_, target, when);
+            Branch(*operation.rhs_, target, when);
+        } else {
+            Label skip;
+            Branch(*operation.lhs_, skip, decisive);
+            Branch(*operation.rhs_, target, when);
+            a.Bind(skip);
+        }
+        return;
+    }
+    if (const auto* comparison = dynamic_cast<const Comparison*>(&condition)) {
+        CompareBranch(*comparison, target, when);
+        return;
+    }
+    const size_t temporaries = temporaries_;
+    CallHelper(&IsTrue, {Address(ValueOf(condition))});
+    a.Test(RAX);
+    a.JumpIf(when ? Condition::IF_NOT_EQUAL : Condition::IF_EQUAL, target);
+    temporaries_ = temporaries;
+}
+
+void NativeCompiler::CompareBranch(const Comparison& comparison, Label& target, bool when) {
+    auto& a = assembler_;
+    const size_t temporaries = temporaries_;
+    const Operand lhs = ValueOf(*comparison.lhs_);
+    const Operand rhs = ValueOf(*comparison.rhs_);
+    const Operands operands = comparison.quickening_.GetSpecialization();
+    const bool proven = comparison.quickening_.IsProven();
+    Label slow;
+    Label done;
+    if (operands != Operands::STRINGS) {
+        const Condition condition = ConditionOf(comparison.operation_);
+        LoadNumbers(lhs, rhs, proven && operands == Operands::NUMBERS, slow);
+        a.Load(RDX, RAX, layout_.number_value);
+        a.CompareMemory(RDX, RCX, layout_.number_value);
+        a.JumpIf(when ? condition : Negate(condition), target);
+        if (proven && operands == Operands::NUMBERS) {
+            temporaries_ = temporaries;
+            return;
+        }
+        a.Jump(done);
+    }
+    a.Bind(slow);
+    CallHelper(&Compare, {Address(lhs), Address(rhs),
+                          Value(static_cast<uint64_t>(comparison.operation_))});
+    a.Test(RAX);
+    a.JumpIf(when ? Condition::IF_NOT_EQUAL : Condition::IF_EQUAL, target);
+    a.Bind(done);
+    temporaries_ = temporaries;
+}
+
+void NativeCompiler::Arithmetic(const BinaryOperation& operation, Operand dst,
+                                GenericHelper generic) {
+    auto& a = assembler_;
+    const Operand lhs = ValueOf(*operation.lhs_);
+    const Operand rhs = ValueOf(*operation.rhs_);
+    const Operands operands = operation.quickening_.GetSpecialization();
+    const bool proven = operation.quickening_.IsProven();
+    Label slow;
+    Label done;
+    if (operands != Operands::STRINGS) {
+        LoadNumbers(lhs, rhs, proven && operands == Operands::NUMBERS, slow);
+        a.Load(RDX, RAX, layout_.number_value);
+        if (dynamic_cast<const Add*>(&operation)) {
+            a.AddMemory(RDX, RCX, layout_.number_value);
+        } else if (dynamic_cast<const Sub*>(&operation)) {
+            a.SubtractMemory(RDX, RCX, layout_.number_value);
+        } else {
+            a.MultiplyMemory(RDX, RCX, layout_.number_value);
+        }
+        // the overflow is left to the generic operation, which promotes to BigInt
+        a.JumpIf(Condition::IF_OVERFLOW, slow);
+        CallHelper(&BoxNumber, {Address(dst), Kept()});
+        a.Jump(done);
+    }
+    a.Bind(slow);
+    CallHelper(generic, {Address(dst), Address(lhs), Address(rhs)});
+    a.Bind(done);
+}
+
+void NativeCompiler::LoadNumbers(Operand lhs, Operand rhs, bool proven, Label& slow) {
+    auto& a = assembler_;
+    a.Load(RAX, lhs.base, lhs.offset);
+    a.Load(RCX, rhs.base, rhs.offset);
+    if (proven) {
+        return;
+    }
+    a.Test(RAX);
+    a.JumpIf(Condition::IF_EQUAL, slow);
+    a.Test(RCX);
+    a.JumpIf(Condition::IF_EQUAL, slow);
+    a.MoveImmediate(R11, reinterpret_cast<uint64_t>(layout_.number_table));
+    a.CompareMemory(R11, RAX, 0);
+    a.JumpIf(Condition::IF_NOT_EQUAL, slow);
+    a.CompareMemory(R11, RCX, 0);
+    a.JumpIf(Condition::IF_NOT_EQUAL, slow);
+}
+
+NativeCompiler::Operand NativeCompiler::Arguments(const MethodCall& call) {
+    const Operand block = Temporaries(1 + call.args_.size());
+    Evaluate(*call.object_, block);
+    CallHelper(&CheckReceiver, {Address(block)});
+    for (size_t i = 0; i < call.args_.size(); ++i) {
+        Evaluate(*call.args_[i],
+                 {block.base, block.offset + static_cast<int32_t>((i + 1) * sizeof(ObjectHolder))});
+    }
+    return block;
+}
+
+NativeCompiler::Operand NativeCompiler::Variable(const string& name) {
+    size_t index = 0;
+    while (index < variables_.size() && variables_[index] != name) {
+        ++index;
+    }
+    if (index == variables_.size()) {
+        variables_.push_back(name);
+    }
+    return {RBX, static_cast<int32_t>(index * sizeof(ObjectHolder))};
+}
+
+NativeCompiler::Operand NativeCompiler::LoadVariable(const string& name) {
+    auto& a = assembler_;
+    const Operand variable = Variable(name);
+    Label assigned;
+    a.Load(RAX, variable.base, variable.offset);
+    a.MoveImmediate(RCX, reinterpret_cast<uint64_t>(runtime::Unbound().Get()));
+    a.Compare(RAX, RCX);
+    a.JumpIf(Condition::IF_NOT_EQUAL, assigned);
+    CallHelper(&Unassigned, {Value(&name)});
+    a.Bind(assigned);
+    return variable;
+}
+
+const NativeCompiler::Operand* NativeCompiler::Constant(const Statement& expression) {
+    for (const auto& [node, slot] : constant_slots_) {
+        if (node == &expression) {
+            return &slot;
+        }
+    }
+    ObjectHolder value;
+    if (const auto* number = dynamic_cast<const NumericConst*>(&expression)) {
+        value = ObjectHolder::Share(const_cast<runtime::Number&>(number->value_));
+    } else if (const auto* string = dynamic_cast<const StringConst*>(&expression)) {
+        value = ObjectHolder::Share(const_cast<runtime::String&>(string->value_));
+    } else if (const auto* boolean = dynamic_cast<const BoolConst*>(&expression)) {
+        value = ObjectHolder::Share(const_cast<runtime::Bool&>(boolean->value_));
+    } else if (const auto* real = dynamic_cast<const FloatConst*>(&expression)) {
+        value = ObjectHolder::Share(const_cast<runtime::Float&>(real->value_));
+    } else if (const auto* big = dynamic_cast<const BigIntConst*>(&expression)) {
+        value = ObjectHolder::Share(const_cast<runtime::BigInt&>(big->value_));
+    } else if (!dynamic_cast<const None*>(&expression)) {
+        return nullptr;
+    }
+    constants_.push_back(std::move(value));
+    const Operand slot{R13, static_cast<int32_t>((constants_.size() - 1) * sizeof(ObjectHolder))};
+    constant_slots_.emplace_back(&expression, slot);
+    return &constant_slots_.back().second;
+}
+
+NativeCompiler::Operand NativeCompiler::Temporaries(size_t count) {
+    const Operand result{R14, static_cast<int32_t>(temporaries_ * sizeof(ObjectHolder))};
+    temporaries_ += count;
+    max_temporaries_ = max(max_temporaries_, temporaries_);
+    return result;
+}
+
+template <typename Helper>
+void NativeCompiler::CallHelper(Helper helper, initializer_list<Argument> arguments) {
+    static constexpr Register REGISTERS[] = {RSI, RDX, RCX, R8, R9};
+    auto& a = assembler_;
+    size_t index = 0;
+    for (const Argument& argument : arguments) {
+        const Register r = REGISTERS[index++];
+        switch (argument.kind) {
+            case Argument::Kind::ADDRESS:
+                a.LoadAddress(r, argument.operand.base, argument.operand.offset);
+                break;
+            case Argument::Kind::VALUE:
+                a.MoveImmediate(r, argument.value);
+                break;
+            case Argument::Kind::KEPT:
+                break;
+        }
+    }
+    a.Move(RDI, R12);
+    a.MoveImmediate(RAX, reinterpret_cast<uint64_t>(helper));
+    a.Call(RAX);
+    a.CompareStatus(static_cast<int8_t>(FAILED));
+    a.JumpIf(Condition::IF_EQUAL, failed_);
+}
+
+int64_t NativeCompiler::Copy([[maybe_unused]] NativeFrame* frame, ObjectHolder* dst,
+                             const ObjectHolder* src) {
+    ObjectHolder value = *src;
+    *dst = std::move(value);
+    return 0;
+}
+
+int64_t NativeCompiler::Unassigned(NativeFrame* frame, const string* name) {
+    // throws the error of the interpreter
+    return Guard(frame, [name] {
+        [[maybe_unused]] const auto& value = ast::LoadVariable(Closure{}, *name);
+        return FAILED;
+    });
+}
+
+int64_t NativeCompiler::LoadFields(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* object,
+                                   const VariableValue* variable) {
+    return Guard(frame, [&] {
+        const ObjectHolder* result = object;
+        const string* name = &variable->var_name_;
+        for (const auto& field : variable->fields_) {
+            result = &LoadField(*result, field, *name);
+            name = &field;
+        }
+        ObjectHolder value = *result;
+        *dst = std::move(value);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::CheckFieldOwner(NativeFrame* frame, const ObjectHolder* object) {
+    return Guard(frame, [object] {
+        [[maybe_unused]] const auto& owner = FieldOwner(*object);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::StoreField(NativeFrame* frame, const ObjectHolder* object,
+                                   const ObjectHolder* value, const string* field) {
+    return Guard(frame, [&] {
+        FieldOwner(*object).Fields()[*field] = *value;
+        return int64_t{0};
+    });
+}
+
+template <NativeCompiler::Generic generic>
+int64_t NativeCompiler::GenericArithmetic(NativeFrame* frame, ObjectHolder* dst,
+                                          const ObjectHolder* lhs, const ObjectHolder* rhs) {
+    return Guard(frame, [&] {
+        ObjectHolder result = generic(*lhs, *rhs, frame->context);
+        *dst = std::move(result);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::BoxNumber(NativeFrame* frame, ObjectHolder* dst, int64_t value) {
+    return Guard(frame, [&] {
+        *dst = runtime::MakeNumber(value);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::Compare(NativeFrame* frame, const ObjectHolder* lhs,
+                                const ObjectHolder* rhs, uint64_t operation) {
+    return Guard(frame, [&] {
+        const auto compare = static_cast<runtime::CompareOperation>(operation);
+        return int64_t{runtime::Compare(compare, *lhs, *rhs, frame->context) ? 1 : 0};
+    });
+}
+
+int64_t NativeCompiler::StoreBool([[maybe_unused]] NativeFrame* frame, ObjectHolder* dst,
+                                  uint64_t value) {
+    *dst = runtime::MakeBool(value != 0);
+    return 0;
+}
+
+int64_t NativeCompiler::IsTrue(NativeFrame* frame, const ObjectHolder* value) {
+    return Guard(frame, [value] {
+        return int64_t{runtime::IsTrue(*value) ? 1 : 0};
+    });
+}
+
+int64_t NativeCompiler::CheckReceiver(NativeFrame* frame, const ObjectHolder* object) {
+    return Guard(frame, [object] {
+        CheckMethodReceiver(*object);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::Call(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* block,
+                             const string* method, uint64_t count) {
+    return Guard(frame, [&] {
+        ObjectHolder result = CallMethod(block[0], *method, block + 1, count, frame->context);
+        *dst = std::move(result);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::TailCall(NativeFrame* frame, ObjectHolder* block, const string* method,
+                                 uint64_t count) {
+    return Guard(frame, [&] {
+        // the same check as PrepareTailCall in statement.cpp
+        if (const auto* instance = block[0].TryAs<runtime::ClassInstance>()) {
+            const auto* callee = instance->GetClass().GetMethod(*method);
+            const runtime::Executable* body = &frame->code.GetMethod();
+            if (callee != nullptr && callee->body.get() == body
+                && callee->formal_params.size() == count) {
+                frame->code.Rebind(frame->variables, block, callee->formal_params);
+                return RESTART;
+            }
+        }
+        frame->result = CallMethod(block[0], *method, block + 1, count, frame->context);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::SetResult(NativeFrame* frame, const ObjectHolder* value) {
+    frame->result = *value;
+    return 0;
+}
+
+int64_t NativeCompiler::Write(NativeFrame* frame, const char* text) {
+    return Guard(frame, [&] {
+        frame->context.GetOutputStream() << text;
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::Print(NativeFrame* frame, const ObjectHolder* value) {
+    return Guard(frame, [&] {
+        PrintValue(*value, frame->context);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::Stringify(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* value) {
+    return Guard(frame, [&] {
+        ObjectHolder result = StringValue(*value, frame->context);
+        *dst = std::move(result);
+        return int64_t{0};
+    });
+}
+
+int64_t NativeCompiler::NewInstance(NativeFrame* frame, ObjectHolder* dst, const ObjectHolder* args,
+                                    const runtime::Class* cls, uint64_t count, uint64_t init) {
+    return Guard(frame, [&] {
+        auto instance = ObjectHolder::Own(runtime::ClassInstance(*cls));
+        if (init != 0) {
+            static_cast<runtime::ClassInstance&>(*instance)
+                .Call(runtime::SpecialMethod::INIT, args, count, frame->context);
+        }
+        *dst = std::move(instance);
+        return int64_t{0};
+    });
+}
+
+bool IsJitSupported() {
+    return GetLayout().valid;
+}
+
+runtime::Compiled CompileNative(const MethodBody& method) {
+    if (!IsJitSupported()) {
+        return {};
+    }
+    shared_ptr<const NativeCode> code = NativeCompiler(method).Compile();
+    if (!code) {
+        return {};
+    }
+    return [code](Closure& closure, Context& context) {
+        return code->Run(closure, context);
+    };
+}
+
+#else
+
+bool IsJitSupported() {
+    return false;
+}
+
+runtime::Compiled CompileNative([[maybe_unused]] const MethodBody& method) {
+    return {};
+}
+
+#endif
+
+}  // namespace ast
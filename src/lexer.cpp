@@ -25,6 +25,12 @@ bool operator==(const Token& lhs, const Token& rhs) {
     if (lhs.Is<Number>()) {
         return lhs.As<Number>().value == rhs.As<Number>().value;
     }
+    if (lhs.Is<Float>()) {
+        return lhs.As<Float>().value == rhs.As<Float>().value;
+    }
+    if (lhs.Is<BigNumber>()) {
+        return lhs.As<BigNumber>().value == rhs.As<BigNumber>().value;
+    }
     if (lhs.Is<String>()) {
         return lhs.As<String>().value == rhs.As<String>().value;
     }
@@ -45,6 +51,8 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     if (auto p = rhs.TryAs<type>()) return os << #type << '{' << p->value << '}';
 
     VALUED_OUTPUT(Number);
+    VALUED_OUTPUT(Float);
+    VALUED_OUTPUT(BigNumber);
     VALUED_OUTPUT(Id);
     VALUED_OUTPUT(String);
     VALUED_OUTPUT(Char);
@@ -73,6 +81,8 @@ std::ostream& operator<<(std::ostream& os, const Token& rhs) {
     UNVALUED_OUTPUT(None);
     UNVALUED_OUTPUT(True);
     UNVALUED_OUTPUT(False);
+    UNVALUED_OUTPUT(For);
+    UNVALUED_OUTPUT(In);
     UNVALUED_OUTPUT(Eof);
 
 #undef UNVALUED_OUTPUT
@@ -179,7 +189,7 @@ void Lexer::ParseIndent() {
 void Lexer::ParseToken() {
     char ch = input_.peek();
     if (util::IsNum(ch)) {   // if the next token is a number
-        current_token_ = token_type::Number{util::ReadNumber(input_)};
+        ParseNumber();
     } else if (util::IsAlNumLL(ch)) {    // If the next token is a name
         ParseName();
     } else if (ch == '\"' || ch == '\'') { // if the next token string
@@ -189,6 +199,17 @@ void Lexer::ParseToken() {
     }
 }
 
+void Lexer::ParseNumber() {
+    auto number = util::ReadNumber(input_);
+    if (const auto* value = std::get_if<int64_t>(&number)) {
+        current_token_ = token_type::Number{*value};
+    } else if (const auto* digits = std::get_if<std::string>(&number)) {
+        current_token_ = token_type::BigNumber{std::move(*digits)};
+    } else {
+        current_token_ = token_type::Float{std::get<double>(number)};
+    }
+}
+
 void Lexer::ParseName() {
     auto name = util::ReadName(input_);
     if (util::KeyWords.count(name) != 0) { // if it is a keyword - assign the appropriate token
@@ -296,21 +317,59 @@ std::string ReadLine(std::istream &input) {
     return s;
 }
 
-int ReadNumber(std::istream &input) {
-    std::string num;
+std::string ReadDigits(std::istream &input) {
+    std::string digits;
     char c;
     while(input.get(c)) {
         if (IsNum(c)) {
-            num += c;
+            digits += c;
         } else {
             input.putback(c);
             break;
         }
     }
+    return digits;
+}
+
+std::variant<int64_t, double, std::string> ReadNumber(std::istream &input) {
+    std::string num = ReadDigits(input);
     if (num.empty()) {
-        return 0;
+        return int64_t{0};
+    }
+    bool is_float = false;
+    if (input.peek() == '.') {
+        num += static_cast<char>(input.get());
+        num += ReadDigits(input);
+        is_float = true;
     }
-    return std::stoi(num);
+    if (input.peek() == 'e' || input.peek() == 'E') {
+        num += static_cast<char>(input.get());
+        if (input.peek() == '+' || input.peek() == '-') {
+            num += static_cast<char>(input.get());
+        }
+        std::string exponent = ReadDigits(input);
+        if (exponent.empty()) {
+            throw std::runtime_error("Exponent has no digits : "s + num);
+        }
+        num += exponent;
+        is_float = true;
+    }
+
+    if (is_float) {
+        double result = 0;
+        auto [ptr, ec] = std::from_chars(num.data(), num.data() + num.size(), result);
+        if (ec != std::errc()) {
+            throw std::runtime_error("Float literal is out of range : "s + num);
+        }
+        return result;
+    }
+    int64_t result = 0;
+    auto [ptr, ec] = std::from_chars(num.data(), num.data() + num.size(), result);
+    if (ec == std::errc::result_out_of_range) {
+        num.erase(0, std::min(num.find_first_not_of('0'), num.size() - 1));
+        return num;
+    }
+    return result;
 }
 
 } // namespace util
@@ -23,7 +23,7 @@ void TestSimpleAssignment() {
 }
 
 void TestKeywords() {
-    istringstream input("class return if else def print or None and not True False"s);
+    istringstream input("class return if else def print or None and not True False for in"s);
     Lexer lexer(input);
 
     ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Class{}));
@@ -38,6 +38,8 @@ void TestKeywords() {
     ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Not{}));
     ASSERT_EQUAL(lexer.NextToken(), Token(token_type::True{}));
     ASSERT_EQUAL(lexer.NextToken(), Token(token_type::False{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::For{}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::In{}));
 }
 
 void TestNumbers() {
@@ -51,6 +53,26 @@ void TestNumbers() {
     ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{53}));
 }
 
+void TestFloats() {
+    istringstream input("0.5 12. 1e3 2.5E-2 7"s);
+    Lexer lexer(input);
+
+    ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Float{0.5}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{12.0}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{1000.0}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Float{0.025}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{7}));
+}
+
+void TestBigNumbers() {
+    istringstream input("9223372036854775807 9223372036854775808 00099999999999999999999"s);
+    Lexer lexer(input);
+
+    ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Number{9223372036854775807}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::BigNumber{"9223372036854775808"s}));
+    ASSERT_EQUAL(lexer.NextToken(), Token(token_type::BigNumber{"99999999999999999999"s}));
+}
+
 void TestIds() {
     istringstream input("x    _42 big_number   Return Class  dEf"s);
     Lexer lexer(input);
@@ -357,6 +379,8 @@ void RunOpenLexerTests(TestRunner& tr) {
     RUN_TEST(tr, parse::TestSimpleAssignment);
     RUN_TEST(tr, parse::TestKeywords);
     RUN_TEST(tr, parse::TestNumbers);
+    RUN_TEST(tr, parse::TestFloats);
+    RUN_TEST(tr, parse::TestBigNumbers);
     RUN_TEST(tr, parse::TestIds);
     RUN_TEST(tr, parse::TestStrings);
     RUN_TEST(tr, parse::TestOperations);
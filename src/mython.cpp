@@ -1,38 +1,216 @@
+#include "cpp_emitter.h"
+#include "ir.h"
+#include "jit.h"
 #include "lexer.h"
 #include "parse.h"
 #include "runtime.h"
 #include "statement.h"
+#include "type_inference.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
 
 using namespace std;
 
 namespace {
 
-void RunMythonProgram(istream& input, ostream& output) {
+struct Options {
+    // Print the runtime statistics to cerr after the program has finished
+    bool stats = false;
+    // Lower the program into closures (see Executable::Compile) instead of walking the tree
+    bool compile = false;
+    // Write the program as C++ code to the output file instead of running it
+    bool emit_cpp = false;
+    // The number of container allocations between cycle collections
+    size_t gc_threshold = runtime::Heap::DEFAULT_THRESHOLD;
+    // The number of calls after which a method body is compiled, 0 never
+    uint32_t tier_up_threshold = ast::Tiering::DEFAULT_THRESHOLD;
+    // Compile the hot method bodies into machine code rather than into closures
+    bool jit = false;
+    // Write the machine code of the methods into /tmp/perf-<pid>.map for perf
+    bool perf_map = false;
+    // The largest expression returned by a method which is inlined into the compiled code, 0 none
+    size_t inline_size = ast::Inlining::DEFAULT_MAX_SIZE;
+    // The maximum depth of the method calls
+    size_t max_depth = runtime::CallStack::DEFAULT_MAX_DEPTH;
+    // Cache the results of the pure methods (see runtime::Memoization)
+    bool memoize = false;
+    // The number of the results cached per method
+    size_t memo_capacity = runtime::Memoization::DEFAULT_CAPACITY;
+    // The IR passes run before the program is executed or written, none if empty
+    vector<string> passes = ast::ir::StandardPipeline();
+};
+
+void PrintStats(ostream& os, double seconds) {
+    const auto allocated = runtime::allocation_stats.allocated;
+    os << "Allocated objects: "sv << allocated << " ("sv
+       << static_cast<double>(allocated) / std::max(seconds, 1e-9) / 1e6 << " M/s)"sv << endl;
+    const auto& gc = runtime::heap.GetStats();
+    os << "GC collections: "sv << gc.minor_collections << " minor, "sv << gc.major_collections
+       << " major, collected: "sv << gc.collected << ", promoted: "sv << gc.promoted
+       << ", tracked: "sv << runtime::heap.GetTrackedCount() << endl;
+    os << "GC pauses: total "sv << gc.total_pause_ms << " ms, max "sv << gc.max_pause_ms
+       << " ms, minor p50 "sv << runtime::heap.GetMinorPausePercentile(50) << " ms, p90 "sv
+       << runtime::heap.GetMinorPausePercentile(90) << " ms, p99 "sv
+       << runtime::heap.GetMinorPausePercentile(99) << " ms"sv << endl;
+    const auto& quickening = ast::quickening_stats;
+    os << "Quickened nodes: "sv << quickening.specialized_numbers << " numbers, "sv
+       << quickening.specialized_strings << " strings, deoptimized: "sv << quickening.deoptimized
+       << ", proven ahead of time: "sv << quickening.proven << endl;
+    const auto& ir = ast::ir_stats;
+    os << "IR: "sv << ir.functions << " functions, "sv << ir.instructions << " instructions"sv;
+    for (const auto& pass : ir.passes) {
+        os << ", "sv << pass.name << ": "sv << pass.changes;
+    }
+    os << endl;
+    os << "Tiered up methods: "sv << ast::tiering.compiled_methods << endl;
+    os << "JIT compiled methods: "sv << ast::jit.compiled_methods << ", code: "sv
+       << ast::jit.code_bytes << " bytes"sv << endl;
+    os << "Inlined calls: "sv << ast::inlining.inlined_calls << endl;
+    const auto& memoization = runtime::memoization;
+    const auto memoized_calls = memoization.hits + memoization.misses;
+    os << "Memoized calls: "sv << memoized_calls << ", hits: "sv << memoization.hits << " ("sv
+       << (memoized_calls == 0 ? 0.0 : 100.0 * static_cast<double>(memoization.hits)
+                                           / static_cast<double>(memoized_calls))
+       << "%), evictions: "sv << memoization.evictions << endl;
+    const auto& calls = runtime::call_stack;
+    os << "Calls: deepest "sv << calls.GetDeepest() << " of max "sv << calls.GetMaxDepth()
+       << ", native stack per call: "sv << calls.GetBytesPerCall() << " bytes, segments: "sv
+       << calls.GetSegmentCount() << endl;
+}
+
+void PrintUsage(const char* argv0) {
+    cerr << "Mython interpreter!"sv << endl;
+    std::filesystem::path interpreter = argv0;
+    cerr << "Usage: "sv << interpreter.filename() << " [--stats] [--compile] [--emit-cpp] [--memoize] [--memo-capacity=N] [--gc-threshold=N] [--tier-up=N] [--jit] [--perf-map] [--inline-size=N] [--max-depth=N] [--passes=a,b,...] <in_file> <out_file>"sv << endl;
+}
+
+// Returns the number written with decimal digits only, nullopt if there are other characters
+// or the number is greater than max
+optional<size_t> ParseCount(string_view text, size_t max = numeric_limits<size_t>::max()) {
+    if (text.empty()) {
+        return nullopt;
+    }
+    size_t value = 0;
+    for (const char c : text) {
+        if (c < '0' || c > '9') {
+            return nullopt;
+        }
+        const auto digit = static_cast<size_t>(c - '0');
+        if (value > (max - digit) / 10) {
+            return nullopt;
+        }
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+void RunMythonProgram(istream& input, ostream& output, const Options& options) {
     parse::Lexer lexer(input);
 
     auto program = ParseProgram(lexer);
+    ast::OptimizeProgram(*program, options.passes);
+    ast::InferTypes(*program);
+    if (options.emit_cpp) {
+        ast::EmitCpp(*program, output);
+        return;
+    }
 
+    runtime::heap.SetThreshold(options.gc_threshold);
+    ast::tiering.threshold = options.tier_up_threshold;
+    ast::jit.enabled = options.jit;
+    ast::jit.perf_map = options.perf_map;
+    ast::inlining.max_size = options.inline_size;
+    runtime::call_stack.SetMaxDepth(options.max_depth);
+    runtime::memoization.enabled = options.memoize;
+    runtime::memoization.capacity = options.memo_capacity;
     runtime::SimpleContext context{output};
     runtime::Closure closure;
-    program->Execute(closure, context);
+    const auto start = chrono::steady_clock::now();
+    if (options.compile) {
+        program->Compile()(closure, context);
+    } else {
+        program->Execute(closure, context);
+    }
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    if (options.stats) {
+        PrintStats(cerr, elapsed.count());
+    }
 }
 
 }
 
 int main(int argc, const char** argv) {
-    if (argc != 3) {
-            cerr << "Mython interpreter!"sv << endl;
-            std::filesystem::path interpreter = argv[0];
-            cerr << "Usage: "sv << interpreter.filename() << " <in_file> <out_file>"sv << endl;
-            return 1;
+    Options options;
+    vector<string_view> files;
+    // The option with a number which is not valid, empty if there is none
+    string_view invalid_option;
+    // Returns the number after the name of the option and =, remembers the option if it is not valid
+    auto count = [&invalid_option](string_view arg, string_view name,
+                                   size_t max = numeric_limits<size_t>::max()) -> size_t {
+        const auto value = ParseCount(arg.substr(name.size() + 1), max);
+        if (!value) {
+            invalid_option = name;
+            return 0;
+        }
+        return *value;
+    };
+    for (int i = 1; i < argc && invalid_option.empty(); ++i) {
+        const string_view arg = argv[i];
+        if (arg == "--stats"sv) {
+            options.stats = true;
+        } else if (arg == "--compile"sv) {
+            options.compile = true;
+        } else if (arg == "--emit-cpp"sv) {
+            options.emit_cpp = true;
+        } else if (arg == "--jit"sv) {
+            options.jit = true;
+        } else if (arg == "--perf-map"sv) {
+            options.perf_map = true;
+        } else if (arg == "--memoize"sv) {
+            options.memoize = true;
+        } else if (arg.substr(0, "--memo-capacity="sv.size()) == "--memo-capacity="sv) {
+            options.memo_capacity = count(arg, "--memo-capacity"sv);
+        } else if (arg.substr(0, "--passes="sv.size()) == "--passes="sv) {
+            options.passes.clear();
+            for (auto names = arg.substr("--passes="sv.size()); !names.empty();) {
+                const auto comma = std::min(names.find(','), names.size());
+                options.passes.emplace_back(names.substr(0, comma));
+                names.remove_prefix(std::min(comma + 1, names.size()));
+            }
+        } else if (arg.substr(0, "--gc-threshold="sv.size()) == "--gc-threshold="sv) {
+            options.gc_threshold = count(arg, "--gc-threshold"sv);
+        } else if (arg.substr(0, "--max-depth="sv.size()) == "--max-depth="sv) {
+            options.max_depth = count(arg, "--max-depth"sv);
+        } else if (arg.substr(0, "--tier-up="sv.size()) == "--tier-up="sv) {
+            options.tier_up_threshold = static_cast<uint32_t>(
+                count(arg, "--tier-up"sv, numeric_limits<uint32_t>::max()));
+        } else if (arg.substr(0, "--inline-size="sv.size()) == "--inline-size="sv) {
+            options.inline_size = count(arg, "--inline-size"sv);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (!invalid_option.empty()) {
+        cerr << "Invalid value for "sv << invalid_option << endl;
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (files.size() != 2) {
+        PrintUsage(argv[0]);
+        return 1;
     }
 
-    std::filesystem::path in_path = argv[1];
-    std::filesystem::path out_path = argv[2];
+    std::filesystem::path in_path = files[0];
+    std::filesystem::path out_path = files[1];
 
     ifstream ifile(in_path);
     if (!ifile.is_open()) {
@@ -44,7 +222,7 @@ int main(int argc, const char** argv) {
     }
 
     try {
-        RunMythonProgram(ifile, ofile);
+        RunMythonProgram(ifile, ofile, options);
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
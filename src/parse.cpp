@@ -55,7 +55,7 @@ private:
     }
 
     // Methods -> [def id(Params) : Suite]*
-    vector<runtime::Method> ParseMethods()  // NOLINT
+    vector<runtime::Method> ParseMethods(const string& class_name)  // NOLINT
     {
         vector<runtime::Method> result;
 
@@ -76,7 +76,7 @@ private:
             lexer_.ExpectNext<TokenType::Char>(':');
             lexer_.NextToken();
 
-            m.body = std::make_unique<ast::MethodBody>(ParseSuite());  // NOLINT
+            m.body = std::make_unique<ast::MethodBody>(ParseSuite(), class_name + "."s + m.name);  // NOLINT
 
             result.push_back(std::move(m));
         }
@@ -107,7 +107,7 @@ private:
         lexer_.ExpectNext<TokenType::Newline>();
         lexer_.ExpectNext<TokenType::Indent>();
         lexer_.ExpectNext<TokenType::Def>();
-        vector<runtime::Method> methods = ParseMethods();  // NOLINT
+        vector<runtime::Method> methods = ParseMethods(class_name);  // NOLINT
 
         lexer_.Expect<TokenType::Dedent>();
         lexer_.NextToken();
@@ -227,10 +227,20 @@ private:
             return make_unique<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
         }
         if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Number>()) {
-            int result = num->value;
+            int64_t result = num->value;
             lexer_.NextToken();
             return make_unique<ast::NumericConst>(result);
         }
+        if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::BigNumber>()) {
+            auto result = runtime::BigInteger::FromString(num->value);
+            lexer_.NextToken();
+            return make_unique<ast::BigIntConst>(std::move(result));
+        }
+        if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Float>()) {
+            double result = num->value;
+            lexer_.NextToken();
+            return make_unique<ast::FloatConst>(result);
+        }
         if (const auto* str = lexer_.CurrentToken().TryAs<TokenType::String>()) {
             string result = str->value;
             lexer_.NextToken();
@@ -282,6 +292,28 @@ private:
                 }
                 return make_unique<ast::Stringify>(std::move(args.front()));
             }
+            if (method_name == "join"sv) {
+                if (args.size() != 2) {
+                    throw ParseError("Function join takes exactly two arguments"s);
+                }
+                return make_unique<ast::Join>(std::move(args[0]), std::move(args[1]));
+            }
+            if (method_name == "range"sv) {
+                if (args.size() == 1) {
+                    return make_unique<ast::NewRange>(make_unique<ast::NumericConst>(0),
+                                                      std::move(args.front()));
+                }
+                if (args.size() != 2) {
+                    throw ParseError("Function range takes one or two arguments"s);
+                }
+                return make_unique<ast::NewRange>(std::move(args[0]), std::move(args[1]));
+            }
+            if (method_name == "dict"sv) {
+                if (!args.empty()) {
+                    throw ParseError("Function dict takes no arguments"s);
+                }
+                return make_unique<ast::NewDict>();
+            }
             throw ParseError("Unknown call to "s + method_name + "()"s);
         }
         return make_unique<ast::VariableValue>(std::move(names));
@@ -323,6 +355,24 @@ private:
                                         std::move(else_body));
     }
 
+    // Loop -> for Id in LogicalExpr: Suite
+    unique_ptr<ast::Statement> ParseLoop()  // NOLINT
+    {
+        lexer_.Expect<TokenType::For>();
+        string var = lexer_.ExpectNext<TokenType::Id>().value;
+        lexer_.ExpectNext<TokenType::In>();
+        lexer_.NextToken();
+
+        auto iterable = ParseTest();
+
+        lexer_.Expect<TokenType::Char>(':');
+        lexer_.NextToken();
+
+        auto body = ParseSuite();
+
+        return make_unique<ast::ForIn>(std::move(var), std::move(iterable), std::move(body));
+    }
+
     // LogicalExpr -> AndTest [OR AndTest]
     // AndTest -> NotTest [AND NotTest]
     // NotTest -> [NOT] NotTest
@@ -365,33 +415,33 @@ private:
 
         if (tok == '<') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Less, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::LESS,
+                                                std::move(result), ParseExpression());
         }
         if (tok == '>') {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Greater, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::GREATER,
+                                                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::Eq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::Equal, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::EQUAL,
+                                                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::NotEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::NotEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::NOT_EQUAL,
+                                                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::LessOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::LessOrEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::LESS_OR_EQUAL,
+                                                std::move(result), ParseExpression());
         }
         if (tok.Is<TokenType::GreaterOrEq>()) {
             lexer_.NextToken();
-            return make_unique<ast::Comparison>(runtime::GreaterOrEqual, std::move(result),
-                                                ParseExpression());
+            return make_unique<ast::Comparison>(runtime::CompareOperation::GREATER_OR_EQUAL,
+                                                std::move(result), ParseExpression());
         }
         return result;
     }
@@ -399,6 +449,7 @@ private:
     // Statement -> SimpleStatement Newline
     //           | class ClassDefinition
     //           | if Condition
+    //           | for Loop
     unique_ptr<ast::Statement> ParseStatement()  // NOLINT
     {
         const auto& tok = lexer_.CurrentToken();
@@ -410,6 +461,9 @@ private:
         if (tok.Is<TokenType::If>()) {
             return ParseCondition();
         }
+        if (tok.Is<TokenType::For>()) {
+            return ParseLoop();
+        }
         auto result = ParseSimpleStatement();
         lexer_.Expect<TokenType::Newline>();
         lexer_.NextToken();
@@ -1,8 +1,12 @@
+#include "cpp_emitter.h"
+#include "ir.h"
+#include "jit.h"
 #include "lexer.h"
 #include "parse.h"
 #include "runtime.h"
 #include "statement.h"
 #include "test_runner_p.h"
+#include "type_inference.h"
 
 #include <iostream>
 
@@ -12,13 +16,19 @@ void TestParseProgram(TestRunner& tr);
 
 namespace {
 
-void RunMythonProgram(istream& input, ostream& output) {
+void RunMythonProgram(istream& input, ostream& output, bool compile = false) {
     parse::Lexer lexer(input);
     auto program = ParseProgram(lexer);
+    ast::OptimizeProgram(*program);
+    ast::InferTypes(*program);
 
     runtime::SimpleContext context{output};
     runtime::Closure closure;
-    program->Execute(closure, context);
+    if (compile) {
+        program->Compile()(closure, context);
+    } else {
+        program->Execute(closure, context);
+    }
 }
 
 void TestSimplePrints() {
@@ -99,6 +109,912 @@ print y.value
     ASSERT_EQUAL(output.str(), "2\n3\n");
 }
 
+void TestDict() {
+    istringstream input(R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __hash__():
+    return self.x * 31 + self.y
+
+  def __eq__(rhs):
+    return self.x == rhs.x and self.y == rhs.y
+
+names = dict()
+names.set(Point(1, 2), 'a')
+names.set(Point(3, 4), 'b')
+names.set(Point(1, 2), 'c')
+names.set(5, 'five')
+print names.len(), names.get(Point(1, 2)), names.get(5), names.get('5')
+print names.contains(Point(3, 4)), names.remove(Point(3, 4)), names.contains(Point(3, 4))
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "3 c five None\nTrue True False\n");
+
+    // A dictionary containing itself is printed as {...} where it is reached again
+    istringstream cyclic_input(R"(
+d = dict()
+d.set(1, d)
+print d
+print str(d)
+)");
+    ostringstream cyclic_output;
+    RunMythonProgram(cyclic_input, cyclic_output);
+    ASSERT_EQUAL(cyclic_output.str(), "{1: {...}}\n{1: {...}}\n");
+}
+
+void TestForLoop() {
+    istringstream input(R"(
+class Countdown:
+  def __init__(n):
+    self.n = n
+
+  def __iter__():
+    return self
+
+  def __next__():
+    if self.n == 0:
+      return None
+    self.n = self.n - 1
+    return self.n + 1
+
+class Finder:
+  def first_above(limit):
+    for i in range(100):
+      if i > limit:
+        return i
+    return None
+
+total = 0
+for i in range(1, 5):
+  total = total + i
+print total, i
+for i in range(3, 1):
+  print 'never'
+
+squares = dict()
+for i in range(4):
+  squares.set(i, i * i)
+sum = 0
+for key in squares:
+  sum = sum + squares.get(key)
+print sum
+
+for x in Countdown(3):
+  print x
+finder = Finder()
+print finder.first_above(41), range(2, 7)
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "10 4\n14\n3\n2\n1\n42 range(2, 7)\n");
+}
+
+void TestStrings() {
+    istringstream input(R"(
+line = ''
+for i in range(5):
+  line = line + str(i) + ','
+print line, line == '0,1,2,3,4,', line < '1'
+
+ages = dict()
+ages.set('Ann', 31)
+print join(', ', range(3)), join('', ages), join('-', dict())
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "0,1,2,3,4, True True\n0, 1, 2 Ann \n");
+}
+
+void TestBigIntegers() {
+    istringstream input(R"(
+big = 9223372036854775807 + 1
+print big, big - 1, -9223372036854775807 - 1, big > 9223372036854775807
+
+factorial = 1
+for i in range(1, 31):
+  factorial = factorial * i
+print factorial, factorial / 1000000000000000000
+
+huge = 99999999999999999999
+print huge + 1, -huge, -9223372036854775808, huge / 33333333333333333333 == 3
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(),
+                 "9223372036854775808 9223372036854775807 -9223372036854775808 True\n"
+                 "265252859812191058636308480000000 265252859812191\n"
+                 "100000000000000000000 -99999999999999999999 -9223372036854775808 True\n");
+}
+
+void TestFloats() {
+    istringstream input(R"(
+x = 1.5
+print x * 2, x + 1, 7 / 2, 7 / 2.0, -x, 0.1 + 0.2
+print x > 1, x == 1.5, 1e3, str(2.5)
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "3.0 2.5 3 3.5 -1.5 0.30000000000000004\nTrue True 1000.0 2.5\n");
+}
+
+void TestMethodFrames() {
+    istringstream input(R"(
+class Math:
+  def fact(n):
+    if n < 2:
+      return 1
+    return n * self.fact(n - 1)
+
+  def first_above(limit, items):
+    for x in items:
+      if x > limit:
+        return x
+    return None
+
+  def local(flag):
+    if flag:
+      y = 1
+    return y
+
+m = Math()
+print m.fact(10), m.first_above(3, range(10)), m.first_above(30, range(10))
+print m.local(True)
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+    ASSERT_EQUAL(output.str(), "3628800 4 None\n1\n");
+
+
+    // a variable assigned by the previous call of the method is not visible in the next one
+    istringstream unbound_input(R"(
+class Math:
+  def local(flag):
+    if flag:
+      y = 1
+    return y
+
+m = Math()
+print m.local(True)
+print m.local(False)
+)");
+    ostringstream unbound_output;
+    ASSERT_THROWS(RunMythonProgram(unbound_input, unbound_output), std::runtime_error);
+    ASSERT_EQUAL(unbound_output.str(), "1\n");
+}
+
+void TestOperatorMethods() {
+    istringstream input(R"(
+class Amount:
+  def __init__(value):
+    self.value = value
+
+  def __add__(other):
+    return self.value + other.value
+
+  def __sub__(other):
+    return self.value - other.value
+
+  def __mul__(k):
+    return self.value * k
+
+  def __str__():
+    return str(self.value) + '$'
+
+class Price(Amount):
+  def __str__():
+    return 'price ' + str(self.value)
+
+a = Price(10)
+b = Amount(4)
+print a, b, a + b, a - b, b * 3
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+    ASSERT_EQUAL(output.str(), "price 10 4$ 14 6 12\n");
+}
+
+void TestRichComparison() {
+    istringstream input(R"(
+class Loose:
+  def __init__(value):
+    self.value = value
+
+  def __lt__(other):
+    print 'lt'
+    return self.value < other.value
+
+  def __eq__(other):
+    print 'eq'
+    return self.value == other.value
+
+class Strict(Loose):
+  def __gt__(other):
+    print 'gt'
+    return self.value > other.value
+
+  def __le__(other):
+    print 'le'
+    return self.value <= other.value
+
+  def __ge__(other):
+    print 'ge'
+    return self.value >= other.value
+
+a = Loose(3)
+b = Loose(2)
+x = a > b
+c = Strict(1)
+y = c > b
+z = c <= b
+w = c >= b
+print x, y, z, w
+print 'abc' > 'abd', 2 >= 2, 1.5 <= 1
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+    ASSERT_EQUAL(output.str(), "lt\neq\ngt\nle\nge\nTrue False True False\nFalse True False\n");
+}
+
+void TestInstancesAreDistinct() {
+    istringstream input(R"(
+class Box:
+  def __init__(value):
+    self.value = value
+
+boxes = dict()
+for i in range(3):
+  boxes.set(i, Box(i * 10))
+for i in range(3):
+  box = boxes.get(i)
+  print box.value
+)");
+
+    ostringstream output;
+    RunMythonProgram(input, output);
+
+    ASSERT_EQUAL(output.str(), "0\n10\n20\n");
+}
+
+void TestClosureCompilation() {
+    const string program = R"(
+class Shape:
+  def __init__(name):
+    self.name = name
+
+  def __str__():
+    return 'Shape ' + self.name
+
+class Rect(Shape):
+  def __init__(w, h):
+    self.name = 'rect'
+    self.w = w
+    self.h = h
+
+  def area():
+    return self.w * self.h
+
+  def grow(by):
+    self.w = self.w + by
+    return self
+
+  def __lt__(other):
+    return self.area() < other.area()
+
+  def fact(n):
+    if n < 2:
+      return 1
+    return n * self.fact(n - 1)
+
+  def find(limit):
+    for i in range(100):
+      if i * i > limit:
+        return i
+    return None
+
+a = Rect(2, 3)
+b = Rect(3, 3)
+print a, a.area(), a < b, b < a, a.fact(20) * 100, a.find(50), a.find(100000)
+c = a.grow(5)
+print c.w, a.w, a.area() / 4, 7 - a.h, not a < b, a < b and True, False or a.w > 6
+words = dict()
+line = ''
+for i in range(3, 6):
+  words.set(i, str(i * 1.5))
+  line = line + str(i)
+print line, join('-', words), join(':', range(4)), 'x' + str(None)
+)";
+
+    istringstream tree_input(program);
+    ostringstream tree_output;
+    RunMythonProgram(tree_input, tree_output);
+
+    istringstream compiled_input(program);
+    ostringstream compiled_output;
+    RunMythonProgram(compiled_input, compiled_output, true);
+
+    ASSERT_EQUAL(compiled_output.str(), tree_output.str());
+    ASSERT_EQUAL(compiled_output.str(),
+                 "Shape rect 6 True False 243290200817664000000 8 None\n"
+                 "7 7 5 4 True False True\n"
+                 "345 3-4-5 0:1:2:3 xNone\n");
+
+    istringstream error_input("x = 1\nprint x + 'a'\n");
+    ostringstream error_output;
+    ASSERT_THROWS(RunMythonProgram(error_input, error_output, true), std::runtime_error);
+}
+
+void TestTiering() {
+    // the method is lowered in the middle of a recursion and of a loop with a return inside
+    istringstream input(R"(
+class Math:
+  def sum(n):
+    if n < 1:
+      return 0
+    return n + self.sum(n - 1)
+
+  def first_above(limit):
+    for i in range(limit + 10):
+      if i > limit:
+        return i
+    return None
+
+m = Math()
+total = 0
+for i in range(8):
+  total = total + m.sum(i)
+for i in range(20):
+  total = total + m.first_above(i)
+print total
+)");
+
+    const auto threshold = ast::tiering.threshold;
+    const auto compiled_methods = ast::tiering.compiled_methods;
+    ast::tiering.threshold = 10;
+    ostringstream output;
+    RunMythonProgram(input, output);
+    ast::tiering.threshold = threshold;
+
+    ASSERT_EQUAL(output.str(), "294\n");
+    ASSERT_EQUAL(ast::tiering.compiled_methods, compiled_methods + 2);
+}
+
+void TestTailCalls() {
+    const string program = R"(
+class Node:
+  def __init__(value, next):
+    self.value = value
+    self.next = next
+
+  def sum(acc):
+    if self.value == 0:
+      return acc
+    next = self.next
+    return next.sum(acc + self.value)
+
+class Math:
+  def sum(n, acc):
+    if n < 1:
+      return acc
+    return self.sum(n - 1, acc + n)
+
+  def local(n):
+    if n == 2:
+      y = 1
+    if n == 0:
+      return y
+    return self.local(n - 1)
+
+  def first_even(n):
+    for i in range(n, n + 2):
+      if i / 2 * 2 == i:
+        return i
+      return self.first_even(i + 1)
+
+m = Math()
+chain = None
+for i in range(5):
+  chain = Node(i, chain)
+print m.sum(100000, 0), chain.sum(0), m.first_even(7)
+print m.local(3)
+)";
+
+    for (bool compile : {false, true}) {
+        istringstream input(program);
+        ostringstream output;
+        // the variable assigned by the previous call is not visible in the tail call
+        ASSERT_THROWS(RunMythonProgram(input, output, compile), std::runtime_error);
+        ASSERT_EQUAL(output.str(), "5000050000 10 8\n");
+    }
+}
+
+void TestJit() {
+    const string program = R"(
+class Point:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+
+  def __str__():
+    return '(' + str(self.x) + ', ' + str(self.y) + ')'
+
+class Math:
+  def fib(n):
+    if n < 2:
+      return n
+    return self.fib(n - 1) + self.fib(n - 2)
+
+  def sum(n, acc):
+    if n < 1:
+      return acc
+    return self.sum(n - 1, acc + n)
+
+  def power(base, n):
+    if n == 0:
+      return 1
+    return base * self.power(base, n - 1)
+
+  def moved(p, dx):
+    q = Point(p.x + dx, p.y)
+    q.y = q.y - dx
+    return q
+
+  def noisy(s):
+    print 'noisy', s
+    return s
+
+  def check(a, b):
+    return a < b and not a == 0 or b > 100
+
+m = Math()
+print m.fib(15), m.sum(100000, 0), m.power(3, 45), m.power(2, 70)
+print m.moved(Point(1, 2), 3), m.moved(Point(10, 20), 0 - 5)
+print m.noisy('first'), m.noisy('second')
+print m.check(1, 2), m.check(0, 2), m.check(5, 200), m.check(5, 2)
+)";
+    const string errors[] = {R"(
+class Math:
+  def div(a, b):
+    return a / b
+
+print Math().div(6, 3)
+print Math().div(1, 0)
+)",
+                             R"(
+class Math:
+  def local(n):
+    if n == 2:
+      y = 1
+    if n == 0:
+      return y
+    return self.local(n - 1)
+
+print Math().local(3)
+)"};
+
+    const auto run = [](const string& text, bool enabled, string& error) {
+        istringstream input(text);
+        ostringstream output;
+        ast::jit.enabled = enabled;
+        try {
+            RunMythonProgram(input, output);
+        } catch (const std::runtime_error& e) {
+            error = e.what();
+        }
+        return output.str();
+    };
+
+    const auto threshold = ast::tiering.threshold;
+    const auto enabled = ast::jit.enabled;
+    const auto compiled_methods = ast::jit.compiled_methods;
+    ast::tiering.threshold = 1;
+    string error;
+    const string expected = run(program, false, error);
+    ASSERT(error.empty());
+    ASSERT_EQUAL(run(program, true, error), expected);
+    ASSERT(error.empty());
+    for (const auto& text : errors) {
+        string expected_error;
+        const string output = run(text, false, expected_error);
+        string actual_error;
+        ASSERT_EQUAL(run(text, true, actual_error), output);
+        ASSERT(!expected_error.empty());
+        ASSERT_EQUAL(actual_error, expected_error);
+    }
+    ast::tiering.threshold = threshold;
+    ast::jit.enabled = enabled;
+
+    ASSERT_EQUAL(expected, "610 5000050000 2954312706550833698643 1180591620717411303424\n"
+                           "(4, -1) (5, 25)\nnoisy first\nfirst noisy second\nsecond\n"
+                           "True False True False\n");
+    if (ast::IsJitSupported()) {
+        ASSERT(ast::jit.compiled_methods > compiled_methods);
+    }
+}
+
+void TestEmitCpp() {
+    istringstream input(R"(
+class Counter:
+  def __init__(start):
+    self.value = start
+
+  def first_above(limit):
+    for i in range(limit + 10):
+      if i > limit:
+        return i
+    return None
+
+class Named(Counter):
+  def __str__():
+    return 'Named "' + str(self.value) + '"'
+
+c = Named(2)
+c.value = c.value * 3 - 1
+print c, c.first_above(c.value) / 2.5, not c.value < 4 or False
+n = 6 * 7
+k = 42
+if k > 40:
+  print n
+)");
+    parse::Lexer lexer(input);
+    auto program = ParseProgram(lexer);
+    ast::InferTypes(*program);
+    ostringstream output;
+    ast::EmitCpp(*program, output);
+    const string code = output.str();
+
+    // the methods become functions of self and the parameters, which the classes are created
+    // with, and the variables become C++ variables
+    ASSERT(code.find("ObjectHolder Class0_first_above(ObjectHolder v_self, ObjectHolder v_limit, "
+                     "Context& context) {"s)
+           != string::npos);
+    ASSERT(code.find("std::make_unique<NativeBody>(Entry0_first_above)"s) != string::npos);
+    ASSERT(code.find("return runtime::Class(\"Named\"s, std::move(methods), &Class0());"s)
+           != string::npos);
+    ASSERT(code.find("closure["s) == string::npos);
+    // c holds only instances of Named, which doesn't override the methods of Counter
+    ASSERT(code.find("CallResolved([&] { return Class0___init__(t"s) != string::npos);
+    ASSERT(code.find("CallResolved([&] { return Class0_first_above(v_c, "s) != string::npos);
+    ASSERT(code.find("ast::MultiplyObjects("s) != string::npos);
+    ASSERT(code.find("runtime::CompareOperation::LESS, "s) != string::npos);
+    // the operations on the numbers proven by the type inference
+    ASSERT(code.find("NumberArithmetic<runtime::ArithmeticOperation::MULT>("s) != string::npos);
+    ASSERT(code.find("if (NumberOf(v_k) > NumberOf("s) != string::npos);
+    // the return inside the loop stops the iteration and is returned after it
+    ASSERT(code.find("returning = true;"s) != string::npos);
+    ASSERT(code.find("runtime::String constant_"s) != string::npos);
+    ASSERT(code.find("{\"Named \\\"\"s};"s) != string::npos);
+    ASSERT(code.find("int main() {"s) != string::npos);
+}
+
+void TestCallDepth() {
+    const string program = R"(
+class Rec:
+  def sum(n):
+    if n == 0:
+      return 0
+    return n + self.sum(n - 1)
+
+r = Rec()
+print r.sum(20)
+print r.sum(50)
+)";
+
+    const size_t max_depth = runtime::call_stack.GetMaxDepth();
+    runtime::call_stack.SetMaxDepth(30);
+    for (bool compile : {false, true}) {
+        istringstream input(program);
+        ostringstream output;
+        ASSERT_THROWS(RunMythonProgram(input, output, compile), std::runtime_error);
+        ASSERT_EQUAL(output.str(), "210\n");
+        // the calls unwound by the exception have left
+        ASSERT_EQUAL(runtime::call_stack.GetDepth(), 0U);
+    }
+    runtime::call_stack.SetMaxDepth(max_depth);
+    ASSERT(runtime::call_stack.GetDeepest() >= 30U);
+
+    // The calls deeper than the native stack allows continue on the segments
+    istringstream deep_input(program + "print r.sum(30000)\n"s);
+    ostringstream deep_output;
+    RunMythonProgram(deep_input, deep_output);
+    ASSERT_EQUAL(deep_output.str(), "210\n1275\n450015000\n"s);
+    ASSERT(runtime::call_stack.GetSegmentCount() > 0U);
+}
+
+void TestMemoization() {
+    const string program = R"(
+class Math:
+  def fib(n):
+    if n < 2:
+      return n
+    return self.fib(n - 1) + self.fib(n - 2)
+
+  def twice(s):
+    return self.step(s) + self.step(s)
+
+  def step(s):
+    return s + "a"
+
+  def printed(n):
+    print "call", n
+    return n
+
+class Counter(Math):
+  def __init__():
+    self.count = 0
+
+  def next():
+    self.count = self.count + 1
+    return self.count
+
+  def step(s):
+    return s + "b"
+
+m = Math()
+c = Counter()
+print m.fib(30), m.twice("x"), c.twice("x"), m.twice("x")
+print m.printed(1), m.printed(1), c.next(), c.next()
+)";
+    const string expected = "832040 xaxa xbxb xaxa\ncall 1\n1 call 1\n1 1 2\n"s;
+
+    runtime::memoization.enabled = true;
+    for (bool compile : {false, true}) {
+        const auto hits = runtime::memoization.hits;
+        istringstream input(program);
+        ostringstream output;
+        RunMythonProgram(input, output, compile);
+        ASSERT_EQUAL(output.str(), expected);
+        // fib(30) is called once for each of 31 arguments, the other 28 calls hit
+        ASSERT(runtime::memoization.hits - hits >= 28U);
+    }
+    runtime::memoization.enabled = false;
+}
+
+void TestInlining() {
+    const string program = R"(
+class Rect:
+  def __init__(w, h):
+    self.w = w
+    self.h = h
+
+  def area():
+    return self.w * self.h
+
+  def scaled(k):
+    return self.w * k
+
+class Square(Rect):
+  def __init__(side):
+    self.w = side
+    self.h = side
+
+  def area():
+    return self.w * self.w + 0
+
+  def scaled(k):
+    print "scaled", k
+    return self.w * k
+
+r = Rect(2, 3)
+s = Square(4)
+total = 0
+for i in range(3):
+  total = total + r.area() + r.scaled(i)
+  r.w = r.w + 1
+  r = s
+print total, r.area()
+)";
+
+    // the tree backend gives the expected output
+    string expected;
+    {
+        istringstream input(program);
+        ostringstream output;
+        RunMythonProgram(input, output);
+        expected = output.str();
+    }
+    ASSERT_EQUAL(expected, "scaled 1\nscaled 2\n61 36\n"s);
+
+    const auto inlined_calls = ast::inlining.inlined_calls;
+    istringstream input(program);
+    ostringstream output;
+    RunMythonProgram(input, output, true);
+    ASSERT_EQUAL(output.str(), expected);
+    // Rect.area, Rect.scaled and Square.area are inlined, Square.scaled prints
+    ASSERT_EQUAL(ast::inlining.inlined_calls - inlined_calls, 5U);
+}
+
+void TestTypeInference() {
+    const string program = R"(
+class Person:
+  def __init__(name):
+    self.name = "Mr "
+    self.title = name
+
+  def greet(n):
+    s = self.name + "X"
+    if n < 2:
+      s = s + "!"
+    return s
+
+p = Person("Smith")
+x = 1
+big = 3037000500 * 3037000500
+for i in range(4):
+  if i < 2:
+    print p.greet(i), x, big
+  x = "s"
+print x == "s", i - 1
+)";
+
+    // x == "s" is not proven, as x is a number on entry to the loop; n < 2 is not, as n is
+    // a parameter. The multiplication is proven and must still overflow into a big integer
+    const auto proven = ast::quickening_stats.proven;
+    istringstream input(program);
+    ostringstream output;
+    RunMythonProgram(input, output);
+    ASSERT_EQUAL(output.str(),
+                 "Mr X! 1 9223372037000250000\nMr X! s 9223372037000250000\n"
+                 "True 2\n"s);
+    ASSERT(ast::quickening_stats.proven > proven);
+}
+
+void TestMidLevelIr() {
+    const string program = R"(
+class Point:
+  def __init__(x):
+    self.x = x
+
+  def bump():
+    self.x = self.x + 1
+
+  def twice(other):
+    a = self.x + self.x
+    other.bump()
+    b = self.x * self.x
+    c = a
+    return c + b
+
+  def early():
+    return self.x
+    print "unreachable"
+
+k = 2
+m = k * 10 + 1
+if k < 0:
+  m = 1 / 0
+p = Point(3)
+q = p
+print m, "a" + str(m), p.twice(q), q.x + p.x, p.early()
+)";
+
+    const auto changes = [](string_view pass) -> uint64_t {
+        for (const auto& stats : ast::ir_stats.passes) {
+            if (stats.name == pass) {
+                return stats.changes;
+            }
+        }
+        return 0;
+    };
+    // self.x is read again after other.bump(), which may have assigned it
+    const string expected = "21 a21 22 8 4\n"s;
+    for (const bool compile : {false, true}) {
+        const uint64_t before[] = {changes("constprop"sv), changes("copyprop"sv),
+                                   changes("cse"sv), changes("dce"sv)};
+        istringstream input(program);
+        ostringstream output;
+        RunMythonProgram(input, output, compile);
+        ASSERT_EQUAL(output.str(), expected);
+        ASSERT(changes("constprop"sv) > before[0]);
+        ASSERT(changes("copyprop"sv) > before[1]);
+        ASSERT(changes("cse"sv) > before[2]);
+        ASSERT(changes("dce"sv) > before[3]);
+    }
+
+    // The paths join two different constants, which are equal as numbers
+    const string signed_zero = R"(
+c = True
+x = 0.0
+if c:
+  x = 0.0 * (0 - 1.0)
+print x
+)";
+    for (const bool compile : {false, true}) {
+        istringstream input(signed_zero);
+        ostringstream output;
+        RunMythonProgram(input, output, compile);
+        ASSERT_EQUAL(output.str(), "-0.0\n"s);
+    }
+
+    // The reads of the field are not moved in front of the arguments printed before them
+    const string unset_field = R"(
+class A:
+  def __init__():
+    self.y = 1
+
+a = A()
+print 1, a.x, a.x
+)";
+    for (const bool compile : {false, true}) {
+        istringstream input(unset_field);
+        ostringstream output;
+        ASSERT_THROWS(RunMythonProgram(input, output, compile), std::runtime_error);
+        ASSERT_EQUAL(output.str(), "1 "s);
+    }
+
+    // A field read again after printing an instance is loaded again: __str__ may assign it
+    const string str_assigns = R"(
+class A:
+  def __init__():
+    self.x = 1
+  def __str__():
+    self.x = 2
+    return "a"
+
+a = A()
+print a.x, a, a.x
+)";
+    for (const bool compile : {false, true}) {
+        istringstream input(str_assigns);
+        ostringstream output;
+        RunMythonProgram(input, output, compile);
+        ASSERT_EQUAL(output.str(), "1 a 2\n"s);
+    }
+
+    // A field read before a loop over a user iterator is loaded again in it: __next__ assigns it
+    const string user_iterator = R"(
+class It:
+  def __init__():
+    self.n = 0
+
+  def __iter__():
+    return self
+
+  def __next__():
+    if self.n == 3:
+      return None
+    self.n = self.n + 1
+    return self.n
+
+it = It()
+a = it.n
+for i in it:
+  b = it.n
+c = b
+print a, c
+)";
+    for (const bool compile : {false, true}) {
+        istringstream input(user_iterator);
+        ostringstream output;
+        RunMythonProgram(input, output, compile);
+        ASSERT_EQUAL(output.str(), "0 3\n"s);
+    }
+
+    // The constants of the IR and the values folded ahead are not allocations of the program
+    const auto allocated = runtime::allocation_stats.allocated;
+    istringstream literals_input("print \"a\", 1.5, \"b\" + \"c\"\n"s);
+    ostringstream literals_output;
+    RunMythonProgram(literals_input, literals_output);
+    ASSERT_EQUAL(literals_output.str(), "a 1.5 bc\n"s);
+    ASSERT_EQUAL(runtime::allocation_stats.allocated, allocated);
+}
+
 void TestAll() {
     TestRunner tr;
     TestParseProgram(tr);
@@ -107,6 +1023,25 @@ void TestAll() {
     RUN_TEST(tr, TestAssignments);
     RUN_TEST(tr, TestArithmetics);
     RUN_TEST(tr, TestVariablesArePointers);
+    RUN_TEST(tr, TestDict);
+    RUN_TEST(tr, TestForLoop);
+    RUN_TEST(tr, TestStrings);
+    RUN_TEST(tr, TestBigIntegers);
+    RUN_TEST(tr, TestFloats);
+    RUN_TEST(tr, TestMethodFrames);
+    RUN_TEST(tr, TestOperatorMethods);
+    RUN_TEST(tr, TestRichComparison);
+    RUN_TEST(tr, TestInstancesAreDistinct);
+    RUN_TEST(tr, TestClosureCompilation);
+    RUN_TEST(tr, TestTiering);
+    RUN_TEST(tr, TestEmitCpp);
+    RUN_TEST(tr, TestTailCalls);
+    RUN_TEST(tr, TestJit);
+    RUN_TEST(tr, TestCallDepth);
+    RUN_TEST(tr, TestMemoization);
+    RUN_TEST(tr, TestInlining);
+    RUN_TEST(tr, TestTypeInference);
+    RUN_TEST(tr, TestMidLevelIr);
 }
 
 }  // namespace
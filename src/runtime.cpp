@@ -1,57 +1,185 @@
 #include "runtime.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <optional>
+#include <typeinfo>
+
+#if defined(__GLIBC__)
+#include <pthread.h>
+#endif
+
+#if defined(__linux__) && __has_include(<ucontext.h>)
+#include <ucontext.h>
+#define MYTHON_STACK_SEGMENTS
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define MYTHON_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MYTHON_ASAN
+#endif
+#endif
+
+#if defined(MYTHON_ASAN)
+#include <sanitizer/common_interface_defs.h>
+#endif
 
 using namespace std;
 
 namespace {
-const string STR_METHOD = "__str__"s;
-const string EQ_METHOD = "__eq__"s;
-const string LESS_METHOD = "__lt__"s;
+const array<string, static_cast<size_t>(runtime::SpecialMethod::COUNT)> SPECIAL_METHOD_NAMES = {
+    "__init__"s, "__str__"s, "__eq__"s, "__lt__"s, "__gt__"s, "__le__"s, "__ge__"s,
+    "__hash__"s, "__add__"s, "__sub__"s, "__mul__"s, "__iter__"s, "__next__"s,
+};
+const string EMPTY_OBJECT = "None"s;
 
-template<class BinaryPredicate>
-bool Comp(const runtime::ObjectHolder &lhs, const runtime::ObjectHolder &rhs, BinaryPredicate pred) {
-    {
-        auto l = lhs.TryAs<runtime::Bool>();
-        auto r = rhs.TryAs<runtime::Bool>();
-        if (l && r) {
-            return pred(l->GetValue(), r->GetValue());
-        }
+// Spreads the bits of a hash over the whole word, so that both the group index
+// (high bits) and the control byte (low 7 bits) are well distributed
+size_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return static_cast<size_t>(hash);
+}
+
+using runtime::GetKind;
+using runtime::ValueKind;
+
+// The object must be of the type T
+template <typename T>
+const T& CastTo(const runtime::ObjectHolder& object) {
+    return static_cast<const T&>(*object.Get());
+}
+
+// Returns the value of a number of any type as double
+std::optional<double> ToDouble(const runtime::ObjectHolder& object) {
+    switch (GetKind(object)) {
+        case ValueKind::NUMBER:
+            return static_cast<double>(CastTo<runtime::Number>(object).GetValue());
+        case ValueKind::BIG_INT:
+            return CastTo<runtime::BigInt>(object).GetValue().ToDouble();
+        case ValueKind::FLOAT:
+            return CastTo<runtime::Float>(object).GetValue();
+        default:
+            return std::nullopt;
     }
+}
 
-    {
-        auto l = lhs.TryAs<runtime::Number>();
-        auto r = rhs.TryAs<runtime::Number>();
-        if (l && r) {
-            return pred(l->GetValue(), r->GetValue());
-        }
+// Returns the value of an integer of any size, the object must be a Number or a BigInt
+runtime::BigInteger ToBigInteger(const runtime::ObjectHolder& object) {
+    if (GetKind(object) == ValueKind::NUMBER) {
+        return CastTo<runtime::Number>(object).GetValue();
     }
+    return CastTo<runtime::BigInt>(object).GetValue();
+}
 
-    {
-        auto l = lhs.TryAs<runtime::String>();
-        auto r = rhs.TryAs<runtime::String>();
-        if (l && r) {
-            return pred(l->GetValue(), r->GetValue());
-        }
+// How the values of two kinds are compared: converted to the common type or not at all
+enum class ComparisonKind { NONE, BOOL, NUMBER, BIG_INT, FLOAT, STRING };
+
+constexpr size_t VALUE_KIND_COUNT = static_cast<size_t>(ValueKind::COUNT);
+
+constexpr auto COMPARISON_TABLE = [] {
+    std::array<std::array<ComparisonKind, VALUE_KIND_COUNT>, VALUE_KIND_COUNT> table{};
+    auto set = [&table](ValueKind lhs, ValueKind rhs, ComparisonKind kind) {
+        table[static_cast<size_t>(lhs)][static_cast<size_t>(rhs)] = kind;
+        table[static_cast<size_t>(rhs)][static_cast<size_t>(lhs)] = kind;
+    };
+    set(ValueKind::BOOL, ValueKind::BOOL, ComparisonKind::BOOL);
+    set(ValueKind::NUMBER, ValueKind::NUMBER, ComparisonKind::NUMBER);
+    set(ValueKind::STRING, ValueKind::STRING, ComparisonKind::STRING);
+    set(ValueKind::NUMBER, ValueKind::BIG_INT, ComparisonKind::BIG_INT);
+    set(ValueKind::BIG_INT, ValueKind::BIG_INT, ComparisonKind::BIG_INT);
+    set(ValueKind::FLOAT, ValueKind::FLOAT, ComparisonKind::FLOAT);
+    set(ValueKind::FLOAT, ValueKind::NUMBER, ComparisonKind::FLOAT);
+    set(ValueKind::FLOAT, ValueKind::BIG_INT, ComparisonKind::FLOAT);
+    return table;
+}();
+
+// Result of a three-way comparison. Only NaN is unordered
+enum class Ordering { LESS, EQUAL, GREATER, UNORDERED };
+
+template <typename T>
+Ordering OrderOf(const T& lhs, const T& rhs) {
+    if (lhs < rhs) {
+        return Ordering::LESS;
     }
-    throw std::runtime_error("Cannot compare objects"s);
+    if (rhs < lhs) {
+        return Ordering::GREATER;
+    }
+    return lhs == rhs ? Ordering::EQUAL : Ordering::UNORDERED;
 }
-}  // namespace
 
-namespace runtime {
+Ordering OrderOf(int compare_result) {
+    if (compare_result == 0) {
+        return Ordering::EQUAL;
+    }
+    return compare_result < 0 ? Ordering::LESS : Ordering::GREATER;
+}
+
+// Compares two values of the builtin types in three ways.
+// Returns nullopt if the values are not comparable natively
+std::optional<Ordering> Comp(const runtime::ObjectHolder &lhs, const runtime::ObjectHolder &rhs) {
+    const auto lhs_kind = static_cast<size_t>(GetKind(lhs));
+    const auto rhs_kind = static_cast<size_t>(GetKind(rhs));
+    switch (COMPARISON_TABLE[lhs_kind][rhs_kind]) {
+        case ComparisonKind::BOOL:
+            return OrderOf(CastTo<runtime::Bool>(lhs).GetValue(), CastTo<runtime::Bool>(rhs).GetValue());
+        case ComparisonKind::NUMBER:
+            return OrderOf(CastTo<runtime::Number>(lhs).GetValue(),
+                           CastTo<runtime::Number>(rhs).GetValue());
+        case ComparisonKind::STRING:
+            return OrderOf(CastTo<runtime::String>(lhs).GetValue().compare(
+                CastTo<runtime::String>(rhs).GetValue()));
+        case ComparisonKind::BIG_INT:
+            return OrderOf(ToBigInteger(lhs).Compare(ToBigInteger(rhs)));
+        case ComparisonKind::FLOAT:
+            return OrderOf(*ToDouble(lhs), *ToDouble(rhs));
+        case ComparisonKind::NONE:
+            break;
+    }
+    return std::nullopt;
+}
 
-ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
-    : data_(std::move(data)) {
+bool Satisfies(Ordering ordering, runtime::CompareOperation operation) {
+    using runtime::CompareOperation;
+    switch (operation) {
+        case CompareOperation::EQUAL:
+            return ordering == Ordering::EQUAL;
+        case CompareOperation::NOT_EQUAL:
+            return ordering != Ordering::EQUAL;
+        case CompareOperation::LESS:
+            return ordering == Ordering::LESS;
+        case CompareOperation::GREATER:
+            return ordering == Ordering::GREATER;
+        case CompareOperation::LESS_OR_EQUAL:
+            return ordering == Ordering::LESS || ordering == Ordering::EQUAL;
+        case CompareOperation::GREATER_OR_EQUAL:
+            return ordering == Ordering::GREATER || ordering == Ordering::EQUAL;
+    }
+    return false;
 }
+}  // namespace
+
+namespace runtime {
 
 void ObjectHolder::AssertIsValid() const {
     assert(data_ != nullptr);
 }
 
 ObjectHolder ObjectHolder::Share(Object& object) {
-    // Return a non-possessing shared_ptr (its deleter does nothing)
-    return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+    return ObjectHolder(&object);
 }
 
 ObjectHolder ObjectHolder::None() {
@@ -68,12 +196,380 @@ Object* ObjectHolder::operator->() const {
     return Get();
 }
 
-Object* ObjectHolder::Get() const {
-    return data_.get();
+namespace {
+// Size class allocator for the runtime objects
+class ObjectPool {
+public:
+    void* Allocate(size_t size) {
+        if (size > MAX_SIZE) {
+            return ::operator new(size);
+        }
+        const size_t size_class = (size + ALIGNMENT - 1) / ALIGNMENT;
+        if (FreeBlock* block = free_lists_[size_class]) {
+            free_lists_[size_class] = block->next;
+            return block;
+        }
+        const size_t bytes = size_class * ALIGNMENT;
+        if (current_ == nullptr || current_ + bytes > end_) {
+            chunks_.push_back(std::make_unique<std::byte[]>(CHUNK_SIZE));
+            current_ = chunks_.back().get();
+            end_ = current_ + CHUNK_SIZE;
+        }
+        void* result = current_;
+        current_ += bytes;
+        return result;
+    }
+
+    void Deallocate(void* ptr, size_t size) noexcept {
+        if (size > MAX_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+        const size_t size_class = (size + ALIGNMENT - 1) / ALIGNMENT;
+        auto block = static_cast<FreeBlock*>(ptr);
+        block->next = free_lists_[size_class];
+        free_lists_[size_class] = block;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t MAX_SIZE = 256;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    FreeBlock* free_lists_[MAX_SIZE / ALIGNMENT + 1] = {};
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::byte* current_ = nullptr;
+    std::byte* end_ = nullptr;
+};
+
+ObjectPool& GetObjectPool() {
+    // never destroyed: objects may still be released during the static destruction
+    static auto* pool = new ObjectPool;
+    return *pool;
+}
+}  // namespace
+
+void* Object::operator new(size_t size) {
+    return GetObjectPool().Allocate(size);
+}
+
+void Object::operator delete(void* ptr, size_t size) noexcept {
+    GetObjectPool().Deallocate(ptr, size);
+}
+
+Container::~Container() {
+    if (tracked_) {
+        heap.Untrack(*this);
+    }
+}
+
+void Heap::SetThreshold(size_t threshold) {
+    threshold_ = threshold;
+}
+
+size_t Heap::GetThreshold() const {
+    return threshold_;
+}
+
+void Heap::OnAllocation() {
+    if (threshold_ == 0 || ++allocations_ < threshold_ || collecting_) {
+        return;
+    }
+    if (++automatic_collections_ % MAJOR_COLLECTION_PERIOD == 0) {
+        Collect();
+    } else {
+        CollectYoung();
+    }
+}
+
+void Heap::Track(Container& container) {
+    container.tracked_ = true;
+    container.generation_ = YOUNG;
+    container.gc_prev_ = nullptr;
+    container.gc_next_ = heads_[YOUNG];
+    if (heads_[YOUNG] != nullptr) {
+        heads_[YOUNG]->gc_prev_ = &container;
+    }
+    heads_[YOUNG] = &container;
+    ++counts_[YOUNG];
+}
+
+void Heap::Untrack(Container& container) {
+    if (container.gc_prev_ != nullptr) {
+        container.gc_prev_->gc_next_ = container.gc_next_;
+    } else {
+        heads_[container.generation_] = container.gc_next_;
+    }
+    if (container.gc_next_ != nullptr) {
+        container.gc_next_->gc_prev_ = container.gc_prev_;
+    }
+    container.tracked_ = false;
+    container.gc_prev_ = container.gc_next_ = nullptr;
+    --counts_[container.generation_];
+}
+
+size_t Heap::Collect() {
+    return CollectGenerations(OLD);
+}
+
+size_t Heap::CollectYoung() {
+    return CollectGenerations(YOUNG);
+}
+
+size_t Heap::CollectGenerations(Generation oldest) {
+    const auto start = std::chrono::steady_clock::now();
+    collecting_ = true;
+    allocations_ = 0;
+
+    auto in_scope = [oldest](const ObjectHolder& object) -> Container* {
+        auto container = dynamic_cast<Container*>(object.Get());
+        return container != nullptr && container->tracked_ && container->generation_ <= oldest
+            ? container : nullptr;
+    };
+    auto for_each_container = [this, oldest](auto fn) {
+        for (int generation = YOUNG; generation <= oldest; ++generation) {
+            for (Container* c = heads_[generation]; c != nullptr; c = c->gc_next_) {
+                fn(c);
+            }
+        }
+    };
+
+    // subtract the references from the collected containers, what is left comes from outside
+    for_each_container([](Container* c) {
+        c->gc_refs_ = c->ref_count_;
+        c->reachable_ = false;
+    });
+    for_each_container([&in_scope](Container* c) {
+        c->ForEachReference([&in_scope](const ObjectHolder& object) {
+            if (auto referent = in_scope(object)) {
+                --referent->gc_refs_;
+            }
+        });
+    });
+
+    // mark everything reachable from the externally referenced containers
+    std::vector<Container*> stack;
+    for_each_container([&stack](Container* c) {
+        if (c->gc_refs_ > 0) {
+            c->reachable_ = true;
+            stack.push_back(c);
+        }
+    });
+    while (!stack.empty()) {
+        Container* c = stack.back();
+        stack.pop_back();
+        c->ForEachReference([&in_scope, &stack](const ObjectHolder& object) {
+            if (auto referent = in_scope(object); referent && !referent->reachable_) {
+                referent->reachable_ = true;
+                stack.push_back(referent);
+            }
+        });
+    }
+
+    // the holders keep the garbage alive until all the cycles are broken
+    std::vector<ObjectHolder> garbage;
+    for_each_container([&garbage](Container* c) {
+        if (!c->reachable_) {
+            garbage.push_back(ObjectHolder::Share(*c));
+        }
+    });
+    for (auto& object : garbage) {
+        static_cast<Container&>(*object).ClearReferences();
+    }
+    const size_t collected = garbage.size();
+    garbage.clear();
+
+    // the survivors of the young generation become old
+    stats_.promoted += counts_[YOUNG];
+    if (Container* young = heads_[YOUNG]) {
+        Container* last = young;
+        for (Container* c = young; c != nullptr; c = c->gc_next_) {
+            c->generation_ = OLD;
+            last = c;
+        }
+        last->gc_next_ = heads_[OLD];
+        if (heads_[OLD] != nullptr) {
+            heads_[OLD]->gc_prev_ = last;
+        }
+        heads_[OLD] = young;
+        counts_[OLD] += counts_[YOUNG];
+        heads_[YOUNG] = nullptr;
+        counts_[YOUNG] = 0;
+    }
+
+    collecting_ = false;
+    const std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+    if (oldest == YOUNG) {
+        ++stats_.minor_collections;
+        stats_.minor_pauses_ms.push_back(pause.count());
+    } else {
+        ++stats_.major_collections;
+    }
+    stats_.collected += collected;
+    stats_.total_pause_ms += pause.count();
+    stats_.max_pause_ms = std::max(stats_.max_pause_ms, pause.count());
+    return collected;
+}
+
+size_t Heap::GetTrackedCount() const {
+    return counts_[YOUNG] + counts_[OLD];
+}
+
+size_t Heap::GetYoungCount() const {
+    return counts_[YOUNG];
+}
+
+const Heap::Stats& Heap::GetStats() const {
+    return stats_;
+}
+
+double Heap::GetMinorPausePercentile(double percentile) const {
+    if (stats_.minor_pauses_ms.empty()) {
+        return 0;
+    }
+    auto pauses = stats_.minor_pauses_ms;
+    const auto index = static_cast<size_t>(percentile / 100 * static_cast<double>(pauses.size() - 1));
+    std::nth_element(pauses.begin(), pauses.begin() + index, pauses.end());
+    return pauses[index];
+}
+
+ObjectHolder MakeBool(bool value) {
+    // the canonical values are immortal, so sharing them costs no reference counting
+    static Bool true_object(true);
+    static Bool false_object(false);
+    return ObjectHolder::Share(value ? true_object : false_object);
+}
+
+ObjectHolder MakeNumber(int64_t value) {
+    static std::vector<Number> small_numbers = [] {
+        std::vector<Number> result;
+        result.reserve(SMALL_NUMBER_MAX - SMALL_NUMBER_MIN + 1);
+        for (int64_t i = SMALL_NUMBER_MIN; i <= SMALL_NUMBER_MAX; ++i) {
+            result.emplace_back(i);
+        }
+        return result;
+    }();
+    if (value >= SMALL_NUMBER_MIN && value <= SMALL_NUMBER_MAX) {
+        return ObjectHolder::Share(small_numbers[value - SMALL_NUMBER_MIN]);
+    }
+    return ObjectHolder::Own(Number(value));
+}
+
+ObjectHolder MakeInteger(const BigInteger& value) {
+    if (value.FitsInt64()) {
+        return MakeNumber(value.ToInt64());
+    }
+    return ObjectHolder::Own(BigInt(value));
+}
+
+ObjectHolder IntegerArithmetic(ArithmeticOperation operation, const ObjectHolder& lhs,
+                               const ObjectHolder& rhs) {
+    auto to_big_integer = [](const ObjectHolder& object) -> std::optional<BigInteger> {
+        if (auto number = object.TryAs<Number>()) {
+            return BigInteger(number->GetValue());
+        }
+        if (auto big = object.TryAs<BigInt>()) {
+            return big->GetValue();
+        }
+        return std::nullopt;
+    };
+
+    // fast path: the result fits into 64 bits
+    auto l = lhs.TryAs<Number>();
+    auto r = rhs.TryAs<Number>();
+    if (l && r) {
+        if (operation == ArithmeticOperation::DIV && r->GetValue() == 0) {
+            throw std::runtime_error("Division by zero"s);
+        }
+        if (int64_t result = 0; CheckedArithmetic(operation, l->GetValue(), r->GetValue(), result)) {
+            return MakeNumber(result);
+        }
+    }
+
+    auto left = to_big_integer(lhs);
+    auto right = to_big_integer(rhs);
+    if (!left || !right) {
+        return ObjectHolder::None();
+    }
+    switch (operation) {
+        case ArithmeticOperation::ADD:
+            return MakeInteger(*left + *right);
+        case ArithmeticOperation::SUB:
+            return MakeInteger(*left - *right);
+        case ArithmeticOperation::MULT:
+            return MakeInteger(*left * *right);
+        case ArithmeticOperation::DIV:
+            return MakeInteger(*left / *right);
+    }
+    return ObjectHolder::None();
+}
+
+ObjectHolder FloatArithmetic(ArithmeticOperation operation, const ObjectHolder& lhs,
+                             const ObjectHolder& rhs) {
+    if (!lhs.TryAs<Float>() && !rhs.TryAs<Float>()) {
+        return ObjectHolder::None();
+    }
+    auto left = ToDouble(lhs);
+    auto right = ToDouble(rhs);
+    if (!left || !right) {
+        return ObjectHolder::None();
+    }
+    switch (operation) {
+        case ArithmeticOperation::ADD:
+            return ObjectHolder::Own(Float(*left + *right));
+        case ArithmeticOperation::SUB:
+            return ObjectHolder::Own(Float(*left - *right));
+        case ArithmeticOperation::MULT:
+            return ObjectHolder::Own(Float(*left * *right));
+        case ArithmeticOperation::DIV:
+            if (*right == 0) {
+                throw std::runtime_error("Division by zero"s);
+            }
+            return ObjectHolder::Own(Float(*left / *right));
+    }
+    return ObjectHolder::None();
+}
+
+ValueKind GetKind(const ObjectHolder& object) {
+    if (!object) {
+        return ValueKind::OTHER;
+    }
+    // the value types have no subclasses, so the exact type is enough
+    const std::type_info& type = typeid(*object.Get());
+    if (type == typeid(Number)) {
+        return ValueKind::NUMBER;
+    }
+    if (type == typeid(String)) {
+        return ValueKind::STRING;
+    }
+    if (type == typeid(Bool)) {
+        return ValueKind::BOOL;
+    }
+    if (type == typeid(Float)) {
+        return ValueKind::FLOAT;
+    }
+    if (type == typeid(BigInt)) {
+        return ValueKind::BIG_INT;
+    }
+    return ValueKind::OTHER;
 }
 
-ObjectHolder::operator bool() const {
-    return Get() != nullptr;
+Compiled Executable::Compile() {
+    return [this](Closure& closure, Context& context) {
+        return Execute(closure, context);
+    };
+}
+
+bool Executable::IsPure([[maybe_unused]] const Class& cls) const {
+    return false;
+}
+
+size_t Executable::ExpressionSize() const {
+    return 0;
 }
 
 bool IsTrue(const ObjectHolder &object) {
@@ -86,12 +582,18 @@ bool IsTrue(const ObjectHolder &object) {
     if (auto obj = object.TryAs<String>()) {
         return !(obj->GetValue().empty());
     }
+    if (auto obj = object.TryAs<BigInt>()) {
+        return !obj->GetValue().IsZero();
+    }
+    if (auto obj = object.TryAs<Float>()) {
+        return obj->GetValue() != 0;
+    }
     return false;
 }
 
 void ClassInstance::Print(std::ostream &os, Context &context) {
-    if (HasMethod(STR_METHOD, 0U)) {
-        Call(STR_METHOD, {}, context)->Print(os, context);
+    if (HasMethod(SpecialMethod::STR, 0U)) {
+        Call(SpecialMethod::STR, nullptr, 0, context)->Print(os, context);
     } else {
         os << this;
     }
@@ -106,6 +608,11 @@ bool ClassInstance::HasMethod(const std::string &method, size_t argument_count)
     return false;
 }
 
+bool ClassInstance::HasMethod(SpecialMethod method, size_t argument_count) const {
+    auto mtd = cls_.GetMethod(method);
+    return mtd != nullptr && mtd->formal_params.size() == argument_count;
+}
+
 Closure& ClassInstance::Fields() {
     return closure_;
 }
@@ -117,28 +624,355 @@ const Closure& ClassInstance::Fields() const {
 ClassInstance::ClassInstance(const Class &cls) : cls_(cls) {
 }
 
+void ClassInstance::ForEachReference(const std::function<void(const ObjectHolder&)>& visit) const {
+    for (const auto& [name, value] : closure_) {
+        visit(value);
+    }
+}
+
+void ClassInstance::ClearReferences() {
+    // the fields may be freed while the closure is being cleared, so it is emptied first
+    Closure fields;
+    std::swap(fields, closure_);
+}
+
 ObjectHolder ClassInstance::Call(const std::string &method,
                                  const std::vector<ObjectHolder> &actual_args,
                                  Context& context) {
-    if (!HasMethod(method, actual_args.size())) {
-        throw std::runtime_error("No method "s + method +" in class "s + cls_.GetName()
-                                 + " with "s + std::to_string(actual_args.size()) + " arguments."s);
+    return Call(method, actual_args.data(), actual_args.size(), context);
+}
+
+ObjectHolder ClassInstance::Call(const std::string& method, const ObjectHolder* actual_args,
+                                 size_t count, Context& context) {
+    return CallMethod(cls_.GetMethod(method), method, actual_args, count, context);
+}
+
+ObjectHolder ClassInstance::Call(SpecialMethod method, const ObjectHolder* actual_args,
+                                 size_t count, Context& context) {
+    return CallMethod(cls_.GetMethod(method), GetSpecialMethodName(method), actual_args, count,
+                      context);
+}
+
+namespace {
+
+template <typename T>
+void AppendBytes(std::string& key, const T& value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    key.append(bytes, sizeof(T));
+}
+
+// Returns true if the result of a pure method is a value which can be cached
+bool IsMemoizable(const ObjectHolder& object) {
+    return !object || GetKind(object) != ValueKind::OTHER;
+}
+
+// Makes the key of the arguments of a memoized call: the kind of every argument
+// followed by its value. Returns false if an argument is not a value of the builtin kinds
+bool MakeMemoKey(const ObjectHolder* args, size_t count, std::string& key) {
+    for (size_t i = 0; i < count; ++i) {
+        const auto& arg = args[i];
+        if (!arg) {
+            key += 'N';
+            continue;
+        }
+        const auto kind = GetKind(arg);
+        key += static_cast<char>('0' + static_cast<int>(kind));
+        switch (kind) {
+            case ValueKind::BOOL:
+                key += CastTo<Bool>(arg).GetValue() ? '1' : '0';
+                break;
+            case ValueKind::NUMBER:
+                AppendBytes(key, CastTo<Number>(arg).GetValue());
+                break;
+            case ValueKind::BIG_INT:
+                key += CastTo<BigInt>(arg).GetValue().ToString();
+                key += ';';
+                break;
+            case ValueKind::FLOAT:
+                AppendBytes(key, CastTo<Float>(arg).GetValue());
+                break;
+            case ValueKind::STRING: {
+                const auto& value = CastTo<String>(arg).GetValue();
+                AppendBytes(key, value.size());
+                key += value;
+                break;
+            }
+            default:
+                return false;
+        }
     }
+    return true;
+}
 
-    auto mtd = cls_.GetMethod(method);
-    Closure args;
-    args["self"s] = ObjectHolder::Share(*this);
+}  // namespace
+
+const ObjectHolder* MethodResults::Find(std::string_view key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    results_.splice(results_.begin(), results_, it->second);
+    return &it->second->second;
+}
+
+void MethodResults::Insert(std::string key, ObjectHolder result) {
+    if (memoization.capacity == 0) {
+        return;
+    }
+    if (results_.size() >= memoization.capacity) {
+        index_.erase(results_.back().first);
+        results_.pop_back();
+        ++memoization.evictions;
+    }
+    results_.emplace_front(std::move(key), std::move(result));
+    index_.emplace(results_.front().first, results_.begin());
+}
+
+ObjectHolder ClassInstance::CallMethod(const Method* mtd, const std::string& name,
+                                       const ObjectHolder* actual_args, size_t count,
+                                       Context& context) {
+    if (mtd == nullptr || mtd->formal_params.size() != count) {
+        throw std::runtime_error("No method "s + name +" in class "s + cls_.GetName()
+                                 + " with "s + std::to_string(count) + " arguments."s);
+    }
+
+    // the results are kept in a list, so the pointer stays valid while the body is executed
+    MethodResults* results = nullptr;
+    std::string memo_key;
+    if (memoization.enabled) {
+        results = &mtd->ResultsFor(cls_);
+        if (!results->IsPure() || !MakeMemoKey(actual_args, count, memo_key)) {
+            results = nullptr;
+        } else if (const auto* result = results->Find(memo_key)) {
+            ++memoization.hits;
+            return *result;
+        } else {
+            ++memoization.misses;
+        }
+    }
+
+    call_stack.Enter();
+    // the arguments are copied before anything else runs: the pointer may refer to the value stack
+    auto frame = mtd->AcquireFrame();
+    *frame->self = ObjectHolder::Share(*this);
+    for (size_t i = 0; i < count; ++i) {
+        *frame->params[i] = actual_args[i];
+    }
+
+    try {
+        auto result = call_stack.Run([&] {
+            return mtd->body->Execute(frame->closure, context);
+        });
+        mtd->ReleaseFrame(std::move(frame));
+        call_stack.Leave();
+        if (results != nullptr && IsMemoizable(result)) {
+            results->Insert(std::move(memo_key), result);
+        }
+        return result;
+    }  catch (...) {
+        mtd->ReleaseFrame(std::move(frame));
+        call_stack.Leave();
+        throw;
+    }
+}
+
+void CallStack::ThrowTooDeep() const {
+    throw std::runtime_error("Maximum call depth of "s + std::to_string(max_depth_)
+                             + " exceeded"s);
+}
+
+void CallStack::ThrowOutOfStack() const {
+    throw std::runtime_error("Out of stack at the call depth of "s + std::to_string(depth_));
+}
+
+void CallStack::Measure() {
+    char marker = 0;
+    const auto address = reinterpret_cast<uintptr_t>(&marker);
+    if (depth_ == 1) {
+        if (address < stack_low_ || address >= stack_high_) {
+            FindStack(address);
+        }
+        top_ = address;
+    }
+    if (depth_ > 1) {
+        bytes_per_call_ = (used_below_ + (top_ > address ? top_ - address : 0)) / (depth_ - 1);
+    }
+    deepest_ = std::max(deepest_, depth_);
+}
+
+void CallStack::FindStack(uintptr_t address) {
+#if defined(__GLIBC__)
+    pthread_attr_t attributes;
+    void* low = nullptr;
+    size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+        pthread_attr_getstack(&attributes, &low, &size);
+        pthread_attr_destroy(&attributes);
+    }
+    if (low != nullptr && reinterpret_cast<uintptr_t>(low) + size > address) {
+        stack_low_ = reinterpret_cast<uintptr_t>(low);
+        stack_high_ = stack_low_ + size;
+    } else
+#endif
+    {
+        // the stack is assumed to have the size of a segment (the usual main thread stack)
+        stack_low_ = address > SEGMENT_SIZE ? address - SEGMENT_SIZE : 0;
+        stack_high_ = address + 1;
+    }
+    limit_ = stack_low_ + std::min(RED_ZONE, address - stack_low_);
+}
+
+#if defined(MYTHON_STACK_SEGMENTS)
+struct CallStack::Segment {
+    std::unique_ptr<char[]> memory{new char[SEGMENT_SIZE]};
+    ucontext_t context{};
+    ucontext_t caller{};
+    const std::function<ObjectHolder()>* body = nullptr;
+    ObjectHolder result;
+    std::exception_ptr error;
+#if defined(MYTHON_ASAN)
+    const void* caller_bottom = nullptr;
+    size_t caller_size = 0;
+#endif
+
+    // The function the context of the segment starts with
+    static void Start();
+};
+
+namespace {
+// The segment whose context is being started, makecontext passes only int arguments
+thread_local void* starting_segment = nullptr;
+}
 
-    size_t index = 0;
-    for (auto &param : mtd->formal_params) {
-        args[param] = actual_args.at(index++);
+void CallStack::Segment::Start() {
+    Segment& segment = *static_cast<Segment*>(starting_segment);
+#if defined(MYTHON_ASAN)
+    __sanitizer_finish_switch_fiber(nullptr, &segment.caller_bottom, &segment.caller_size);
+#endif
+    try {
+        segment.result = (*segment.body)();
+    } catch (...) {
+        segment.error = std::current_exception();
+    }
+#if defined(MYTHON_ASAN)
+    __sanitizer_start_switch_fiber(nullptr, segment.caller_bottom, segment.caller_size);
+#endif
+    // returning resumes the caller (uc_link)
+}
+
+ObjectHolder CallStack::RunOnSegment(const std::function<ObjectHolder()>& body) {
+    if (active_segments_ == segments_.size()) {
+        try {
+            segments_.push_back(std::make_unique<Segment>());
+        } catch (const std::bad_alloc&) {
+            ThrowOutOfStack();
+        }
+    }
+    Segment& segment = *segments_[active_segments_];
+    getcontext(&segment.context);
+    segment.context.uc_stack.ss_sp = segment.memory.get();
+    segment.context.uc_stack.ss_size = SEGMENT_SIZE;
+    segment.context.uc_link = &segment.caller;
+    makecontext(&segment.context, &Segment::Start, 0);
+    segment.body = &body;
+
+    char marker = 0;
+    const auto address = reinterpret_cast<uintptr_t>(&marker);
+    const auto limit = limit_;
+    const auto top = top_;
+    const auto used_below = used_below_;
+    used_below_ += top_ > address ? top_ - address : 0;
+    top_ = reinterpret_cast<uintptr_t>(segment.memory.get()) + SEGMENT_SIZE;
+    limit_ = reinterpret_cast<uintptr_t>(segment.memory.get()) + RED_ZONE;
+    ++active_segments_;
+
+    starting_segment = &segment;
+#if defined(MYTHON_ASAN)
+    void* fake_stack = nullptr;
+    __sanitizer_start_switch_fiber(&fake_stack, segment.memory.get(), SEGMENT_SIZE);
+#endif
+    swapcontext(&segment.caller, &segment.context);
+#if defined(MYTHON_ASAN)
+    __sanitizer_finish_switch_fiber(fake_stack, nullptr, nullptr);
+#endif
+
+    --active_segments_;
+    limit_ = limit;
+    top_ = top;
+    used_below_ = used_below;
+    segment.body = nullptr;
+    if (segment.error) {
+        std::rethrow_exception(std::exchange(segment.error, nullptr));
+    }
+    return std::exchange(segment.result, ObjectHolder::None());
+}
+#else
+struct CallStack::Segment {};
+
+ObjectHolder CallStack::RunOnSegment(const std::function<ObjectHolder()>& /*body*/) {
+    ThrowOutOfStack();
+}
+#endif
+
+CallStack::CallStack() = default;
+
+CallStack::~CallStack() = default;
+
+const ObjectHolder& Unbound() {
+    class UnboundValue : public Object {
+    public:
+        void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
+            os << "<unbound>"sv;
+        }
+    };
+    static UnboundValue unbound_object;
+    static const ObjectHolder unbound = ObjectHolder::Share(unbound_object);
+    return unbound;
+}
+
+std::unique_ptr<Frame> Method::AcquireFrame() const {
+    if (!free_frames.empty()) {
+        auto frame = std::move(free_frames.back());
+        free_frames.pop_back();
+        return frame;
+    }
+    // the slots are cached once: unordered_map never moves its elements
+    auto frame = std::make_unique<Frame>();
+    frame->self = &frame->closure["self"s];
+    frame->params.reserve(formal_params.size());
+    for (const auto& param : formal_params) {
+        frame->params.push_back(&frame->closure[param]);
     }
+    return frame;
+}
 
-    return mtd->body->Execute(args, context);
+void Method::ReleaseFrame(std::unique_ptr<Frame> frame) const {
+    // the variables are unbound rather than erased, so the next call does not reinsert them
+    for (auto& [name, value] : frame->closure) {
+        value = Unbound();
+    }
+    free_frames.push_back(std::move(frame));
+}
+
+MethodResults& Method::ResultsFor(const Class& cls) const {
+    for (auto& class_results : results) {
+        if (class_results.GetClass() == &cls) {
+            return class_results;
+        }
+    }
+    return results.emplace_back(cls, body->IsPure(cls));
+}
+
+const std::string& GetSpecialMethodName(SpecialMethod method) {
+    return SPECIAL_METHOD_NAMES.at(static_cast<size_t>(method));
 }
 
 Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
     : name_{std::move(name)}, methods_{std::move(methods)}, parent_{parent} {
+    for (size_t i = 0; i < special_methods_.size(); ++i) {
+        special_methods_[i] = GetMethod(SPECIAL_METHOD_NAMES[i]);
+    }
 }
 
 const Method* Class::GetMethod(const std::string &name) const {
@@ -167,49 +1001,456 @@ void Class::Print(ostream& os, [[maybe_unused]] Context& context) {
     os << "Class "s << name_;
 }
 
+// Rope node: either a flat string or the concatenation left + right
+struct String::Node {
+    // Concatenations shorter than this are copied right away, it is cheaper than a node
+    static constexpr size_t SMALL_SIZE = 32;
+
+    explicit Node(std::string value)
+        : size{value.size()}, flat{std::move(value)} {
+    }
+
+    Node(std::shared_ptr<Node> lhs, std::shared_ptr<Node> rhs)
+        : size{lhs->size + rhs->size}, left{std::move(lhs)}, right{std::move(rhs)} {
+    }
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    // A rope built by repeated concatenation is as deep as the number of concatenations,
+    // so the children are released iteratively instead of by recursive destructors
+    ~Node() {
+        std::vector<std::shared_ptr<Node>> pending;
+        auto release = [&pending](std::shared_ptr<Node>& child) {
+            if (child && child.use_count() == 1) {
+                pending.push_back(std::move(child));
+            }
+            child.reset();
+        };
+        release(left);
+        release(right);
+        while (!pending.empty()) {
+            auto node = std::move(pending.back());
+            pending.pop_back();
+            release(node->left);
+            release(node->right);
+        }
+    }
+
+    [[nodiscard]] bool IsFlat() const {
+        return left == nullptr;
+    }
+
+    // Collects the leaves left to right into a single string and turns the node into a leaf
+    void Flatten() {
+        if (IsFlat()) {
+            return;
+        }
+        std::string result;
+        result.reserve(size);
+        std::vector<const Node*> stack{this};
+        while (!stack.empty()) {
+            const Node* node = stack.back();
+            stack.pop_back();
+            if (node->IsFlat()) {
+                result += node->flat;
+            } else {
+                stack.push_back(node->right.get());
+                stack.push_back(node->left.get());
+            }
+        }
+        flat = std::move(result);
+        auto lhs = std::move(left);
+        auto rhs = std::move(right);
+    }
+
+    size_t size;
+    std::string flat;
+    std::shared_ptr<Node> left;
+    std::shared_ptr<Node> right;
+};
+
+String::String(std::string value)
+    : node_{std::make_shared<Node>(std::move(value))} {
+}
+
+String::String(std::shared_ptr<Node> node)
+    : node_{std::move(node)} {
+}
+
+String String::Concat(const String& lhs, const String& rhs) {
+    if (rhs.Size() == 0) {
+        return lhs;
+    }
+    if (lhs.Size() == 0) {
+        return rhs;
+    }
+    if (lhs.Size() + rhs.Size() <= Node::SMALL_SIZE && lhs.node_->IsFlat() && rhs.node_->IsFlat()) {
+        return String(lhs.node_->flat + rhs.node_->flat);
+    }
+    return String(std::make_shared<Node>(lhs.node_, rhs.node_));
+}
+
+void String::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    os << GetValue();
+}
+
+const std::string& String::GetValue() const {
+    node_->Flatten();
+    return node_->flat;
+}
+
+size_t String::Size() const {
+    return node_->size;
+}
+
+void Float::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    // to_chars keeps the sign of a NaN, which Python does not print
+    if (std::isnan(GetValue())) {
+        os << "nan"sv;
+        return;
+    }
+    // the longest shortest representation, like -2.2250738585072014e-308, fits easily
+    std::array<char, 32> buffer{};
+    auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), GetValue());
+    std::string_view text(buffer.data(), end - buffer.data());
+    os << text;
+    // a float is printed with a fractional part so that it differs from an integer
+    if (text.find_first_not_of("-0123456789"sv) == std::string_view::npos) {
+        os << ".0"sv;
+    }
+}
+
 void Bool::Print(std::ostream& os, [[maybe_unused]] Context& context) {
     os << (GetValue() ? "True"sv : "False"sv);
 }
 
-bool Equal(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    try {
-        return Comp(lhs, rhs, std::equal_to());
-    }  catch (std::runtime_error&) {
-        if (auto l = lhs.TryAs<ClassInstance>()) {
-            return IsTrue(l->Call(EQ_METHOD, {rhs}, context));
-        }
-        if (!lhs && !rhs) {
-            return true;
-        }
-        throw;
+namespace {
+// Calls the comparison special method of lhs if it has one taking a single argument
+std::optional<bool> CallComparison(SpecialMethod method, const ObjectHolder& lhs,
+                                   const ObjectHolder& rhs, Context& context) {
+    if (auto l = lhs.TryAs<ClassInstance>(); l && l->HasMethod(method, 1U)) {
+        return IsTrue(l->Call(method, &rhs, 1, context));
     }
+    return std::nullopt;
 }
+}  // namespace
 
-bool Less(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    try {
-        return Comp(lhs, rhs, std::less());
-    }  catch (std::runtime_error&) {
-        if (auto l = lhs.TryAs<ClassInstance>()) {
-            return IsTrue(l->Call(LESS_METHOD, {rhs}, context));
-        }
-        throw;
+bool Compare(CompareOperation operation, const ObjectHolder& lhs, const ObjectHolder& rhs,
+             Context& context) {
+    if (auto ordering = Comp(lhs, rhs)) {
+        return Satisfies(*ordering, operation);
     }
+    switch (operation) {
+        case CompareOperation::EQUAL:
+            if (auto l = lhs.TryAs<ClassInstance>()) {
+                return IsTrue(l->Call(SpecialMethod::EQ, &rhs, 1, context));
+            }
+            if (!lhs && !rhs) {
+                return true;
+            }
+            break;
+        case CompareOperation::NOT_EQUAL:
+            return !Compare(CompareOperation::EQUAL, lhs, rhs, context);
+        case CompareOperation::LESS:
+            if (auto l = lhs.TryAs<ClassInstance>()) {
+                return IsTrue(l->Call(SpecialMethod::LT, &rhs, 1, context));
+            }
+            break;
+        case CompareOperation::GREATER:
+            if (auto result = CallComparison(SpecialMethod::GT, lhs, rhs, context)) {
+                return *result;
+            }
+            return !(Compare(CompareOperation::LESS, lhs, rhs, context)
+                     || Compare(CompareOperation::EQUAL, lhs, rhs, context));
+        case CompareOperation::LESS_OR_EQUAL:
+            if (auto result = CallComparison(SpecialMethod::LE, lhs, rhs, context)) {
+                return *result;
+            }
+            return Compare(CompareOperation::LESS, lhs, rhs, context)
+                   || Compare(CompareOperation::EQUAL, lhs, rhs, context);
+        case CompareOperation::GREATER_OR_EQUAL:
+            if (auto result = CallComparison(SpecialMethod::GE, lhs, rhs, context)) {
+                return *result;
+            }
+            return !Compare(CompareOperation::LESS, lhs, rhs, context);
+    }
+    throw std::runtime_error("Cannot compare objects"s);
+}
+
+bool Equal(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
+    return Compare(CompareOperation::EQUAL, lhs, rhs, context);
+}
+
+bool Less(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
+    return Compare(CompareOperation::LESS, lhs, rhs, context);
 }
 
 bool NotEqual(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    return !Equal(lhs, rhs, context);
+    return Compare(CompareOperation::NOT_EQUAL, lhs, rhs, context);
 }
 
 bool Greater(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    return !(Less(lhs, rhs, context) || Equal(lhs, rhs, context));
+    return Compare(CompareOperation::GREATER, lhs, rhs, context);
 }
 
 bool LessOrEqual(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    return !Greater(lhs, rhs, context);
+    return Compare(CompareOperation::LESS_OR_EQUAL, lhs, rhs, context);
 }
 
 bool GreaterOrEqual(const ObjectHolder &lhs, const ObjectHolder &rhs, Context &context) {
-    return !Less(lhs, rhs, context);
+    return Compare(CompareOperation::GREATER_OR_EQUAL, lhs, rhs, context);
+}
+
+size_t Hash(const ObjectHolder& object, Context& context) {
+    if (auto obj = object.TryAs<Bool>()) {
+        return MixHash(obj->GetValue() ? 1U : 0U);
+    }
+    if (auto obj = object.TryAs<Number>()) {
+        return MixHash(static_cast<uint64_t>(obj->GetValue()));
+    }
+    if (auto obj = object.TryAs<String>()) {
+        return MixHash(std::hash<std::string>{}(obj->GetValue()));
+    }
+    if (auto obj = object.TryAs<BigInt>()) {
+        return MixHash(obj->GetValue().Hash());
+    }
+    if (auto obj = object.TryAs<Float>()) {
+        return MixHash(std::hash<double>{}(obj->GetValue()));
+    }
+    if (auto obj = object.TryAs<ClassInstance>(); obj && obj->HasMethod(SpecialMethod::HASH, 0U)) {
+        if (auto hash = obj->Call(SpecialMethod::HASH, nullptr, 0, context).TryAs<Number>()) {
+            return MixHash(static_cast<uint64_t>(hash->GetValue()));
+        }
+        throw std::runtime_error(GetSpecialMethodName(SpecialMethod::HASH) + " must return a number"s);
+    }
+    throw std::runtime_error("Unhashable object"s);
+}
+
+namespace {
+// Keys of different types are never equal, keys of the same type are compared with Equal
+bool KeysEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    if (typeid(*lhs) != typeid(*rhs)) {
+        return false;
+    }
+    return Equal(lhs, rhs, context);
+}
+}  // namespace
+
+Dict::Dict() = default;
+
+void Dict::ForEachReference(const std::function<void(const ObjectHolder&)>& visit) const {
+    ForEach([&visit](const ObjectHolder& key, const ObjectHolder& value) {
+        visit(key);
+        visit(value);
+    });
+}
+
+void Dict::ClearReferences() {
+    std::vector<int8_t> ctrl;
+    std::vector<Entry> slots;
+    std::swap(ctrl, ctrl_);
+    std::swap(slots, slots_);
+    size_ = deleted_ = 0;
+}
+
+void Dict::Print(std::ostream& os, Context& context) {
+    auto print = [&os, &context](const ObjectHolder& object) {
+        if (object) {
+            object->Print(os, context);
+        } else {
+            os << EMPTY_OBJECT;
+        }
+    };
+    if (printing_) {
+        os << "{...}"sv;
+        return;
+    }
+    // __str__ of a value may throw, the flag is cleared in any case
+    struct PrintingGuard {
+        bool& printing;
+        ~PrintingGuard() {
+            printing = false;
+        }
+    } guard{printing_};
+    printing_ = true;
+
+    bool first = true;
+    os << '{';
+    ForEach([&](const ObjectHolder& key, const ObjectHolder& value) {
+        if (!first) {
+            os << ", "sv;
+        }
+        print(key);
+        os << ": "sv;
+        print(value);
+        first = false;
+    });
+    os << '}';
+}
+
+size_t Dict::Find(const ObjectHolder& key, size_t hash, Context& context) const {
+    if (ctrl_.empty()) {
+        return std::string::npos;
+    }
+    const auto h2 = static_cast<int8_t>(hash & 0x7F);
+    const size_t group_count = ctrl_.size() / GROUP_SIZE;
+    const size_t mask = group_count - 1;
+    size_t group = (hash >> 7) & mask;
+    // triangular probing over the groups visits each group exactly once
+    for (size_t step = 1; step <= group_count; ++step) {
+        const size_t base = group * GROUP_SIZE;
+        bool has_empty = false;
+        for (size_t i = base; i < base + GROUP_SIZE; ++i) {
+            if (ctrl_[i] == h2 && slots_[i].hash == hash && KeysEqual(slots_[i].key, key, context)) {
+                return i;
+            }
+            has_empty |= (ctrl_[i] == EMPTY);
+        }
+        // the key would have been placed in this group, if it had been inserted
+        if (has_empty) {
+            return std::string::npos;
+        }
+        group = (group + step) & mask;
+    }
+    return std::string::npos;
+}
+
+size_t Dict::FindFreeSlot(size_t hash) const {
+    const size_t group_count = ctrl_.size() / GROUP_SIZE;
+    const size_t mask = group_count - 1;
+    size_t group = (hash >> 7) & mask;
+    for (size_t step = 1;; ++step) {
+        const size_t base = group * GROUP_SIZE;
+        for (size_t i = base; i < base + GROUP_SIZE; ++i) {
+            if (!IsFull(ctrl_[i])) {
+                return i;
+            }
+        }
+        group = (group + step) & mask;
+    }
+}
+
+void Dict::Rehash(size_t group_count) {
+    std::vector<int8_t> old_ctrl(group_count * GROUP_SIZE, EMPTY);
+    std::vector<Entry> old_slots(group_count * GROUP_SIZE);
+    std::swap(old_ctrl, ctrl_);
+    std::swap(old_slots, slots_);
+    deleted_ = 0;
+    for (size_t i = 0; i < old_ctrl.size(); ++i) {
+        if (IsFull(old_ctrl[i])) {
+            size_t slot = FindFreeSlot(old_slots[i].hash);
+            ctrl_[slot] = old_ctrl[i];
+            slots_[slot] = std::move(old_slots[i]);
+        }
+    }
+}
+
+ObjectHolder Dict::Get(const ObjectHolder& key, Context& context) const {
+    if (auto slot = Find(key, Hash(key, context), context); slot != std::string::npos) {
+        return slots_[slot].value;
+    }
+    return ObjectHolder::None();
+}
+
+bool Dict::Contains(const ObjectHolder& key, Context& context) const {
+    return Find(key, Hash(key, context), context) != std::string::npos;
+}
+
+void Dict::Set(const ObjectHolder& key, ObjectHolder value, Context& context) {
+    const size_t hash = Hash(key, context);
+    if (auto slot = Find(key, hash, context); slot != std::string::npos) {
+        slots_[slot].value = std::move(value);
+        return;
+    }
+    // keep the load factor (counting tombstones) under 7/8
+    if ((size_ + deleted_ + 1) * 8 > ctrl_.size() * 7) {
+        const size_t group_count = ctrl_.size() / GROUP_SIZE;
+        if (group_count == 0) {
+            Rehash(1);
+        } else if ((size_ + 1) * 2 > ctrl_.size()) {
+            Rehash(group_count * 2);
+        } else {
+            // mostly tombstones: clean them up without growing
+            Rehash(group_count);
+        }
+    }
+    size_t slot = FindFreeSlot(hash);
+    if (ctrl_[slot] == DELETED) {
+        --deleted_;
+    }
+    ctrl_[slot] = static_cast<int8_t>(hash & 0x7F);
+    slots_[slot] = Entry{hash, key, std::move(value)};
+    ++size_;
+}
+
+bool Dict::Erase(const ObjectHolder& key, Context& context) {
+    auto slot = Find(key, Hash(key, context), context);
+    if (slot == std::string::npos) {
+        return false;
+    }
+    ctrl_[slot] = DELETED;
+    slots_[slot] = Entry{};
+    --size_;
+    ++deleted_;
+    return true;
+}
+
+size_t Dict::Size() const {
+    return size_;
+}
+
+Range::Range(int64_t start, int64_t stop)
+    : start_{start}, stop_{stop} {
+}
+
+void Range::Print(std::ostream& os, [[maybe_unused]] Context& context) {
+    os << "range("sv << start_ << ", "sv << stop_ << ')';
+}
+
+int64_t Range::GetStart() const {
+    return start_;
+}
+
+int64_t Range::GetStop() const {
+    return stop_;
+}
+
+ObjectHolder Dict::Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
+                        Context& context) {
+    return Call(method, actual_args.data(), actual_args.size(), context);
+}
+
+ObjectHolder Dict::Call(const std::string& method, const ObjectHolder* actual_args, size_t count,
+                        Context& context) {
+    auto check_args = [&method, count](size_t expected) {
+        if (count != expected) {
+            throw std::runtime_error("Method "s + method + " of dict takes "s
+                                     + std::to_string(expected) + " arguments"s);
+        }
+    };
+    if (method == "get"sv) {
+        check_args(1);
+        return Get(actual_args[0], context);
+    }
+    if (method == "set"sv) {
+        check_args(2);
+        Set(actual_args[0], actual_args[1], context);
+        return ObjectHolder::None();
+    }
+    if (method == "contains"sv) {
+        check_args(1);
+        return MakeBool(Contains(actual_args[0], context));
+    }
+    if (method == "remove"sv) {
+        check_args(1);
+        return MakeBool(Erase(actual_args[0], context));
+    }
+    if (method == "len"sv) {
+        check_args(0);
+        return MakeNumber(static_cast<int64_t>(Size()));
+    }
+    throw std::runtime_error("No method "s + method + " in dict"s);
 }
 
 }  // namespace runtime
@@ -2,6 +2,8 @@
 #include "test_runner_p.h"
 
 #include <functional>
+#include <limits>
+#include <sstream>
 
 using namespace std;
 
@@ -71,6 +73,33 @@ void TestString() {
     ASSERT_EQUAL(word.GetValue(), "hello!"s);
 }
 
+void TestStringConcat() {
+    String hello("hello, "s);
+    String world("world!"s);
+    auto joined = String::Concat(hello, world);
+    ASSERT_EQUAL(joined.Size(), 13U);
+    ASSERT_EQUAL(joined.GetValue(), "hello, world!"s);
+    // operands are not changed
+    ASSERT_EQUAL(hello.GetValue(), "hello, "s);
+    ASSERT_EQUAL(String::Concat(String(""s), world).GetValue(), "world!"s);
+
+    // a deep rope is flattened and destroyed without recursion
+    const int count = 200000;
+    String text(""s);
+    String piece("0123456789"s);
+    for (int i = 0; i < count; ++i) {
+        text = String::Concat(text, piece);
+    }
+    ASSERT_EQUAL(text.Size(), 10U * count);
+    const auto& value = text.GetValue();
+    ASSERT_EQUAL(value.size(), 10U * count);
+    ASSERT_EQUAL(value.substr(value.size() - 12), "890123456789"s);
+
+    DummyContext context;
+    String::Concat(String(std::string(40, 'a')), String("b"s)).Print(context.output, context);
+    ASSERT_EQUAL(context.output.str(), std::string(40, 'a') + "b"s);
+}
+
 void TestBool() {
     Bool t(true);
     ASSERT_EQUAL(t.GetValue(), true);
@@ -90,6 +119,141 @@ void TestBool() {
     ASSERT(context.output.str().empty());
 }
 
+void TestCanonicalValues() {
+    ASSERT(MakeBool(true).TryAs<Bool>()->GetValue());
+    ASSERT(!MakeBool(false).TryAs<Bool>()->GetValue());
+    ASSERT_EQUAL(MakeBool(true).Get(), MakeBool(true).Get());
+    ASSERT_EQUAL(MakeBool(false).Get(), MakeBool(false).Get());
+
+    // warm up the cache
+    ASSERT_EQUAL(MakeNumber(0).TryAs<Number>()->GetValue(), 0);
+    const auto allocated = allocation_stats.allocated;
+    for (int i = SMALL_NUMBER_MIN; i <= SMALL_NUMBER_MAX; ++i) {
+        auto number = MakeNumber(i);
+        ASSERT_EQUAL(number.TryAs<Number>()->GetValue(), i);
+        ASSERT_EQUAL(number.Get(), MakeNumber(i).Get());
+    }
+    ASSERT_EQUAL(allocation_stats.allocated, allocated);
+
+    auto big = MakeNumber(SMALL_NUMBER_MAX + 1);
+    ASSERT_EQUAL(big.TryAs<Number>()->GetValue(), SMALL_NUMBER_MAX + 1);
+    ASSERT(big.Get() != MakeNumber(SMALL_NUMBER_MAX + 1).Get());
+    ASSERT_EQUAL(allocation_stats.allocated, allocated + 2);
+}
+
+BigInteger PowerOfTen(int power) {
+    BigInteger result(1);
+    for (int i = 0; i < power; ++i) {
+        result = result * BigInteger(10);
+    }
+    return result;
+}
+
+void TestBigInteger() {
+    ASSERT_EQUAL(BigInteger().ToString(), "0"s);
+    ASSERT_EQUAL(BigInteger(-42).ToString(), "-42"s);
+    ASSERT_EQUAL(BigInteger(INT64_MIN).ToString(), "-9223372036854775808"s);
+    ASSERT(BigInteger(INT64_MIN).FitsInt64());
+    ASSERT(!(BigInteger(INT64_MAX) + BigInteger(1)).FitsInt64());
+    ASSERT_EQUAL((BigInteger(INT64_MAX) + BigInteger(1)).ToString(), "9223372036854775808"s);
+    ASSERT_EQUAL((BigInteger(5) - BigInteger(7)).ToString(), "-2"s);
+    ASSERT_EQUAL((BigInteger(-7) / BigInteger(2)).ToString(), "-3"s);
+    ASSERT(BigInteger(-1) < BigInteger(0));
+    ASSERT((BigInteger(3) - BigInteger(3)).IsZero());
+    ASSERT(!(BigInteger(3) - BigInteger(3)).IsNegative());
+
+    // the operands are long enough for Karatsuba multiplication
+    const BigInteger nines = PowerOfTen(400) - BigInteger(1);
+    const std::string expected = std::string(399, '9') + "8"s + std::string(399, '0') + "1"s;
+    ASSERT_EQUAL((nines * nines).ToString(), expected);
+    ASSERT_EQUAL((nines * nines) / nines, nines);
+    ASSERT_EQUAL((nines * BigInteger(-1) * nines).ToString(), "-"s + expected);
+    ASSERT_EQUAL(PowerOfTen(500) / PowerOfTen(200), PowerOfTen(300));
+    ASSERT_EQUAL((PowerOfTen(500) + BigInteger(7)) / PowerOfTen(499), BigInteger(10));
+    ASSERT_THROWS(PowerOfTen(50) / BigInteger(), std::runtime_error);
+
+    ASSERT_EQUAL(BigInteger::FromString("1"s + std::string(400, '0')), PowerOfTen(400));
+    ASSERT_EQUAL(BigInteger::FromString("-9223372036854775808"s), BigInteger(INT64_MIN));
+    ASSERT_EQUAL(BigInteger::FromString("-0"s).ToString(), "0"s);
+    ASSERT_THROWS((void)BigInteger::FromString("12a"s), std::invalid_argument);
+    ASSERT_THROWS((void)BigInteger::FromString("-"s), std::invalid_argument);
+}
+
+void TestIntegerArithmetic() {
+    auto max = MakeNumber(INT64_MAX);
+    auto one = MakeNumber(1);
+    auto sum = IntegerArithmetic(ArithmeticOperation::ADD, max, one);
+    ASSERT(sum.TryAs<BigInt>());
+    ASSERT_EQUAL(sum.TryAs<BigInt>()->GetValue().ToString(), "9223372036854775808"s);
+
+    // the result fits into Number again
+    auto back = IntegerArithmetic(ArithmeticOperation::SUB, sum, one);
+    ASSERT_EQUAL(back.TryAs<Number>()->GetValue(), INT64_MAX);
+
+    auto min = MakeNumber(INT64_MIN);
+    auto quotient = IntegerArithmetic(ArithmeticOperation::DIV, min, MakeNumber(-1));
+    ASSERT_EQUAL(quotient.TryAs<BigInt>()->GetValue().ToString(), "9223372036854775808"s);
+    auto product = IntegerArithmetic(ArithmeticOperation::MULT, max, max);
+    ASSERT_EQUAL(product.TryAs<BigInt>()->GetValue().ToString(),
+                 "85070591730234615847396907784232501249"s);
+    ASSERT_EQUAL(IntegerArithmetic(ArithmeticOperation::MULT, MakeNumber(6), MakeNumber(7)).TryAs<Number>()->GetValue(), 42);
+
+    ASSERT(!IntegerArithmetic(ArithmeticOperation::ADD, one, ObjectHolder::Own(String("1"s))));
+    ASSERT_THROWS((void)IntegerArithmetic(ArithmeticOperation::DIV, sum, MakeNumber(0)), std::runtime_error);
+
+    DummyContext context;
+    ASSERT(Less(max, sum, context));
+    ASSERT(Greater(sum, min, context));
+    ASSERT(!Equal(sum, max, context));
+    ASSERT(IsTrue(sum));
+}
+
+void TestFloat() {
+    DummyContext context;
+    auto print = [&context](const ObjectHolder& object) {
+        std::ostringstream out;
+        object->Print(out, context);
+        return out.str();
+    };
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(0.1))), "0.1"s);
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(2.0))), "2.0"s);
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(-3.0))), "-3.0"s);
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(1e300))), "1e+300"s);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(nan))), "nan"s);
+    ASSERT_EQUAL(print(ObjectHolder::Own(Float(-nan))), "nan"s);
+
+    auto half = ObjectHolder::Own(Float(0.5));
+    auto three = MakeNumber(3);
+    ASSERT(!FloatArithmetic(ArithmeticOperation::ADD, three, three));
+    ASSERT(!FloatArithmetic(ArithmeticOperation::ADD, half, ObjectHolder::Own(String("1"s))));
+    ASSERT_EQUAL(FloatArithmetic(ArithmeticOperation::ADD, three, half).TryAs<Float>()->GetValue(), 3.5);
+    ASSERT_EQUAL(FloatArithmetic(ArithmeticOperation::SUB, half, three).TryAs<Float>()->GetValue(), -2.5);
+    ASSERT_EQUAL(FloatArithmetic(ArithmeticOperation::MULT, half, three).TryAs<Float>()->GetValue(), 1.5);
+    ASSERT_EQUAL(FloatArithmetic(ArithmeticOperation::DIV, three, half).TryAs<Float>()->GetValue(), 6.0);
+    ASSERT_THROWS((void)FloatArithmetic(ArithmeticOperation::DIV, half, MakeNumber(0)), std::runtime_error);
+
+    ASSERT(Less(half, three, context));
+    ASSERT(Greater(three, half, context));
+    ASSERT(Equal(ObjectHolder::Own(Float(3.0)), three, context));
+    ASSERT(IsTrue(half));
+    ASSERT(!IsTrue(ObjectHolder::Own(Float(0.0))));
+}
+
+void TestMixedComparison() {
+    DummyContext context;
+    auto big = IntegerArithmetic(ArithmeticOperation::MULT, MakeNumber(INT64_MAX), MakeNumber(4));
+    auto real = ObjectHolder::Own(Float(1e30));
+
+    ASSERT(Less(MakeNumber(1), big, context));
+    ASSERT(Less(big, real, context));
+    ASSERT(Greater(real, MakeNumber(-1), context));
+    ASSERT(Equal(ObjectHolder::None(), ObjectHolder::None(), context));
+    ASSERT_THROWS(Equal(MakeBool(true), MakeNumber(1), context), std::runtime_error);
+    ASSERT_THROWS(Less(ObjectHolder::Own(String("1"s)), real, context), std::runtime_error);
+    ASSERT_THROWS(Less(ObjectHolder::None(), ObjectHolder::None(), context), std::runtime_error);
+}
+
 struct TestMethodBody : Executable {
     using Fn = std::function<ObjectHolder(Closure& closure, Context& context)>;
     Fn body;
@@ -242,6 +406,39 @@ void TestMove() {
     }
 }
 
+void TestSharedOwnership() {
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    {
+        auto owner = ObjectHolder::Own(Logger(5));
+        // Share of an owned object takes part in the ownership
+        auto shared = ObjectHolder::Share(*owner);
+        owner = ObjectHolder::None();
+        ASSERT_EQUAL(Logger::instance_count, 1);
+        ASSERT_EQUAL(shared.TryAs<Logger>()->GetId(), 5);
+
+        ObjectHolder copy;
+        copy = shared;
+        shared = copy;
+        shared = ObjectHolder::None();
+        ASSERT_EQUAL(Logger::instance_count, 1);
+        copy = ObjectHolder::Own(Logger(6));
+        ASSERT_EQUAL(Logger::instance_count, 1);
+        ASSERT_EQUAL(copy.TryAs<Logger>()->GetId(), 6);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 0);
+
+    // a copy of an owned object placed on the stack is not owned by the holders
+    {
+        auto owner = ObjectHolder::Own(Logger(7));
+        Logger local(*owner.TryAs<Logger>());
+        {
+            auto shared = ObjectHolder::Share(local);
+        }
+        ASSERT_EQUAL(Logger::instance_count, 2);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 0);
+}
+
 void TestNullptr() {
     ObjectHolder oh;
     ASSERT(!oh);
@@ -504,6 +701,38 @@ void TestClass() {
     ASSERT_EQUAL(out.str(), "Class Test"s);
 }
 
+void TestSpecialMethods() {
+    auto number_body = [](int64_t value) {
+        return make_unique<TestMethodBody>([value](Closure& /*closure*/, Context& /*context*/) {
+            return MakeNumber(value);
+        });
+    };
+    vector<Method> methods;
+    methods.push_back({"__str__"s, {}, number_body(1)});
+    methods.push_back({"__add__"s, {"rhs"s}, number_body(2)});
+    Class base{"Base"s, move(methods), nullptr};
+
+    methods.clear();
+    methods.push_back({"__add__"s, {"rhs"s}, number_body(3)});
+    methods.push_back({"__hash__"s, {}, number_body(4)});
+    Class derived{"Derived"s, move(methods), &base};
+
+    ASSERT_EQUAL(GetSpecialMethodName(SpecialMethod::INIT), "__init__"s);
+    ASSERT_EQUAL(base.GetMethod(SpecialMethod::STR), base.GetMethod("__str__"s));
+    ASSERT_EQUAL(base.GetMethod(SpecialMethod::HASH), nullptr);
+    ASSERT_EQUAL(derived.GetMethod(SpecialMethod::STR), base.GetMethod("__str__"s));
+    ASSERT_EQUAL(derived.GetMethod(SpecialMethod::ADD), derived.GetMethod("__add__"s));
+    ASSERT_EQUAL(derived.GetMethod(SpecialMethod::HASH), derived.GetMethod("__hash__"s));
+
+    DummyContext context;
+    ClassInstance instance{derived};
+    auto rhs = MakeNumber(0);
+    ASSERT(instance.HasMethod(SpecialMethod::ADD, 1U));
+    ASSERT(!instance.HasMethod(SpecialMethod::ADD, 0U));
+    ASSERT_EQUAL(instance.Call(SpecialMethod::ADD, &rhs, 1, context).TryAs<Number>()->GetValue(), 3);
+    ASSERT_THROWS(instance.Call(SpecialMethod::INIT, nullptr, 0, context), std::runtime_error);
+}
+
 void TestClassInstance() {
     vector<Method> methods;
 
@@ -529,23 +758,213 @@ void TestClassInstance() {
     ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
 }
 
+void TestDict() {
+    DummyContext ctx;
+    Dict dict;
+    ASSERT_EQUAL(dict.Size(), 0U);
+    ASSERT(!dict.Get(ObjectHolder::Own(Number{1}), ctx));
+
+    // enough keys to force several rehashes
+    for (int i = 0; i < 1000; ++i) {
+        dict.Set(ObjectHolder::Own(Number{i}), ObjectHolder::Own(Number{i * 2}), ctx);
+    }
+    dict.Set(ObjectHolder::Own(String{"key"s}), ObjectHolder::Own(String{"value"s}), ctx);
+    dict.Set(ObjectHolder::Own(Bool{true}), ObjectHolder::None(), ctx);
+    ASSERT_EQUAL(dict.Size(), 1002U);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto value = dict.Get(ObjectHolder::Own(Number{i}), ctx);
+        ASSERT(value.TryAs<Number>() != nullptr && value.TryAs<Number>()->GetValue() == i * 2);
+    }
+    ASSERT_EQUAL(dict.Get(ObjectHolder::Own(String{"key"s}), ctx).TryAs<String>()->GetValue(),
+                 "value"s);
+    // keys of different types are different keys
+    ASSERT(dict.Contains(ObjectHolder::Own(Bool{true}), ctx));
+    ASSERT(!dict.Contains(ObjectHolder::Own(String{"1"s}), ctx));
+
+    dict.Set(ObjectHolder::Own(Number{5}), ObjectHolder::Own(Number{-5}), ctx);
+    ASSERT_EQUAL(dict.Size(), 1002U);
+    ASSERT_EQUAL(dict.Get(ObjectHolder::Own(Number{5}), ctx).TryAs<Number>()->GetValue(), -5);
+
+    for (int i = 0; i < 1000; i += 2) {
+        ASSERT(dict.Erase(ObjectHolder::Own(Number{i}), ctx));
+    }
+    ASSERT(!dict.Erase(ObjectHolder::Own(Number{0}), ctx));
+    ASSERT_EQUAL(dict.Size(), 502U);
+    ASSERT(!dict.Contains(ObjectHolder::Own(Number{10}), ctx));
+    ASSERT(dict.Contains(ObjectHolder::Own(Number{11}), ctx));
+
+    ASSERT_THROWS(dict.Set(ObjectHolder::None(), ObjectHolder::None(), ctx), runtime_error);
+    ASSERT_THROWS(dict.Call("get"s, {}, ctx), runtime_error);
+    ASSERT_THROWS(dict.Call("missing_method"s, {}, ctx), runtime_error);
+    ASSERT_EQUAL(dict.Call("len"s, {}, ctx).TryAs<Number>()->GetValue(), 502);
+
+    Dict small;
+    small.Set(ObjectHolder::Own(String{"a"s}), ObjectHolder::Own(Number{1}), ctx);
+    ostringstream out;
+    small.Print(out, ctx);
+    ASSERT_EQUAL(out.str(), "{a: 1}"s);
+}
+
+void TestDictUserKeys() {
+    // keys are equal if their "id" fields are equal
+    auto hash_body = [](Closure& closure, [[maybe_unused]] Context& ctx) {
+        auto& self = *closure.at("self"s).TryAs<ClassInstance>();
+        return self.Fields().at("id"s);
+    };
+    auto eq_body = [](Closure& closure, Context& ctx) {
+        auto& self = *closure.at("self"s).TryAs<ClassInstance>();
+        auto& rhs = *closure.at("rhs"s).TryAs<ClassInstance>();
+        return ObjectHolder::Own(Bool{Equal(self.Fields().at("id"s), rhs.Fields().at("id"s), ctx)});
+    };
+    vector<Method> methods;
+    methods.push_back({"__hash__"s, {}, make_unique<TestMethodBody>(hash_body)});
+    methods.push_back({"__eq__"s, {"rhs"s}, make_unique<TestMethodBody>(eq_body)});
+    Class key_cls{"Key"s, move(methods), nullptr};
+
+    auto make_key = [&key_cls](int id) {
+        auto key = ObjectHolder::Own(ClassInstance{key_cls});
+        key.TryAs<ClassInstance>()->Fields()["id"s] = ObjectHolder::Own(Number{id});
+        return key;
+    };
+
+    DummyContext ctx;
+    Dict dict;
+    dict.Set(make_key(1), ObjectHolder::Own(String{"one"s}), ctx);
+    dict.Set(make_key(2), ObjectHolder::Own(String{"two"s}), ctx);
+    dict.Set(make_key(1), ObjectHolder::Own(String{"uno"s}), ctx);
+    ASSERT_EQUAL(dict.Size(), 2U);
+    ASSERT_EQUAL(dict.Get(make_key(1), ctx).TryAs<String>()->GetValue(), "uno"s);
+    ASSERT(!dict.Contains(make_key(3), ctx));
+
+    Class unhashable{"Unhashable"s, {}, nullptr};
+    ASSERT_THROWS(dict.Set(ObjectHolder::Own(ClassInstance{unhashable}), ObjectHolder::None(), ctx),
+                  runtime_error);
+}
+
+void TestCycleCollection() {
+    Class cls{"Node"s, {}, nullptr};
+    auto make_node = [&cls](int id) {
+        auto node = ObjectHolder::Own(ClassInstance{cls});
+        node.TryAs<ClassInstance>()->Fields()["payload"s] = ObjectHolder::Own(Logger(id));
+        return node;
+    };
+    auto link = [](const ObjectHolder& from, const ObjectHolder& to) {
+        from.TryAs<ClassInstance>()->Fields()["next"s] = to;
+    };
+
+    const size_t tracked = heap.GetTrackedCount();
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    ObjectHolder alive = make_node(0);
+    {
+        // a cycle of three nodes and a dictionary referring to itself
+        auto a = make_node(1);
+        auto b = make_node(2);
+        auto c = make_node(3);
+        link(a, b);
+        link(b, c);
+        link(c, a);
+        auto dict = ObjectHolder::Own(Dict());
+        DummyContext ctx;
+        dict.TryAs<Dict>()->Set(ObjectHolder::Own(String("self"s)), dict, ctx);
+
+        // a cycle reachable from a live object survives
+        auto d = make_node(4);
+        link(alive, d);
+        link(d, alive);
+    }
+    ASSERT_EQUAL(Logger::instance_count, 5);
+    ASSERT_EQUAL(heap.GetTrackedCount(), tracked + 6);
+
+    const auto collections = heap.GetStats().major_collections;
+    ASSERT_EQUAL(heap.Collect(), 4U);
+    ASSERT_EQUAL(heap.GetStats().major_collections, collections + 1);
+    ASSERT_EQUAL(Logger::instance_count, 2);
+    ASSERT_EQUAL(heap.GetTrackedCount(), tracked + 2);
+
+    ASSERT_EQUAL(heap.Collect(), 0U);
+    alive.TryAs<ClassInstance>()->Fields().at("next"s).TryAs<ClassInstance>()->Fields().erase("next"s);
+    alive = ObjectHolder::None();
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    ASSERT_EQUAL(heap.GetTrackedCount(), tracked);
+}
+
+void TestGenerationalCollection() {
+    Class cls{"Node"s, {}, nullptr};
+    auto make_node = [&cls](int id) {
+        auto node = ObjectHolder::Own(ClassInstance{cls});
+        node.TryAs<ClassInstance>()->Fields()["payload"s] = ObjectHolder::Own(Logger(id));
+        return node;
+    };
+    auto link = [](const ObjectHolder& from, const ObjectHolder& to) {
+        from.TryAs<ClassInstance>()->Fields()["next"s] = to;
+    };
+
+    heap.Collect();
+    ASSERT_EQUAL(heap.GetYoungCount(), 0U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+
+    auto old = make_node(0);
+    ASSERT_EQUAL(heap.GetYoungCount(), 1U);
+    const auto minor_collections = heap.GetStats().minor_collections;
+    ASSERT_EQUAL(heap.CollectYoung(), 0U);
+    ASSERT_EQUAL(heap.GetYoungCount(), 0U);
+    ASSERT_EQUAL(heap.GetStats().minor_collections, minor_collections + 1);
+    ASSERT_EQUAL(heap.GetStats().minor_pauses_ms.size(), minor_collections + 1);
+
+    {
+        // a young cycle is freed by a minor collection,
+        // a young container referred to by an old one is promoted
+        auto a = make_node(1);
+        auto b = make_node(2);
+        link(a, b);
+        link(b, a);
+        link(old, make_node(3));
+    }
+    ASSERT_EQUAL(heap.GetYoungCount(), 3U);
+    ASSERT_EQUAL(heap.CollectYoung(), 2U);
+    ASSERT_EQUAL(heap.GetYoungCount(), 0U);
+    ASSERT_EQUAL(Logger::instance_count, 2);
+
+    // a cycle of old containers is freed by a major collection only
+    link(old.TryAs<ClassInstance>()->Fields().at("next"s), old);
+    old = ObjectHolder::None();
+    ASSERT_EQUAL(heap.CollectYoung(), 0U);
+    ASSERT_EQUAL(Logger::instance_count, 2);
+    ASSERT_EQUAL(heap.Collect(), 2U);
+    ASSERT_EQUAL(Logger::instance_count, 0);
+    ASSERT(heap.GetMinorPausePercentile(50) <= heap.GetStats().max_pause_ms);
+}
+
 }  // namespace
 
 void RunObjectsTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestNumber);
     RUN_TEST(tr, runtime::TestString);
+    RUN_TEST(tr, runtime::TestStringConcat);
     RUN_TEST(tr, runtime::TestBool);
+    RUN_TEST(tr, runtime::TestCanonicalValues);
+    RUN_TEST(tr, runtime::TestBigInteger);
+    RUN_TEST(tr, runtime::TestIntegerArithmetic);
+    RUN_TEST(tr, runtime::TestFloat);
+    RUN_TEST(tr, runtime::TestMixedComparison);
     RUN_TEST(tr, runtime::TestMethodInvocation);
     RUN_TEST(tr, runtime::TestIsTrue);
     RUN_TEST(tr, runtime::TestComparison);
     RUN_TEST(tr, runtime::TestClass);
+    RUN_TEST(tr, runtime::TestSpecialMethods);
     RUN_TEST(tr, runtime::TestClassInstance);
+    RUN_TEST(tr, runtime::TestDict);
+    RUN_TEST(tr, runtime::TestDictUserKeys);
+    RUN_TEST(tr, runtime::TestCycleCollection);
+    RUN_TEST(tr, runtime::TestGenerationalCollection);
 }
 
 void RunObjectHolderTests(TestRunner& tr) {
     RUN_TEST(tr, runtime::TestNonowning);
     RUN_TEST(tr, runtime::TestOwning);
     RUN_TEST(tr, runtime::TestMove);
+    RUN_TEST(tr, runtime::TestSharedOwnership);
     RUN_TEST(tr, runtime::TestNullptr);
 }
 
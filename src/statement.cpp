@@ -1,9 +1,12 @@
 #include "statement.h"
 
+#include "jit.h"
+
 #include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <utility>
 
 using namespace std;
 
@@ -14,11 +17,437 @@ using runtime::Context;
 using runtime::ObjectHolder;
 
 namespace {
-const string ADD_METHOD = "__add__"s;
-const string INIT_METHOD = "__init__"s;
 const string EMPTY_OBJECT = "None"s;
+
+// Set by Return and taken by the enclosing MethodBody. Statements that execute
+// other statements in sequence stop as soon as it is set, so return does not throw
+struct PendingReturn {
+    bool active = false;
+    ObjectHolder value;
+} pending_return;
+
+// A recursive call in the tail position, prepared by MethodCall::ExecuteTail
+// and made by the MethodBody which is being executed
+struct PendingTailCall {
+    bool active = false;
+    const runtime::Method* method = nullptr;
+    ObjectHolder self;
+    std::vector<ObjectHolder> args;
+} pending_tail_call;
+
+// The body of the method call being executed
+const MethodBody* executing_body = nullptr;
+
+// Evaluates a statement or its compiled code, so that the helpers below serve both backends
+ObjectHolder Evaluate(const std::unique_ptr<Statement>& statement, Closure& closure,
+                      Context& context) {
+    return statement->Execute(closure, context);
+}
+
+ObjectHolder Evaluate(const runtime::Compiled& code, Closure& closure, Context& context) {
+    return code(closure, context);
+}
+
+// Pushes the values of the argument expressions onto the value stack
+// and pops them back when the call is over
+class StackArguments {
+public:
+    // Args is either the argument statements or their compiled code
+    template <typename Args>
+    StackArguments(const Args& args, Closure& closure, Context& context)
+        : base_{runtime::value_stack.Size()} {
+        for (auto& arg : args) {
+            runtime::value_stack.Push(Evaluate(arg, closure, context));
+        }
+    }
+
+    StackArguments(const StackArguments&) = delete;
+    StackArguments& operator=(const StackArguments&) = delete;
+
+    ~StackArguments() {
+        runtime::value_stack.Truncate(base_);
+    }
+
+    [[nodiscard]] const ObjectHolder* Data() const {
+        return runtime::value_stack.At(base_);
+    }
+
+    [[nodiscard]] size_t Size() const {
+        return runtime::value_stack.Size() - base_;
+    }
+
+private:
+    size_t base_;
+};
+
+using Operands = Quickening::Operands;
+
+bool IsNumber(const ObjectHolder& object) {
+    return runtime::GetKind(object) == runtime::ValueKind::NUMBER;
+}
+
+bool IsString(const ObjectHolder& object) {
+    return runtime::GetKind(object) == runtime::ValueKind::STRING;
+}
+
+// The object must be of the type T
+template <typename T>
+const T& CastTo(const ObjectHolder& object) {
+    return static_cast<const T&>(*object.Get());
+}
+
+// Calculates the operation on two Numbers. Returns None if the operands are something else
+// or the result overflows
+ObjectHolder NumberArithmetic(runtime::ArithmeticOperation operation, const ObjectHolder& lhs,
+                              const ObjectHolder& rhs) {
+    int64_t result = 0;
+    if (IsNumber(lhs) && IsNumber(rhs)
+        && runtime::CheckedArithmetic(operation, CastTo<runtime::Number>(lhs).GetValue(),
+                                      CastTo<runtime::Number>(rhs).GetValue(), result)) {
+        return runtime::MakeNumber(result);
+    }
+    return ObjectHolder::None();
+}
+
+// Fast path of a node specialized for two Numbers. Deoptimizes the node if the operands are
+// something else. Returns None if the result has to be calculated by the generic path
+ObjectHolder QuickArithmetic(Quickening& quickening, runtime::ArithmeticOperation operation,
+                             const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    if (!IsNumber(lhs) || !IsNumber(rhs)) {
+        quickening.Deoptimize();
+        return ObjectHolder::None();
+    }
+    return NumberArithmetic(operation, lhs, rhs);
+}
+
+// Prints the values of the arguments separated by spaces and ends the line
+template <typename Args>
+void PrintValues(const Args& args, Closure& closure, Context& context) {
+    bool first = true;
+    auto &os = context.GetOutputStream();
+    for (auto &arg : args) {
+        if (!first) {
+            os << " "s;
+        }
+        PrintValue(Evaluate(arg, closure, context), context);
+        first = false;
+    }
+    os << "\n"s;
+}
+
+template <typename Args>
+ObjectHolder CallWithArguments(const ObjectHolder& object, const std::string& method,
+                               const Args& args, Closure& closure, Context& context) {
+    CheckMethodReceiver(object);
+    StackArguments actual_args(args, closure, context);
+    return CallMethod(object, method, actual_args.Data(), actual_args.Size(), context);
+}
+
+// Prepares the call as the pending tail call if it is a recursive call of the method being
+// executed. Returns false if it is some other call
+template <typename Args>
+bool PrepareTailCall(const ObjectHolder& object, const std::string& method, const Args& args,
+                     Closure& closure, Context& context) {
+    auto class_instance = object.TryAs<runtime::ClassInstance>();
+    if (!class_instance || executing_body == nullptr) {
+        return false;
+    }
+    auto callee = class_instance->GetClass().GetMethod(method);
+    if (!callee || callee->body.get() != executing_body
+        || callee->formal_params.size() != args.size()) {
+        return false;
+    }
+    // the arguments may make tail calls of their own, so they are collected first
+    StackArguments actual_args(args, closure, context);
+    pending_tail_call.args.assign(actual_args.Data(), actual_args.Data() + actual_args.Size());
+    pending_tail_call.self = object;
+    pending_tail_call.method = callee;
+    pending_tail_call.active = true;
+    return true;
+}
+
+template <typename Args>
+ObjectHolder CreateInstance(const runtime::Class& cls, const Args& args, Closure& closure,
+                            Context& context) {
+    auto instance = ObjectHolder::Own(runtime::ClassInstance(cls));
+    auto &class_instance = static_cast<runtime::ClassInstance&>(*instance);
+    if (class_instance.HasMethod(runtime::SpecialMethod::INIT, args.size())) {
+        StackArguments actual_args(args, closure, context);
+        class_instance.Call(runtime::SpecialMethod::INIT, actual_args.Data(), actual_args.Size(), context);
+    }
+    return instance;
+}
+
+template <typename T>
+bool ApplyComparison(runtime::CompareOperation operation, const T& lhs, const T& rhs) {
+    switch (operation) {
+        case runtime::CompareOperation::EQUAL:
+            return lhs == rhs;
+        case runtime::CompareOperation::NOT_EQUAL:
+            return lhs != rhs;
+        case runtime::CompareOperation::LESS:
+            return lhs < rhs;
+        case runtime::CompareOperation::GREATER:
+            return lhs > rhs;
+        case runtime::CompareOperation::LESS_OR_EQUAL:
+            return lhs <= rhs;
+        case runtime::CompareOperation::GREATER_OR_EQUAL:
+            return lhs >= rhs;
+    }
+    return false;
+}
+
+// Calculates an operand of an operator: as_operator is the operand if it is an operator
+Temporary CalculateOperand(Statement& operand, Operator* as_operator, Closure& closure,
+                           Context& context) {
+    if (as_operator != nullptr) {
+        return as_operator->Calculate(closure, context);
+    }
+    return Temporary(operand.Execute(closure, context));
+}
+
+ObjectHolder ArithmeticObjects(runtime::ArithmeticOperation operation, const ObjectHolder& lhs,
+                               const ObjectHolder& rhs, Context& context) {
+    switch (operation) {
+        case runtime::ArithmeticOperation::ADD:
+            return AddObjects(lhs, rhs, context);
+        case runtime::ArithmeticOperation::SUB:
+            return SubtractObjects(lhs, rhs, context);
+        case runtime::ArithmeticOperation::MULT:
+            return MultiplyObjects(lhs, rhs, context);
+        case runtime::ArithmeticOperation::DIV:
+            return DivideObjects(lhs, rhs, context);
+    }
+    return ObjectHolder::None();
+}
+
+// Calculates the operation on two numbers or the concatenation of two strings unboxed,
+// anything else on the boxed operands
+Temporary CalculateArithmetic(runtime::ArithmeticOperation operation, const Temporary& lhs,
+                              const Temporary& rhs, Context& context) {
+    const auto left_number = lhs.AsNumber();
+    const auto right_number = rhs.AsNumber();
+    int64_t result = 0;
+    if (left_number && right_number
+        && runtime::CheckedArithmetic(operation, *left_number, *right_number, result)) {
+        return Temporary(result);
+    }
+    if (operation == runtime::ArithmeticOperation::ADD) {
+        const auto* left_string = lhs.AsString();
+        const auto* right_string = rhs.AsString();
+        if (left_string && right_string) {
+            return Temporary(runtime::String::Concat(*left_string, *right_string));
+        }
+    }
+    return Temporary(ArithmeticObjects(operation, lhs.Box(), rhs.Box(), context));
+}
+
+ObjectHolder CompareTemporaries(runtime::CompareOperation operation, const Temporary& lhs,
+                                const Temporary& rhs, Context& context) {
+    const auto left_number = lhs.AsNumber();
+    const auto right_number = rhs.AsNumber();
+    if (left_number && right_number) {
+        return runtime::MakeBool(ApplyComparison(operation, *left_number, *right_number));
+    }
+    const auto* left_string = lhs.AsString();
+    const auto* right_string = rhs.AsString();
+    if (left_string && right_string) {
+        return runtime::MakeBool(ApplyComparison(operation, left_string->GetValue(),
+                                                 right_string->GetValue()));
+    }
+    return CompareObjects(operation, lhs.Box(), rhs.Box(), context);
+}
+
+// Returns the value of str: a number or a string stays unboxed
+Temporary StringOf(const Temporary& value, Context& context) {
+    if (const auto number = value.AsNumber()) {
+        return Temporary(runtime::String(std::to_string(*number)));
+    }
+    if (const auto* string = value.AsString()) {
+        return Temporary(*string);
+    }
+    return Temporary(StringValue(value.Box(), context));
+}
+
+// Calculates the operation on the operands proven to be two Numbers or, for addition,
+// two Strings, without checking their types
+ObjectHolder ProvenArithmetic(Operands operands, runtime::ArithmeticOperation operation,
+                              const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
+    if (operands == Operands::STRINGS) {
+        return ObjectHolder::Own(runtime::String::Concat(CastTo<runtime::String>(lhs),
+                                                         CastTo<runtime::String>(rhs)));
+    }
+    int64_t result = 0;
+    if (runtime::CheckedArithmetic(operation, CastTo<runtime::Number>(lhs).GetValue(),
+                                   CastTo<runtime::Number>(rhs).GetValue(), result)) {
+        return runtime::MakeNumber(result);
+    }
+    // the overflow and the division by zero
+    return ArithmeticObjects(operation, lhs, rhs, context);
+}
+
+ObjectHolder ProvenComparison(Operands operands, runtime::CompareOperation operation,
+                              const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    if (operands == Operands::STRINGS) {
+        return runtime::MakeBool(ApplyComparison(operation, CastTo<runtime::String>(lhs).GetValue(),
+                                                 CastTo<runtime::String>(rhs).GetValue()));
+    }
+    return runtime::MakeBool(ApplyComparison(operation, CastTo<runtime::Number>(lhs).GetValue(),
+                                             CastTo<runtime::Number>(rhs).GetValue()));
+}
 }  // namespace
 
+const ObjectHolder& LoadVariable(const Closure& closure, const std::string& name) {
+    auto it = closure.find(name);
+    if (it == closure.end() || it->second.Get() == runtime::Unbound().Get()) {
+        throw std::runtime_error("Variable "s + name + " not found"s);
+    }
+    return it->second;
+}
+
+const ObjectHolder& LoadField(const ObjectHolder& object, const std::string& field,
+                              const std::string& object_name) {
+    auto obj = object.TryAs<runtime::ClassInstance>();
+    if (!obj) {
+        throw std::runtime_error("Variable " + object_name + " is not class"s);
+    }
+    auto& fields = obj->Fields();
+    auto field_it = fields.find(field);
+    if (field_it == fields.end()) {
+        throw std::runtime_error("Variable "s + field + " not found"s);
+    }
+    return field_it->second;
+}
+
+runtime::ClassInstance& FieldOwner(const ObjectHolder& object) {
+    auto obj = object.TryAs<runtime::ClassInstance>();
+    if (!obj) {
+        throw runtime_error("Object is not class!"s);
+    }
+    return *obj;
+}
+
+void PrintValue(const ObjectHolder& value, Context& context) {
+    auto &os = context.GetOutputStream();
+    if (value) {
+        value->Print(os, context);
+    } else {
+        os << EMPTY_OBJECT;
+    }
+}
+
+void CheckMethodReceiver(const ObjectHolder& object) {
+    if (!object.TryAs<runtime::ClassInstance>() && !object.TryAs<runtime::Dict>()) {
+        throw std::runtime_error("Object is not class instance"s);
+    }
+}
+
+ObjectHolder CallMethod(const ObjectHolder& object, const std::string& method,
+                        const ObjectHolder* args, size_t count, Context& context) {
+    if (auto class_instance = object.TryAs<runtime::ClassInstance>()) {
+        return class_instance->Call(method, args, count, context);
+    }
+    if (auto dict = object.TryAs<runtime::Dict>()) {
+        return dict->Call(method, args, count, context);
+    }
+    throw std::runtime_error("Object is not class instance"s);
+}
+
+ObjectHolder StringValue(const ObjectHolder& obj, Context& context) {
+    if (obj) {
+        std::ostringstream os;
+        obj->Print(os, context);
+        return ObjectHolder::Own(runtime::String(os.str()));
+    } else {
+        return ObjectHolder::Own(runtime::String(EMPTY_OBJECT));
+    }
+}
+
+const runtime::String& SeparatorOf(const ObjectHolder& separator_holder) {
+    auto separator = separator_holder.TryAs<runtime::String>();
+    if (!separator) {
+        throw std::runtime_error("Separator of join must be a string"s);
+    }
+    return *separator;
+}
+
+ObjectHolder JoinValues(const runtime::String& separator, ObjectHolder iterable, Context& context) {
+    std::ostringstream os;
+    bool first = true;
+    runtime::Iterate(std::move(iterable), context, [&](const ObjectHolder& item) {
+        if (!first) {
+            os << separator.GetValue();
+        }
+        if (item) {
+            item->Print(os, context);
+        } else {
+            os << EMPTY_OBJECT;
+        }
+        first = false;
+        return true;
+    });
+    return ObjectHolder::Own(runtime::String(os.str()));
+}
+
+ObjectHolder MakeRange(const ObjectHolder& start, const ObjectHolder& stop) {
+    auto start_number = start.TryAs<runtime::Number>();
+    auto stop_number = stop.TryAs<runtime::Number>();
+    if (!start_number || !stop_number) {
+        throw std::runtime_error("Range bounds must be numbers"s);
+    }
+    return ObjectHolder::Own(runtime::Range(start_number->GetValue(), stop_number->GetValue()));
+}
+
+ObjectHolder CompareObjects(runtime::CompareOperation operation, const ObjectHolder& lhs,
+                            const ObjectHolder& rhs, Context& context) {
+    if (IsNumber(lhs) && IsNumber(rhs)) {
+        return runtime::MakeBool(ApplyComparison(operation, CastTo<runtime::Number>(lhs).GetValue(),
+                                                 CastTo<runtime::Number>(rhs).GetValue()));
+    }
+    return runtime::MakeBool(runtime::Compare(operation, lhs, rhs, context));
+}
+
+Quickening::Operands Quickening::Classify(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+    const auto kind = runtime::GetKind(lhs);
+    if (kind != runtime::GetKind(rhs)) {
+        return Operands::OTHER;
+    }
+    if (kind == runtime::ValueKind::NUMBER) {
+        return Operands::NUMBERS;
+    }
+    if (kind == runtime::ValueKind::STRING) {
+        return Operands::STRINGS;
+    }
+    return Operands::OTHER;
+}
+
+void Quickening::Record(Operands operands) {
+    if (operands == Operands::OTHER || (executions_ > 0 && operands != operands_)) {
+        state_ = State::GENERIC;
+        return;
+    }
+    operands_ = operands;
+    if (++executions_ == THRESHOLD) {
+        state_ = State::SPECIALIZED;
+        if (operands == Operands::NUMBERS) {
+            ++quickening_stats.specialized_numbers;
+        } else {
+            ++quickening_stats.specialized_strings;
+        }
+    }
+}
+
+void Quickening::Prove(Operands operands) {
+    state_ = State::PROVEN;
+    operands_ = operands;
+    ++quickening_stats.proven;
+}
+
+void Quickening::Deoptimize() {
+    state_ = State::GENERIC;
+    ++quickening_stats.deoptimized;
+}
+
 ObjectHolder Assignment::Execute(Closure &closure, Context &context) {
     closure[var_] = rv_->Execute(closure, context);
     return closure.at(var_);
@@ -35,25 +464,20 @@ VariableValue::VariableValue(const std::string& var_name)
 VariableValue::VariableValue(std::vector<std::string> dotted_ids) {
     if (auto size = dotted_ids.size(); size > 0) {
         var_name_ = std::move(dotted_ids.at(0));
-        tail_.resize(size - 1);
-        std::move(std::next(dotted_ids.begin()), dotted_ids.end(), tail_.begin());
+        fields_.resize(size - 1);
+        std::move(std::next(dotted_ids.begin()), dotted_ids.end(), fields_.begin());
     }
 }
 
-ObjectHolder VariableValue::Execute(Closure &closure, Context &context) {
-    if (closure.count(var_name_)) {
-        auto result = closure.at(var_name_);
-        if (tail_.size() > 0) {
-            if (auto obj = result.TryAs<runtime::ClassInstance>()) {
-                return VariableValue(tail_).Execute(obj->Fields(), context);
-            } else {
-                throw std::runtime_error("Variable " + var_name_+ " is not class"s);
-            }
-        }
-        return result;
-    } else {
-        throw std::runtime_error("Variable "s + var_name_ + " not found"s);
+ObjectHolder VariableValue::Execute(Closure &closure, [[maybe_unused]] Context &context) {
+    // nothing is executed between the hops, so the holders stay in place and are not copied
+    const ObjectHolder* result = &LoadVariable(closure, var_name_);
+    const std::string* name = &var_name_;
+    for (const auto& field : fields_) {
+        result = &LoadField(*result, field, *name);
+        name = &field;
     }
+    return *result;
 }
 
 unique_ptr<Print> Print::Variable(const std::string &name) {
@@ -69,21 +493,7 @@ Print::Print(vector<unique_ptr<Statement>> args)
 }
 
 ObjectHolder Print::Execute(Closure &closure, Context &context) {
-    bool first = true;
-    auto &os = context.GetOutputStream();
-    for (auto &arg : args_) {
-        if (!first) {
-            os << " "s;
-        }
-        auto obj = arg->Execute(closure, context);
-        if (obj) {
-            obj->Print(os, context);
-        } else {
-            os << EMPTY_OBJECT;
-        }
-        first = false;
-    }
-    os << "\n"s;
+    PrintValues(args_, closure, context);
     return {};
 }
 
@@ -93,89 +503,242 @@ MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
 }
 
 ObjectHolder MethodCall::Execute(Closure &closure, Context &context) {
+    return CallWithArguments(object_->Execute(closure, context), method_, args_, closure, context);
+}
 
-    if (auto class_instance =
-        object_->Execute(closure, context).TryAs<runtime::ClassInstance>()) {
-        std::vector<runtime::ObjectHolder> actual_args;
-        for (auto &arg : args_) {
-            actual_args.push_back(arg->Execute(closure, context));
-        }
-        return class_instance->Call(method_, actual_args, context);
-    } else {
-        throw std::runtime_error("Object is not class instance"s);
+ObjectHolder MethodCall::ExecuteTail(Closure &closure, Context &context) {
+    auto object = object_->Execute(closure, context);
+    if (PrepareTailCall(object, method_, args_, closure, context)) {
+        return ObjectHolder::None();
     }
+    return CallWithArguments(object, method_, args_, closure, context);
 }
 
 ObjectHolder Stringify::Execute(Closure &closure, Context &context) {
-    auto obj = argument_->Execute(closure, context);
-    if (obj) {
-        std::ostringstream os;
-        obj->Print(os, context);
-        return ObjectHolder::Own(runtime::String(os.str()));
-    } else {
-        return ObjectHolder::Own(runtime::String(EMPTY_OBJECT));
-    }
+    return Calculate(closure, context).Box();
+}
+
+Join::Join(std::unique_ptr<Statement> separator, std::unique_ptr<Statement> iterable)
+    : separator_{std::move(separator)}, iterable_{std::move(iterable)} {
 }
 
-#define BINARY_OPERATION(type, operation) {                                        \
-    auto l = left_holder.TryAs<type>();                                            \
-    auto r = right_holder.TryAs<type>();                                           \
-    if (l && r) {                                                                  \
-        return ObjectHolder::Own(type(l->GetValue() operation r->GetValue()));     \
+ObjectHolder Join::Execute(Closure &closure, Context &context) {
+    auto separator_holder = separator_->Execute(closure, context);
+    return JoinValues(SeparatorOf(separator_holder), iterable_->Execute(closure, context), context);
+}
+
+#define QUICKENED_NUMERIC_OPERATION(operation) {                                   \
+    if (quickening_.GetSpecialization() == Operands::NUMBERS) {                    \
+        if (auto result = QuickArithmetic(quickening_, operation, left_holder, right_holder)) { \
+            return result;                                                         \
+        }                                                                          \
+    } else {                                                                       \
+        quickening_.Observe(left_holder, right_holder);                            \
     }                                                                              \
 }
 
+#define NUMERIC_OPERATION(operation) {                                             \
+    auto result = NumberArithmetic(operation, left_holder, right_holder);           \
+    if (result) {                                                                  \
+        return result;                                                             \
+    }                                                                              \
+    result = runtime::IntegerArithmetic(operation, left_holder, right_holder); \
+    if (result) {                                                                  \
+        return result;                                                             \
+    }                                                                              \
+    result = runtime::FloatArithmetic(operation, left_holder, right_holder);       \
+    if (result) {                                                                  \
+        return result;                                                             \
+    }                                                                              \
+}
+
+ObjectHolder AddObjects(const ObjectHolder& left_holder, const ObjectHolder& right_holder,
+                        Context& context) {
+    NUMERIC_OPERATION(runtime::ArithmeticOperation::ADD);
+    {
+        auto l = left_holder.TryAs<runtime::String>();
+        auto r = right_holder.TryAs<runtime::String>();
+        if (l && r) {
+            return ObjectHolder::Own(runtime::String::Concat(*l, *r));
+        }
+    }
+    if (auto left_class = left_holder.TryAs<runtime::ClassInstance>()) {
+        return left_class->Call(runtime::SpecialMethod::ADD, &right_holder, 1, context);
+    }
+    throw std::runtime_error("Can add only numbers, strings and class instances with "s
+                             + runtime::GetSpecialMethodName(runtime::SpecialMethod::ADD));
+}
+
+ObjectHolder SubtractObjects(const ObjectHolder& left_holder, const ObjectHolder& right_holder,
+                             Context& context) {
+    NUMERIC_OPERATION(runtime::ArithmeticOperation::SUB);
+    if (auto left_class = left_holder.TryAs<runtime::ClassInstance>()) {
+        return left_class->Call(runtime::SpecialMethod::SUB, &right_holder, 1, context);
+    }
+    throw std::runtime_error("Can subtract only numbers and class instances with "s
+                             + runtime::GetSpecialMethodName(runtime::SpecialMethod::SUB));
+}
+
+ObjectHolder MultiplyObjects(const ObjectHolder& left_holder, const ObjectHolder& right_holder,
+                             Context& context) {
+    NUMERIC_OPERATION(runtime::ArithmeticOperation::MULT);
+    if (auto left_class = left_holder.TryAs<runtime::ClassInstance>()) {
+        return left_class->Call(runtime::SpecialMethod::MULT, &right_holder, 1, context);
+    }
+    throw std::runtime_error("Can multiply only numbers and class instances with "s
+                             + runtime::GetSpecialMethodName(runtime::SpecialMethod::MULT));
+}
+
+ObjectHolder DivideObjects(const ObjectHolder& left_holder, const ObjectHolder& right_holder,
+                           [[maybe_unused]] Context& context) {
+    NUMERIC_OPERATION(runtime::ArithmeticOperation::DIV);
+    throw std::runtime_error("Can divide only numbers"s);
+}
+
 ObjectHolder Add::Execute(Closure &closure, Context &context)
 {
+    if (HasOperatorOperand()) {
+        return Calculate(closure, context).Box();
+    }
     ObjectHolder left_holder = lhs_->Execute(closure, context);
     ObjectHolder right_holder = rhs_->Execute(closure, context);
-    BINARY_OPERATION(runtime::Number, +);
-    BINARY_OPERATION(runtime::String, +);
-    if (auto left_class = left_holder.TryAs<runtime::ClassInstance>()) {
-        return left_class->Call(ADD_METHOD, {right_holder}, context);
+    if (quickening_.IsProven()) {
+        return ProvenArithmetic(quickening_.GetSpecialization(), runtime::ArithmeticOperation::ADD,
+                                left_holder, right_holder, context);
     }
-    throw std::runtime_error("Can add only numbers, strings and class instances with "s + ADD_METHOD);
+    if (quickening_.GetSpecialization() == Operands::STRINGS) {
+        if (IsString(left_holder) && IsString(right_holder)) {
+            return ObjectHolder::Own(runtime::String::Concat(CastTo<runtime::String>(left_holder),
+                                                             CastTo<runtime::String>(right_holder)));
+        }
+        quickening_.Deoptimize();
+    }
+    QUICKENED_NUMERIC_OPERATION(runtime::ArithmeticOperation::ADD);
+    return AddObjects(left_holder, right_holder, context);
 }
 
 ObjectHolder Sub::Execute(Closure &closure, Context &context)
 {
+    if (HasOperatorOperand()) {
+        return Calculate(closure, context).Box();
+    }
     ObjectHolder left_holder = lhs_->Execute(closure, context);
     ObjectHolder right_holder = rhs_->Execute(closure, context);
-    BINARY_OPERATION(runtime::Number, -);
-    throw std::runtime_error("Can subtract only numbers"s);
+    if (quickening_.IsProven()) {
+        return ProvenArithmetic(quickening_.GetSpecialization(), runtime::ArithmeticOperation::SUB,
+                                left_holder, right_holder, context);
+    }
+    QUICKENED_NUMERIC_OPERATION(runtime::ArithmeticOperation::SUB);
+    return SubtractObjects(left_holder, right_holder, context);
 }
 
 ObjectHolder Mult::Execute(Closure &closure, Context &context)
 {
+    if (HasOperatorOperand()) {
+        return Calculate(closure, context).Box();
+    }
     ObjectHolder left_holder = lhs_->Execute(closure, context);
     ObjectHolder right_holder = rhs_->Execute(closure, context);
-    BINARY_OPERATION(runtime::Number, *);
-    throw std::runtime_error("Can multiply only numbers"s);
+    if (quickening_.IsProven()) {
+        return ProvenArithmetic(quickening_.GetSpecialization(), runtime::ArithmeticOperation::MULT,
+                                left_holder, right_holder, context);
+    }
+    QUICKENED_NUMERIC_OPERATION(runtime::ArithmeticOperation::MULT);
+    return MultiplyObjects(left_holder, right_holder, context);
 }
 
 ObjectHolder Div::Execute(Closure &closure, Context &context)
 {
+    if (HasOperatorOperand()) {
+        return Calculate(closure, context).Box();
+    }
     ObjectHolder left_holder = lhs_->Execute(closure, context);
     ObjectHolder right_holder = rhs_->Execute(closure, context);
-    auto right = right_holder.TryAs<runtime::Number>();
-    if (right && right->GetValue() == 0) {
-        throw runtime_error("Division by zero"s);
+    if (quickening_.IsProven()) {
+        return ProvenArithmetic(quickening_.GetSpecialization(), runtime::ArithmeticOperation::DIV,
+                                left_holder, right_holder, context);
     }
-    BINARY_OPERATION(runtime::Number, /);
-    throw std::runtime_error("Can divide only numbers"s);
+    QUICKENED_NUMERIC_OPERATION(runtime::ArithmeticOperation::DIV);
+    return DivideObjects(left_holder, right_holder, context);
+}
+
+#undef NUMERIC_OPERATION
+#undef QUICKENED_NUMERIC_OPERATION
+
+std::optional<int64_t> Temporary::AsNumber() const {
+    if (unboxed_number_) {
+        return number_;
+    }
+    if (IsNumber(object_)) {
+        return CastTo<runtime::Number>(object_).GetValue();
+    }
+    return std::nullopt;
+}
+
+const runtime::String* Temporary::AsString() const {
+    if (string_) {
+        return &*string_;
+    }
+    return IsString(object_) ? &CastTo<runtime::String>(object_) : nullptr;
+}
+
+ObjectHolder Temporary::Box() const {
+    if (unboxed_number_) {
+        return runtime::MakeNumber(number_);
+    }
+    if (string_) {
+        return ObjectHolder::Own(runtime::String(*string_));
+    }
+    return object_;
+}
+
+Temporary Operator::Calculate(Closure& closure, Context& context) {
+    return Temporary(Execute(closure, context));
+}
+
+Temporary Add::Calculate(Closure& closure, Context& context) {
+    const Temporary lhs = CalculateOperand(*lhs_, lhs_operator_, closure, context);
+    const Temporary rhs = CalculateOperand(*rhs_, rhs_operator_, closure, context);
+    return CalculateArithmetic(runtime::ArithmeticOperation::ADD, lhs, rhs, context);
 }
 
-#undef BINARY_OPERATION
+Temporary Sub::Calculate(Closure& closure, Context& context) {
+    const Temporary lhs = CalculateOperand(*lhs_, lhs_operator_, closure, context);
+    const Temporary rhs = CalculateOperand(*rhs_, rhs_operator_, closure, context);
+    return CalculateArithmetic(runtime::ArithmeticOperation::SUB, lhs, rhs, context);
+}
+
+Temporary Mult::Calculate(Closure& closure, Context& context) {
+    const Temporary lhs = CalculateOperand(*lhs_, lhs_operator_, closure, context);
+    const Temporary rhs = CalculateOperand(*rhs_, rhs_operator_, closure, context);
+    return CalculateArithmetic(runtime::ArithmeticOperation::MULT, lhs, rhs, context);
+}
+
+Temporary Div::Calculate(Closure& closure, Context& context) {
+    const Temporary lhs = CalculateOperand(*lhs_, lhs_operator_, closure, context);
+    const Temporary rhs = CalculateOperand(*rhs_, rhs_operator_, closure, context);
+    return CalculateArithmetic(runtime::ArithmeticOperation::DIV, lhs, rhs, context);
+}
+
+Temporary Stringify::Calculate(Closure& closure, Context& context) {
+    return StringOf(CalculateOperand(*argument_, argument_operator_, closure, context), context);
+}
 
 ObjectHolder Compound::Execute(Closure &closure, Context &context) {
     for (auto &arg : args_) {
         arg->Execute(closure, context);
+        if (pending_return.active) {
+            break;
+        }
     }
     return ObjectHolder::None();
 }
 
 ObjectHolder Return::Execute(Closure &closure, Context &context) {
-    throw statement_->Execute(closure, context);
+    pending_return.value = tail_call_ ? tail_call_->ExecuteTail(closure, context)
+                                      : statement_->Execute(closure, context);
+    pending_return.active = true;
+    return ObjectHolder::None();
 }
 
 ClassDefinition::ClassDefinition(ObjectHolder cls)
@@ -193,12 +756,9 @@ FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
 }
 
 ObjectHolder FieldAssignment::Execute(Closure &closure, Context &context) {
-    auto obj = object_.Execute(closure, context).TryAs<runtime::ClassInstance>();
-    if (obj) {
-        return obj->Fields()[field_name_] = rv_->Execute(closure, context);
-    } else {
-        throw runtime_error("Object is not class!"s);
-    }
+    auto object = object_.Execute(closure, context);
+    auto& fields = FieldOwner(object).Fields();
+    return fields[field_name_] = rv_->Execute(closure, context);
 }
 
 IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
@@ -209,7 +769,8 @@ IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement>
 }
 
 ObjectHolder IfElse::Execute(Closure &closure, Context &context) {
-    if (runtime::IsTrue(condition_->Execute(closure, context))) {
+    const auto condition = condition_->Execute(closure, context);
+    if (bool_condition_ ? CastTo<runtime::Bool>(condition).GetValue() : runtime::IsTrue(condition)) {
         return if_body_->Execute(closure, context);
     } else if (else_body_) {
         return else_body_->Execute(closure, context);
@@ -217,42 +778,85 @@ ObjectHolder IfElse::Execute(Closure &closure, Context &context) {
      return runtime::ObjectHolder::None();
 }
 
+ForIn::ForIn(std::string var, std::unique_ptr<Statement> iterable, std::unique_ptr<Statement> body)
+    : var_{std::move(var)}, iterable_{std::move(iterable)}, body_{std::move(body)} {
+}
+
+ObjectHolder ForIn::Execute(Closure &closure, Context &context) {
+    auto &value = closure[var_];
+    runtime::Iterate(iterable_->Execute(closure, context), context,
+                     [&](ObjectHolder item) {
+                         value = std::move(item);
+                         body_->Execute(closure, context);
+                         return !pending_return.active;
+                     });
+    return ObjectHolder::None();
+}
+
 ObjectHolder Or::Execute(Closure &closure, Context &context) {
     if (runtime::IsTrue(lhs_->Execute(closure, context)))
         {
-            return ObjectHolder::Own(runtime::Bool(true));
+            return runtime::MakeBool(true);
         }
-        return ObjectHolder::Own(runtime::Bool(runtime::IsTrue
-                                               (rhs_->Execute(closure, context))));
+        return runtime::MakeBool(runtime::IsTrue(rhs_->Execute(closure, context)));
 }
 
 ObjectHolder And::Execute(Closure &closure, Context &context) {
     if (runtime::IsTrue(lhs_->Execute(closure, context)))
         {
-        return ObjectHolder::Own(runtime::Bool(runtime::IsTrue
-                                               (rhs_->Execute(closure, context))));
+        return runtime::MakeBool(runtime::IsTrue(rhs_->Execute(closure, context)));
         }
-        return ObjectHolder::Own(runtime::Bool(false));
+        return runtime::MakeBool(false);
 }
 
 ObjectHolder Not::Execute(Closure &closure, Context &context) {
     bool result = !runtime::IsTrue(argument_->Execute(closure, context));
-    return ObjectHolder::Own(runtime::Bool(result));
+    return runtime::MakeBool(result);
 }
 
-Comparison::Comparison(Comparator cmp, unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
-    : BinaryOperation(std::move(lhs), std::move(rhs)) {
-    cmp_ = std::move(cmp);
+Comparison::Comparison(runtime::CompareOperation operation, unique_ptr<Statement> lhs,
+                       unique_ptr<Statement> rhs)
+    : BinaryOperation(std::move(lhs), std::move(rhs)), operation_{operation} {
 }
 
 ObjectHolder Comparison::Execute(Closure &closure, Context &context) {
-    auto result = cmp_(lhs_->Execute(closure, context), rhs_->Execute(closure, context), context);
-    return runtime::ObjectHolder::Own(runtime::Bool(result));
+    if (HasOperatorOperand()) {
+        const Temporary lhs = CalculateOperand(*lhs_, lhs_operator_, closure, context);
+        const Temporary rhs = CalculateOperand(*rhs_, rhs_operator_, closure, context);
+        return CompareTemporaries(operation_, lhs, rhs, context);
+    }
+    auto lhs = lhs_->Execute(closure, context);
+    auto rhs = rhs_->Execute(closure, context);
+    if (quickening_.IsProven()) {
+        return ProvenComparison(quickening_.GetSpecialization(), operation_, lhs, rhs);
+    }
+    switch (quickening_.GetSpecialization()) {
+        case Operands::NUMBERS:
+            if (IsNumber(lhs) && IsNumber(rhs)) {
+                return runtime::MakeBool(ApplyComparison(operation_,
+                                                         CastTo<runtime::Number>(lhs).GetValue(),
+                                                         CastTo<runtime::Number>(rhs).GetValue()));
+            }
+            quickening_.Deoptimize();
+            break;
+        case Operands::STRINGS:
+            if (IsString(lhs) && IsString(rhs)) {
+                return runtime::MakeBool(ApplyComparison(operation_,
+                                                         CastTo<runtime::String>(lhs).GetValue(),
+                                                         CastTo<runtime::String>(rhs).GetValue()));
+            }
+            quickening_.Deoptimize();
+            break;
+        case Operands::OTHER:
+            quickening_.Observe(lhs, rhs);
+            break;
+    }
+    return runtime::MakeBool(runtime::Compare(operation_, lhs, rhs, context));
 }
 
 NewInstance::NewInstance(const runtime::Class& class_,
                          std::vector<std::unique_ptr<Statement>> args)
-    : class_instance_{class_}, args_{std::move(args)} {
+    : class_{class_}, args_{std::move(args)} {
 }
 
 NewInstance::NewInstance(const runtime::Class &class_)
@@ -260,29 +864,659 @@ NewInstance::NewInstance(const runtime::Class &class_)
 }
 
 ObjectHolder NewInstance::Execute(Closure &closure, Context &context) {
-    if (class_instance_.HasMethod(INIT_METHOD, args_.size())) {
-        std::vector<runtime::ObjectHolder> actual_args;
-        for (auto &arg : args_) {
-            actual_args.push_back(arg->Execute(closure, context));
+    return CreateInstance(class_, args_, closure, context);
+}
+
+NewRange::NewRange(std::unique_ptr<Statement> start, std::unique_ptr<Statement> stop)
+    : start_{std::move(start)}, stop_{std::move(stop)} {
+}
+
+ObjectHolder NewRange::Execute(Closure &closure, Context &context) {
+    auto start = start_->Execute(closure, context);
+    auto stop = stop_->Execute(closure, context);
+    return MakeRange(start, stop);
+}
+
+ObjectHolder NewDict::Execute([[maybe_unused]] Closure &closure,
+                              [[maybe_unused]] Context &context) {
+    return ObjectHolder::Own(runtime::Dict());
+}
+
+MethodBody::MethodBody(std::unique_ptr<Statement> &&body, std::string name)
+    : body_{std::move(body)}, name_{std::move(name)} {
+}
+
+ObjectHolder MethodBody::Execute(Closure &closure, Context &context) {
+    // a body lowered by Compile ahead of the execution still becomes machine code once it is hot
+    if (!native_body_ && tiering.threshold != 0 && calls_ < tiering.threshold
+        && ++calls_ == tiering.threshold) {
+        if (jit.enabled) {
+            native_body_ = CompileNative(*this);
+        }
+        if (native_body_) {
+            ++tiering.compiled_methods;
+        } else if (!compiled_body_) {
+            compiled_body_ = body_->Compile();
+            ++tiering.compiled_methods;
+        }
+    }
+    if (native_body_) {
+        // the machine code makes its recursive tail calls itself
+        return native_body_(closure, context);
+    }
+
+    struct ExecutingBody {
+        explicit ExecutingBody(const MethodBody* body)
+            : enclosing{std::exchange(executing_body, body)} {
+        }
+        ~ExecutingBody() {
+            executing_body = enclosing;
+        }
+        const MethodBody* enclosing;
+    } executing{this};
+
+    while (true) {
+        if (compiled_body_) {
+            compiled_body_(closure, context);
+        } else {
+            body_->Execute(closure, context);
+        }
+        if (!pending_tail_call.active) {
+            break;
+        }
+        // the frame is rebound as if the call had got a fresh one
+        pending_tail_call.active = false;
+        pending_return.active = false;
+        for (auto& [name, value] : closure) {
+            value = runtime::Unbound();
+        }
+        closure["self"s] = std::move(pending_tail_call.self);
+        const auto& params = pending_tail_call.method->formal_params;
+        for (size_t i = 0; i < params.size(); ++i) {
+            closure[params[i]] = std::move(pending_tail_call.args[i]);
+        }
+    }
+    if (pending_return.active) {
+        pending_return.active = false;
+        return std::move(pending_return.value);
+    }
+    return runtime::ObjectHolder::None();
+}
+
+/*
+ * Purity analysis, see runtime::Memoization. It only looks at the tree: a statement is pure
+ * if it is made of pure statements and is not one of those with effects (print, field
+ * assignment, instance or dictionary creation, class definition)
+ */
+
+namespace {
+// The method bodies being checked, with the classes they are checked on.
+// A recursive call of one of them is assumed to be pure
+std::vector<std::pair<const MethodBody*, const runtime::Class*>> checked_bodies;
+
+bool AllPure(const std::vector<std::unique_ptr<Statement>>& statements, const runtime::Class& cls) {
+    return std::all_of(statements.begin(), statements.end(), [&cls](const auto& statement) {
+        return statement->IsPure(cls);
+    });
+}
+}  // namespace
+
+bool VariableValue::IsPure([[maybe_unused]] const runtime::Class& cls) const {
+    return fields_.empty() && var_name_ != "self"sv;
+}
+
+bool Assignment::IsPure(const runtime::Class& cls) const {
+    return rv_->IsPure(cls);
+}
+
+bool MethodCall::IsPure(const runtime::Class& cls) const {
+    const auto* object = dynamic_cast<const VariableValue*>(object_.get());
+    if (object == nullptr || !object->IsVariable("self"s)) {
+        return false;
+    }
+    const auto* method = cls.GetMethod(method_);
+    return method != nullptr && method->formal_params.size() == args_.size()
+        && AllPure(args_, cls) && method->body->IsPure(cls);
+}
+
+bool NewRange::IsPure(const runtime::Class& cls) const {
+    return start_->IsPure(cls) && stop_->IsPure(cls);
+}
+
+bool UnaryOperation::IsPure(const runtime::Class& cls) const {
+    return argument_->IsPure(cls);
+}
+
+bool Join::IsPure(const runtime::Class& cls) const {
+    return separator_->IsPure(cls) && iterable_->IsPure(cls);
+}
+
+bool BinaryOperation::IsPure(const runtime::Class& cls) const {
+    return lhs_->IsPure(cls) && rhs_->IsPure(cls);
+}
+
+bool Compound::IsPure(const runtime::Class& cls) const {
+    return AllPure(args_, cls);
+}
+
+bool MethodBody::IsPure(const runtime::Class& cls) const {
+    const std::pair checked{this, &cls};
+    if (std::find(checked_bodies.begin(), checked_bodies.end(), checked) != checked_bodies.end()) {
+        return true;
+    }
+    checked_bodies.push_back(checked);
+    const bool pure = body_->IsPure(cls);
+    checked_bodies.pop_back();
+    return pure;
+}
+
+bool Return::IsPure(const runtime::Class& cls) const {
+    return statement_->IsPure(cls);
+}
+
+bool IfElse::IsPure(const runtime::Class& cls) const {
+    return condition_->IsPure(cls) && if_body_->IsPure(cls)
+        && (!else_body_ || else_body_->IsPure(cls));
+}
+
+bool ForIn::IsPure(const runtime::Class& cls) const {
+    return iterable_->IsPure(cls) && body_->IsPure(cls);
+}
+
+size_t VariableValue::ExpressionSize() const {
+    return 1;
+}
+
+size_t UnaryOperation::ExpressionSize() const {
+    const size_t argument = argument_->ExpressionSize();
+    return argument == 0 ? 0 : argument + 1;
+}
+
+size_t BinaryOperation::ExpressionSize() const {
+    const size_t lhs = lhs_->ExpressionSize();
+    const size_t rhs = rhs_->ExpressionSize();
+    return lhs == 0 || rhs == 0 ? 0 : lhs + rhs + 1;
+}
+
+Statement* MethodBody::InlineExpression(size_t max_size) const {
+    const Statement* statement = body_.get();
+    if (const auto* compound = dynamic_cast<const Compound*>(statement)) {
+        if (compound->args_.size() != 1) {
+            return nullptr;
         }
-        class_instance_.Call(INIT_METHOD, actual_args, context);
+        statement = compound->args_.front().get();
+    }
+    const auto* return_statement = dynamic_cast<const Return*>(statement);
+    if (return_statement == nullptr) {
+        return nullptr;
     }
-    return runtime::ObjectHolder::Share(class_instance_);
+    const size_t size = return_statement->statement_->ExpressionSize();
+    return size != 0 && size <= max_size ? return_statement->statement_.get() : nullptr;
 }
 
-MethodBody::MethodBody(std::unique_ptr<Statement> &&body)
-    : body_{std::move(body)} {
+/*
+ * Closure compilation. Every statement is lowered into a callable bound to its data and
+ * to the callables of its children, so the program runs without the virtual Execute calls.
+ * The operands of the binary operations are specialized on their kind: a numeric constant
+ * or a variable is evaluated in place instead of through a callable of its own
+ */
+
+namespace {
+using runtime::Compiled;
+
+std::vector<Compiled> CompileAll(const std::vector<std::unique_ptr<Statement>>& statements) {
+    std::vector<Compiled> result;
+    result.reserve(statements.size());
+    for (const auto& statement : statements) {
+        result.push_back(statement->Compile());
+    }
+    return result;
 }
 
-ObjectHolder MethodBody::Execute(Closure &closure, Context &context) {
-    try {
-        body_->Execute(closure, context);
-        return runtime::ObjectHolder::None();
-    }  catch (runtime::ObjectHolder &result) {
-        return result;
-    }  catch (...) {
-        throw;
+struct ConstantOperand {
+    NumericConst* statement;
+
+    ObjectHolder operator()(Closure& closure, Context& context) const {
+        return statement->NumericConst::Execute(closure, context);
+    }
+};
+
+struct VariableOperand {
+    VariableValue* statement;
+
+    ObjectHolder operator()(Closure& closure, Context& context) const {
+        return statement->VariableValue::Execute(closure, context);
+    }
+};
+
+struct CompiledOperand {
+    Compiled code;
+
+    ObjectHolder operator()(Closure& closure, Context& context) const {
+        return code(closure, context);
+    }
+};
+
+// Calls make with the operand evaluating the statement
+template <typename Make>
+Compiled WithOperand(Statement& statement, Make make) {
+    if (auto constant = dynamic_cast<NumericConst*>(&statement)) {
+        return make(ConstantOperand{constant});
+    }
+    if (auto variable = dynamic_cast<VariableValue*>(&statement)) {
+        return make(VariableOperand{variable});
+    }
+    return make(CompiledOperand{statement.Compile()});
+}
+
+// Lowers a binary operation which calls apply(lhs, rhs, context) with the values of the operands
+template <typename Apply>
+Compiled CompileBinary(Statement& lhs, Statement& rhs, Apply apply) {
+    return WithOperand(lhs, [&](auto left) {
+        return WithOperand(rhs, [&](auto right) -> Compiled {
+            return [left, right, apply](Closure& closure, Context& context) {
+                ObjectHolder left_holder = left(closure, context);
+                ObjectHolder right_holder = right(closure, context);
+                return apply(left_holder, right_holder, context);
+            };
+        });
+    });
+}
+
+// Makes a function object of an operation on two values, so that the call is inlined
+template <ObjectHolder (*operation)(const ObjectHolder&, const ObjectHolder&, Context&)>
+struct Apply {
+    ObjectHolder operator()(const ObjectHolder& lhs, const ObjectHolder& rhs,
+                            Context& context) const {
+        return operation(lhs, rhs, context);
+    }
+};
+
+// Lowers an operand of an operator, see CalculateOperand
+CompiledTemporary CompileOperand(Statement& operand, Operator* as_operator) {
+    if (as_operator != nullptr) {
+        return as_operator->CompileCalculate();
+    }
+    return [code = operand.Compile()](Closure& closure, Context& context) {
+        return Temporary(code(closure, context));
+    };
+}
+
+CompiledTemporary CompileArithmetic(runtime::ArithmeticOperation operation, Statement& lhs,
+                                    Operator* lhs_operator, Statement& rhs,
+                                    Operator* rhs_operator) {
+    return [operation, lhs = CompileOperand(lhs, lhs_operator),
+            rhs = CompileOperand(rhs, rhs_operator)](Closure& closure, Context& context) {
+        const Temporary left = lhs(closure, context);
+        const Temporary right = rhs(closure, context);
+        return CalculateArithmetic(operation, left, right, context);
+    };
+}
+
+// Makes a function object of an arithmetic operation on the proven operands
+struct ApplyProven {
+    Operands operands;
+    runtime::ArithmeticOperation operation;
+
+    ObjectHolder operator()(const ObjectHolder& lhs, const ObjectHolder& rhs,
+                            Context& context) const {
+        return ProvenArithmetic(operands, operation, lhs, rhs, context);
+    }
+};
+
+/*
+ * Inline cache of a compiled method call, see Inlining. It is updated when the class of the
+ * receiver changes, and gives up on the call site once it has seen too many classes.
+ * The expression is evaluated in a frame of the cache, with self and the arguments bound.
+ * If the call site is reentered while the frame is in use, the call is made as usual
+ */
+class InlineCache {
+public:
+    explicit InlineCache(const std::string& method)
+        : method_{method} {
+    }
+
+    InlineCache(const InlineCache&) = delete;
+    InlineCache& operator=(const InlineCache&) = delete;
+
+    template <typename Args>
+    ObjectHolder Call(const ObjectHolder& object, const Args& args, Closure& closure,
+                      Context& context) {
+        CheckMethodReceiver(object);
+        const auto* instance = object.TryAs<runtime::ClassInstance>();
+        if (instance != nullptr && &instance->GetClass() != cls_ && updates_ < MAX_UPDATES
+            && !busy_) {
+            Update(instance->GetClass(), args.size());
+        }
+        StackArguments actual_args(args, closure, context);
+        if (instance == nullptr || &instance->GetClass() != cls_ || !expression_ || busy_) {
+            return CallMethod(object, method_, actual_args.Data(), actual_args.Size(), context);
+        }
+
+        struct BoundFrame {
+            explicit BoundFrame(InlineCache& cache)
+                : cache{cache} {
+                cache.busy_ = true;
+            }
+            ~BoundFrame() {
+                *cache.frame_.self = runtime::Unbound();
+                for (auto* param : cache.frame_.params) {
+                    *param = runtime::Unbound();
+                }
+                cache.busy_ = false;
+            }
+            InlineCache& cache;
+        } bound{*this};
+
+        *frame_.self = object;
+        for (size_t i = 0; i < frame_.params.size(); ++i) {
+            *frame_.params[i] = actual_args.Data()[i];
+        }
+        ++inlining.inlined_calls;
+        return expression_(frame_.closure, context);
+    }
+
+private:
+    static constexpr uint32_t MAX_UPDATES = 4;
+
+    void Update(const runtime::Class& cls, size_t argument_count) {
+        ++updates_;
+        cls_ = &cls;
+        expression_ = nullptr;
+        const auto* method = cls.GetMethod(method_);
+        if (method == nullptr || method->formal_params.size() != argument_count
+            || inlining.max_size == 0) {
+            return;
+        }
+        const auto* body = dynamic_cast<const MethodBody*>(method->body.get());
+        Statement* expression = body ? body->InlineExpression(inlining.max_size) : nullptr;
+        if (expression == nullptr) {
+            return;
+        }
+        expression_ = expression->Compile();
+        frame_ = runtime::Frame{};
+        frame_.self = &frame_.closure["self"s];
+        for (const auto& param : method->formal_params) {
+            frame_.params.push_back(&frame_.closure[param]);
+        }
+    }
+
+    const std::string& method_;
+    const runtime::Class* cls_ = nullptr;
+    uint32_t updates_ = 0;
+    Compiled expression_;
+    runtime::Frame frame_;
+    bool busy_ = false;
+};
+}  // namespace
+
+Compiled VariableValue::Compile() {
+    return [this](Closure& closure, Context& context) {
+        return VariableValue::Execute(closure, context);
+    };
+}
+
+Compiled Assignment::Compile() {
+    return [var = &var_, rv = rv_->Compile()](Closure& closure, Context& context) {
+        auto value = rv(closure, context);
+        return closure[*var] = std::move(value);
+    };
+}
+
+Compiled FieldAssignment::Compile() {
+    return [this, rv = rv_->Compile()](Closure& closure, Context& context) {
+        auto object = object_.VariableValue::Execute(closure, context);
+        auto& fields = FieldOwner(object).Fields();
+        return fields[field_name_] = rv(closure, context);
+    };
+}
+
+Compiled Print::Compile() {
+    return [args = CompileAll(args_)](Closure& closure, Context& context) {
+        PrintValues(args, closure, context);
+        return ObjectHolder::None();
+    };
+}
+
+Compiled MethodCall::Compile() {
+    return [object = object_->Compile(), args = CompileAll(args_),
+            cache = std::make_shared<InlineCache>(method_)](Closure& closure, Context& context) {
+        return cache->Call(object(closure, context), args, closure, context);
+    };
+}
+
+Compiled MethodCall::CompileTail() {
+    // an inlined method returns an expression without calls, so it is never the recursive one
+    return [object = object_->Compile(), method = &method_, args = CompileAll(args_),
+            cache = std::make_shared<InlineCache>(method_)](Closure& closure, Context& context) {
+        auto object_holder = object(closure, context);
+        if (PrepareTailCall(object_holder, *method, args, closure, context)) {
+            return ObjectHolder::None();
+        }
+        return cache->Call(object_holder, args, closure, context);
+    };
+}
+
+Compiled NewInstance::Compile() {
+    return [cls = &class_, args = CompileAll(args_)](Closure& closure, Context& context) {
+        return CreateInstance(*cls, args, closure, context);
+    };
+}
+
+Compiled NewRange::Compile() {
+    return [start = start_->Compile(), stop = stop_->Compile()](Closure& closure,
+                                                                Context& context) {
+        auto start_holder = start(closure, context);
+        auto stop_holder = stop(closure, context);
+        return MakeRange(start_holder, stop_holder);
+    };
+}
+
+Compiled Stringify::Compile() {
+    return [calculate = CompileCalculate()](Closure& closure, Context& context) {
+        return calculate(closure, context).Box();
+    };
+}
+
+CompiledTemporary Stringify::CompileCalculate() {
+    return [argument = CompileOperand(*argument_, argument_operator_)](Closure& closure,
+                                                                       Context& context) {
+        return StringOf(argument(closure, context), context);
+    };
+}
+
+Compiled Join::Compile() {
+    return [separator = separator_->Compile(), iterable = iterable_->Compile()](
+               Closure& closure, Context& context) {
+        auto separator_holder = separator(closure, context);
+        return JoinValues(SeparatorOf(separator_holder), iterable(closure, context), context);
+    };
+}
+
+Compiled Add::Compile() {
+    if (HasOperatorOperand()) {
+        return [calculate = CompileCalculate()](Closure& closure, Context& context) {
+            return calculate(closure, context).Box();
+        };
+    }
+    if (quickening_.IsProven()) {
+        return CompileBinary(*lhs_, *rhs_, ApplyProven{quickening_.GetSpecialization(),
+                                                       runtime::ArithmeticOperation::ADD});
+    }
+    return CompileBinary(*lhs_, *rhs_, Apply<AddObjects>{});
+}
+
+CompiledTemporary Add::CompileCalculate() {
+    return CompileArithmetic(runtime::ArithmeticOperation::ADD, *lhs_, lhs_operator_, *rhs_,
+                             rhs_operator_);
+}
+
+Compiled Sub::Compile() {
+    if (HasOperatorOperand()) {
+        return [calculate = CompileCalculate()](Closure& closure, Context& context) {
+            return calculate(closure, context).Box();
+        };
+    }
+    if (quickening_.IsProven()) {
+        return CompileBinary(*lhs_, *rhs_, ApplyProven{quickening_.GetSpecialization(),
+                                                       runtime::ArithmeticOperation::SUB});
+    }
+    return CompileBinary(*lhs_, *rhs_, Apply<SubtractObjects>{});
+}
+
+CompiledTemporary Sub::CompileCalculate() {
+    return CompileArithmetic(runtime::ArithmeticOperation::SUB, *lhs_, lhs_operator_, *rhs_,
+                             rhs_operator_);
+}
+
+Compiled Mult::Compile() {
+    if (HasOperatorOperand()) {
+        return [calculate = CompileCalculate()](Closure& closure, Context& context) {
+            return calculate(closure, context).Box();
+        };
+    }
+    if (quickening_.IsProven()) {
+        return CompileBinary(*lhs_, *rhs_, ApplyProven{quickening_.GetSpecialization(),
+                                                       runtime::ArithmeticOperation::MULT});
+    }
+    return CompileBinary(*lhs_, *rhs_, Apply<MultiplyObjects>{});
+}
+
+CompiledTemporary Mult::CompileCalculate() {
+    return CompileArithmetic(runtime::ArithmeticOperation::MULT, *lhs_, lhs_operator_, *rhs_,
+                             rhs_operator_);
+}
+
+Compiled Div::Compile() {
+    if (HasOperatorOperand()) {
+        return [calculate = CompileCalculate()](Closure& closure, Context& context) {
+            return calculate(closure, context).Box();
+        };
+    }
+    if (quickening_.IsProven()) {
+        return CompileBinary(*lhs_, *rhs_, ApplyProven{quickening_.GetSpecialization(),
+                                                       runtime::ArithmeticOperation::DIV});
+    }
+    return CompileBinary(*lhs_, *rhs_, Apply<DivideObjects>{});
+}
+
+CompiledTemporary Div::CompileCalculate() {
+    return CompileArithmetic(runtime::ArithmeticOperation::DIV, *lhs_, lhs_operator_, *rhs_,
+                             rhs_operator_);
+}
+
+Compiled Or::Compile() {
+    return [lhs = lhs_->Compile(), rhs = rhs_->Compile()](Closure& closure, Context& context) {
+        return runtime::MakeBool(runtime::IsTrue(lhs(closure, context))
+                                 || runtime::IsTrue(rhs(closure, context)));
+    };
+}
+
+Compiled And::Compile() {
+    return [lhs = lhs_->Compile(), rhs = rhs_->Compile()](Closure& closure, Context& context) {
+        return runtime::MakeBool(runtime::IsTrue(lhs(closure, context))
+                                 && runtime::IsTrue(rhs(closure, context)));
+    };
+}
+
+Compiled Not::Compile() {
+    return [argument = argument_->Compile()](Closure& closure, Context& context) {
+        return runtime::MakeBool(!runtime::IsTrue(argument(closure, context)));
+    };
+}
+
+Compiled Compound::Compile() {
+    return [statements = CompileAll(args_)](Closure& closure, Context& context) {
+        for (const auto& statement : statements) {
+            statement(closure, context);
+            if (pending_return.active) {
+                break;
+            }
+        }
+        return ObjectHolder::None();
+    };
+}
+
+CompiledTemporary Operator::CompileCalculate() {
+    return [code = Compile()](Closure& closure, Context& context) {
+        return Temporary(code(closure, context));
+    };
+}
+
+Compiled MethodBody::Compile() {
+    compiled_body_ = body_->Compile();
+    return [this](Closure& closure, Context& context) {
+        return MethodBody::Execute(closure, context);
+    };
+}
+
+Compiled Return::Compile() {
+    return [statement = tail_call_ ? tail_call_->CompileTail() : statement_->Compile()](
+               Closure& closure, Context& context) {
+        pending_return.value = statement(closure, context);
+        pending_return.active = true;
+        return ObjectHolder::None();
+    };
+}
+
+Compiled ClassDefinition::Compile() {
+    for (const auto& method : cls_.TryAs<runtime::Class>()->GetMethods()) {
+        method.body->Compile();
+    }
+    return [this](Closure& closure, Context& context) {
+        return ClassDefinition::Execute(closure, context);
+    };
+}
+
+Compiled IfElse::Compile() {
+    return [condition = condition_->Compile(), if_body = if_body_->Compile(),
+            else_body = else_body_ ? else_body_->Compile() : Compiled{},
+            bool_condition = bool_condition_](Closure& closure, Context& context) {
+        const auto value = condition(closure, context);
+        if (bool_condition ? CastTo<runtime::Bool>(value).GetValue() : runtime::IsTrue(value)) {
+            return if_body(closure, context);
+        } else if (else_body) {
+            return else_body(closure, context);
+        }
+        return ObjectHolder::None();
+    };
+}
+
+Compiled ForIn::Compile() {
+    return [var = &var_, iterable = iterable_->Compile(), body = body_->Compile()](
+               Closure& closure, Context& context) {
+        auto &value = closure[*var];
+        runtime::Iterate(iterable(closure, context), context, [&](ObjectHolder item) {
+            value = std::move(item);
+            body(closure, context);
+            return !pending_return.active;
+        });
+        return ObjectHolder::None();
+    };
+}
+
+Compiled Comparison::Compile() {
+    if (HasOperatorOperand()) {
+        return [operation = operation_, lhs = CompileOperand(*lhs_, lhs_operator_),
+                rhs = CompileOperand(*rhs_, rhs_operator_)](Closure& closure, Context& context) {
+            const Temporary left = lhs(closure, context);
+            const Temporary right = rhs(closure, context);
+            return CompareTemporaries(operation, left, right, context);
+        };
+    }
+    if (quickening_.IsProven()) {
+        return CompileBinary(*lhs_, *rhs_, [operands = quickening_.GetSpecialization(),
+                                            operation = operation_](const ObjectHolder& lhs,
+                                                                    const ObjectHolder& rhs,
+                                                                    Context& /*context*/) {
+            return ProvenComparison(operands, operation, lhs, rhs);
+        });
     }
+    return CompileBinary(*lhs_, *rhs_, [operation = operation_](const ObjectHolder& lhs,
+                                                                const ObjectHolder& rhs,
+                                                                Context& context) {
+        return CompareObjects(operation, lhs, rhs, context);
+    });
 }
 
 }  // namespace ast
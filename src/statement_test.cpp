@@ -80,6 +80,27 @@ void TestVariable() {
     ASSERT(context.output.str().empty());
 }
 
+void TestDottedVariable() {
+    runtime::DummyContext context;
+
+    runtime::Class point_class("Point"s, {}, nullptr);
+    runtime::ClassInstance circle{point_class};
+    runtime::ClassInstance center{point_class};
+    runtime::Number x(3);
+    center.Fields()["x"s] = ObjectHolder::Share(x);
+    circle.Fields()["center"s] = ObjectHolder::Share(center);
+
+    Closure closure = {{"circle"s, ObjectHolder::Share(circle)}};
+    VariableValue circle_center_x(vector<string>{"circle"s, "center"s, "x"s});
+    ASSERT(circle_center_x.Execute(closure, context).Get() == &x);
+    ASSERT(circle_center_x.Execute(closure, context).Get() == &x);
+
+    ASSERT_THROWS(VariableValue(vector<string>{"circle"s, "radius"s}).Execute(closure, context),
+                  std::runtime_error);
+    ASSERT_THROWS(VariableValue(vector<string>{"circle"s, "center"s, "x"s, "y"s}).Execute(closure, context),
+                  std::runtime_error);
+}
+
 void TestAssignment() {
     runtime::DummyContext context;
 
@@ -288,6 +309,76 @@ void TestClassInstanceAddWithoutMethod() {
     ASSERT(context.output.str().empty());
 }
 
+void TestQuickening() {
+    runtime::DummyContext context;
+    Closure closure;
+    const auto stats = quickening_stats;
+
+    Assignment sum("sum"s, make_unique<Add>(make_unique<VariableValue>("x"s),
+                                           make_unique<VariableValue>("y"s)));
+    Comparison less(runtime::CompareOperation::LESS, make_unique<VariableValue>("x"s),
+                    make_unique<VariableValue>("y"s));
+    for (int i = 0; i < 2 * static_cast<int>(Quickening::THRESHOLD); ++i) {
+        closure["x"s] = runtime::MakeNumber(i);
+        closure["y"s] = runtime::MakeNumber(2);
+        ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), i + 2);
+        ASSERT_EQUAL(runtime::IsTrue(less.Execute(closure, context)), i < 2);
+    }
+    ASSERT_EQUAL(quickening_stats.specialized_numbers, stats.specialized_numbers + 2);
+
+    // the overflow is handled by the generic path without deoptimization
+    closure["x"s] = runtime::MakeNumber(INT64_MAX);
+    ASSERT(sum.Execute(closure, context).TryAs<runtime::BigInt>());
+    ASSERT_EQUAL(quickening_stats.deoptimized, stats.deoptimized);
+
+    closure["x"s] = ObjectHolder::Own(runtime::String("a"s));
+    closure["y"s] = ObjectHolder::Own(runtime::String("b"s));
+    ASSERT_OBJECT_VALUE_EQUAL(sum.Execute(closure, context), "ab"s);
+    ASSERT(runtime::IsTrue(less.Execute(closure, context)));
+    ASSERT_EQUAL(quickening_stats.deoptimized, stats.deoptimized + 2);
+    ASSERT_EQUAL(quickening_stats.specialized_strings, stats.specialized_strings);
+}
+
+void TestTemporaries() {
+    runtime::DummyContext context;
+    Closure closure;
+    closure["x"s] = runtime::MakeNumber(1000);
+    closure["s"s] = ObjectHolder::Own(runtime::String("b"s));
+
+    // x * x + x * 3 - 1: only the value of the whole expression is allocated
+    Sub numbers(make_unique<Add>(make_unique<Mult>(make_unique<VariableValue>("x"s),
+                                                   make_unique<VariableValue>("x"s)),
+                                 make_unique<Mult>(make_unique<VariableValue>("x"s),
+                                                   make_unique<NumericConst>(3))),
+                make_unique<NumericConst>(1));
+    // "a" + str(x) + s
+    Add strings(make_unique<Add>(make_unique<StringConst>("a"s),
+                                 make_unique<Stringify>(make_unique<VariableValue>("x"s))),
+                make_unique<VariableValue>("s"s));
+    Comparison less(runtime::CompareOperation::LESS,
+                    make_unique<Mult>(make_unique<VariableValue>("x"s),
+                                      make_unique<VariableValue>("x"s)),
+                    make_unique<NumericConst>(1000001));
+
+    for (bool compile : {false, true}) {
+        auto run = [&](Statement& statement) {
+            return compile ? statement.Compile()(closure, context)
+                           : statement.Execute(closure, context);
+        };
+        const auto allocated = runtime::allocation_stats.allocated;
+        ASSERT_OBJECT_VALUE_EQUAL(run(numbers), 1002999);
+        ASSERT_EQUAL(runtime::allocation_stats.allocated, allocated + 1);
+        ASSERT_OBJECT_VALUE_EQUAL(run(strings), "a1000b"s);
+        ASSERT_EQUAL(runtime::allocation_stats.allocated, allocated + 2);
+        ASSERT(runtime::IsTrue(run(less)));
+        ASSERT_EQUAL(runtime::allocation_stats.allocated, allocated + 2);
+    }
+
+    // an operand which is not a number or a string is boxed and takes the generic path
+    closure["x"s] = ObjectHolder::Own(runtime::Float(0.5));
+    ASSERT_OBJECT_VALUE_EQUAL(numbers.Execute(closure, context), 0.75);
+}
+
 void TestCompound() {
     runtime::DummyContext context;
 
@@ -460,6 +551,7 @@ void RunUnitTests(TestRunner& tr) {
     RUN_TEST(tr, ast::TestNumericConst);
     RUN_TEST(tr, ast::TestStringConst);
     RUN_TEST(tr, ast::TestVariable);
+    RUN_TEST(tr, ast::TestDottedVariable);
     RUN_TEST(tr, ast::TestAssignment);
     RUN_TEST(tr, ast::TestFieldAssignment);
     RUN_TEST(tr, ast::TestPrintVariable);
@@ -470,6 +562,8 @@ void RunUnitTests(TestRunner& tr) {
     RUN_TEST(tr, ast::TestBadAddition);
     RUN_TEST(tr, ast::TestSuccessfulClassInstanceAdd);
     RUN_TEST(tr, ast::TestClassInstanceAddWithoutMethod);
+    RUN_TEST(tr, ast::TestQuickening);
+    RUN_TEST(tr, ast::TestTemporaries);
     RUN_TEST(tr, ast::TestCompound);
     RUN_TEST(tr, ast::TestFields);
     RUN_TEST(tr, ast::TestBaseClass);
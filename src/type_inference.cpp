@@ -0,0 +1,287 @@
+#include "type_inference.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+namespace ast {
+
+namespace {
+
+// Types of the values. NUMBER is always a Number, INTEGER may also be a BigInt
+// (an arithmetic result which may overflow). UNASSIGNED is the type of a variable
+// which has not been assigned yet: reading it throws, so it joins with any other type
+enum class Type : uint8_t { UNASSIGNED, NUMBER, INTEGER, STRING, BOOL, ANY };
+
+Type JoinTypes(Type lhs, Type rhs) {
+    if (lhs == rhs || rhs == Type::UNASSIGNED) {
+        return lhs;
+    }
+    if (lhs == Type::UNASSIGNED) {
+        return rhs;
+    }
+    const auto is_integer = [](Type type) {
+        return type == Type::NUMBER || type == Type::INTEGER;
+    };
+    return is_integer(lhs) && is_integer(rhs) ? Type::INTEGER : Type::ANY;
+}
+
+// Types of the variables of a closure
+using Environment = unordered_map<string, Type>;
+
+Type Lookup(const Environment& environment, const string& name) {
+    const auto it = environment.find(name);
+    return it == environment.end() ? Type::UNASSIGNED : it->second;
+}
+
+// Joins the environments after two branches into lhs
+void JoinEnvironments(Environment& lhs, const Environment& rhs) {
+    for (const auto& [name, type] : rhs) {
+        lhs[name] = JoinTypes(Lookup(lhs, name), type);
+    }
+}
+
+}  // namespace
+
+class TypeInference {
+public:
+    void Run(Statement& program) {
+        // the types of the fields grow with every pass, until the passes agree on them
+        do {
+            fields_ = assigned_fields_;
+            Environment globals;
+            Infer(program, globals);
+        } while (fields_ != assigned_fields_);
+
+        for (auto& [operation, operands] : operands_) {
+            if (operation->lhs_operator_ != nullptr || operation->rhs_operator_ != nullptr) {
+                // the operands are calculated as temporaries, see Operator
+                continue;
+            }
+            if (operands.lhs == Type::NUMBER && operands.rhs == Type::NUMBER) {
+                operation->quickening_.Prove(Quickening::Operands::NUMBERS);
+                ++quickening_stats.proven;
+            } else if (operands.lhs == Type::STRING && operands.rhs == Type::STRING
+                       && operands.strings) {
+                operation->quickening_.Prove(Quickening::Operands::STRINGS);
+                ++quickening_stats.proven;
+            }
+        }
+        for (auto& [if_else, condition] : conditions_) {
+            if (condition == Type::BOOL) {
+                if_else->bool_condition_ = true;
+                ++quickening_stats.proven;
+            }
+        }
+    }
+
+private:
+    // The operand types of an arithmetic operation or a comparison, joined over the passes
+    struct Operands {
+        Type lhs = Type::UNASSIGNED;
+        Type rhs = Type::UNASSIGNED;
+        // The operation is defined on two strings
+        bool strings = false;
+    };
+
+    Type Infer(Statement& statement, Environment& environment) {
+        if (dynamic_cast<NumericConst*>(&statement)) {
+            return Type::NUMBER;
+        }
+        if (dynamic_cast<StringConst*>(&statement)) {
+            return Type::STRING;
+        }
+        if (dynamic_cast<BoolConst*>(&statement)) {
+            return Type::BOOL;
+        }
+        if (dynamic_cast<FloatConst*>(&statement) || dynamic_cast<BigIntConst*>(&statement)
+            || dynamic_cast<None*>(&statement)
+            || dynamic_cast<NewDict*>(&statement)) {
+            return Type::ANY;
+        }
+        if (auto variable = dynamic_cast<VariableValue*>(&statement)) {
+            return InferVariable(*variable, environment);
+        }
+        if (auto assignment = dynamic_cast<Assignment*>(&statement)) {
+            const Type type = Infer(*assignment->rv_, environment);
+            environment[assignment->var_] = type;
+            return type;
+        }
+        if (auto assignment = dynamic_cast<FieldAssignment*>(&statement)) {
+            Infer(assignment->object_, environment);
+            const Type type = Infer(*assignment->rv_, environment);
+            auto& field = assigned_fields_[assignment->field_name_];
+            field = JoinTypes(field, type);
+            return type;
+        }
+        if (auto print = dynamic_cast<Print*>(&statement)) {
+            InferAll(print->args_, environment);
+            return Type::ANY;
+        }
+        if (auto call = dynamic_cast<MethodCall*>(&statement)) {
+            Infer(*call->object_, environment);
+            InferAll(call->args_, environment);
+            return Type::ANY;
+        }
+        if (auto new_instance = dynamic_cast<NewInstance*>(&statement)) {
+            InferAll(new_instance->args_, environment);
+            return Type::ANY;
+        }
+        if (auto range = dynamic_cast<NewRange*>(&statement)) {
+            Infer(*range->start_, environment);
+            Infer(*range->stop_, environment);
+            return Type::ANY;
+        }
+        if (auto stringify = dynamic_cast<Stringify*>(&statement)) {
+            Infer(*stringify->argument_, environment);
+            return Type::STRING;
+        }
+        if (auto negation = dynamic_cast<Not*>(&statement)) {
+            Infer(*negation->argument_, environment);
+            return Type::BOOL;
+        }
+        if (auto join = dynamic_cast<Join*>(&statement)) {
+            Infer(*join->separator_, environment);
+            Infer(*join->iterable_, environment);
+            return Type::STRING;
+        }
+        if (dynamic_cast<Add*>(&statement)) {
+            return InferArithmetic(static_cast<BinaryOperation&>(statement), true, environment);
+        }
+        if (dynamic_cast<Sub*>(&statement) || dynamic_cast<Mult*>(&statement)
+            || dynamic_cast<Div*>(&statement)) {
+            return InferArithmetic(static_cast<BinaryOperation&>(statement), false, environment);
+        }
+        if (auto comparison = dynamic_cast<Comparison*>(&statement)) {
+            RecordOperands(*comparison, true, environment);
+            return Type::BOOL;
+        }
+        if (dynamic_cast<Or*>(&statement) || dynamic_cast<And*>(&statement)) {
+            auto& operation = static_cast<BinaryOperation&>(statement);
+            Infer(*operation.lhs_, environment);
+            Infer(*operation.rhs_, environment);
+            return Type::BOOL;
+        }
+        if (auto compound = dynamic_cast<Compound*>(&statement)) {
+            InferAll(compound->args_, environment);
+            return Type::ANY;
+        }
+        if (auto body = dynamic_cast<MethodBody*>(&statement)) {
+            Infer(*body->body_, environment);
+            return Type::ANY;
+        }
+        if (auto return_statement = dynamic_cast<Return*>(&statement)) {
+            Infer(*return_statement->statement_, environment);
+            return Type::ANY;
+        }
+        if (auto definition = dynamic_cast<ClassDefinition*>(&statement)) {
+            const auto& cls = *definition->cls_.TryAs<runtime::Class>();
+            for (const auto& method : cls.GetMethods()) {
+                Environment locals{{"self"s, Type::ANY}};
+                for (const auto& param : method.formal_params) {
+                    locals[param] = Type::ANY;
+                }
+                Infer(*method.body, locals);
+            }
+            environment[cls.GetName()] = Type::ANY;
+            return Type::ANY;
+        }
+        if (auto if_else = dynamic_cast<IfElse*>(&statement)) {
+            InferIfElse(*if_else, environment);
+            return Type::ANY;
+        }
+        if (auto for_in = dynamic_cast<ForIn*>(&statement)) {
+            InferForIn(*for_in, environment);
+            return Type::ANY;
+        }
+        // a statement unknown here may assign any variable
+        for (auto& [name, type] : environment) {
+            type = Type::ANY;
+        }
+        return Type::ANY;
+    }
+
+    void InferAll(const vector<unique_ptr<Statement>>& statements, Environment& environment) {
+        for (const auto& statement : statements) {
+            Infer(*statement, environment);
+        }
+    }
+
+    Type InferVariable(const VariableValue& variable, const Environment& environment) {
+        if (variable.fields_.empty()) {
+            return Lookup(environment, variable.var_name_);
+        }
+        const auto it = fields_.find(variable.fields_.back());
+        return it == fields_.end() ? Type::UNASSIGNED : it->second;
+    }
+
+    void RecordOperands(BinaryOperation& operation, bool strings, Environment& environment) {
+        const Type lhs = Infer(*operation.lhs_, environment);
+        const Type rhs = Infer(*operation.rhs_, environment);
+        auto& operands = operands_[&operation];
+        operands.lhs = JoinTypes(operands.lhs, lhs);
+        operands.rhs = JoinTypes(operands.rhs, rhs);
+        operands.strings = strings;
+    }
+
+    Type InferArithmetic(BinaryOperation& operation, bool is_add, Environment& environment) {
+        RecordOperands(operation, is_add, environment);
+        const auto& operands = operands_[&operation];
+        const Type lhs = operands.lhs;
+        const Type rhs = operands.rhs;
+        if (is_add && lhs == Type::STRING && rhs == Type::STRING) {
+            return Type::STRING;
+        }
+        const Type joined = JoinTypes(lhs, rhs);
+        const bool integers = (lhs == Type::NUMBER || lhs == Type::INTEGER)
+            && (rhs == Type::NUMBER || rhs == Type::INTEGER);
+        return integers && joined != Type::ANY ? Type::INTEGER : Type::ANY;
+    }
+
+    void InferIfElse(IfElse& if_else, Environment& environment) {
+        auto& condition = conditions_[&if_else];
+        condition = JoinTypes(condition, Infer(*if_else.condition_, environment));
+        Environment else_environment = environment;
+        Infer(*if_else.if_body_, environment);
+        if (if_else.else_body_) {
+            Infer(*if_else.else_body_, else_environment);
+        }
+        JoinEnvironments(environment, else_environment);
+    }
+
+    void InferForIn(ForIn& for_in, Environment& environment) {
+        Infer(*for_in.iterable_, environment);
+        const Type item = dynamic_cast<NewRange*>(for_in.iterable_.get()) ? Type::NUMBER
+                                                                           : Type::ANY;
+        // the loop variable is None if the iterable is empty and it has not been assigned before
+        auto& variable = environment[for_in.var_];
+        if (variable == Type::UNASSIGNED) {
+            variable = Type::ANY;
+        }
+        while (true) {
+            Environment body_environment = environment;
+            body_environment[for_in.var_] = item;
+            Infer(*for_in.body_, body_environment);
+            Environment joined = environment;
+            JoinEnvironments(joined, body_environment);
+            if (joined == environment) {
+                break;
+            }
+            environment = std::move(joined);
+        }
+    }
+
+    // The types of the fields read in the current pass and assigned so far
+    unordered_map<string, Type> fields_;
+    unordered_map<string, Type> assigned_fields_;
+    unordered_map<BinaryOperation*, Operands> operands_;
+    unordered_map<IfElse*, Type> conditions_;
+};
+
+void InferTypes(Statement& program) {
+    TypeInference().Run(program);
+}
+
+}  // namespace ast
@@ -0,0 +1,19 @@
+# Runs the program with the interpreter (MYTHON) and the binary built from its C++ code
+# (EMITTED), and compares their outputs and exit codes. Run by ctest with cmake -P
+execute_process(COMMAND "${MYTHON}" "${PROGRAM}" "${OUTPUT_DIR}/emit_test_interpreted.txt"
+                RESULT_VARIABLE interpreted_result)
+execute_process(COMMAND "${EMITTED}"
+                OUTPUT_FILE "${OUTPUT_DIR}/emit_test_native.txt"
+                RESULT_VARIABLE native_result)
+file(READ "${OUTPUT_DIR}/emit_test_interpreted.txt" interpreted)
+file(READ "${OUTPUT_DIR}/emit_test_native.txt" native)
+
+if (NOT interpreted_result EQUAL native_result)
+    message(FATAL_ERROR "Emitted program fail: exit code ${native_result}, "
+                        "the interpreter ${interpreted_result}")
+endif ()
+if (NOT interpreted STREQUAL native)
+    message(FATAL_ERROR "Emitted program fail: the output differs\n"
+                        "interpreter:\n${interpreted}\nemitted:\n${native}")
+endif ()
+message("Emitted program OK")
@@ -0,0 +1,31 @@
+# Runs every program of PROGRAMS with the interpreter (MYTHON) compiling each method on its first
+# call, once into closures and once into machine code with --jit, and compares their outputs,
+# errors and exit codes. Run by ctest with cmake -P
+foreach (program ${PROGRAMS})
+    get_filename_component(name "${program}" NAME_WE)
+    foreach (backend closures jit)
+        set (options --tier-up=1)
+        if (backend STREQUAL "jit")
+            list(APPEND options --jit)
+        endif ()
+        execute_process(COMMAND "${MYTHON}" ${options} "${program}"
+                                "${OUTPUT_DIR}/${name}_${backend}.txt"
+                        RESULT_VARIABLE ${backend}_result
+                        ERROR_VARIABLE ${backend}_error)
+        file(READ "${OUTPUT_DIR}/${name}_${backend}.txt" ${backend}_output)
+    endforeach ()
+
+    if (NOT closures_result EQUAL jit_result)
+        message(FATAL_ERROR "JIT fail on ${name}: exit code ${jit_result}, "
+                            "the closures ${closures_result}")
+    endif ()
+    if (NOT closures_error STREQUAL jit_error)
+        message(FATAL_ERROR "JIT fail on ${name}: the error differs\n"
+                            "closures:\n${closures_error}\njit:\n${jit_error}")
+    endif ()
+    if (NOT closures_output STREQUAL jit_output)
+        message(FATAL_ERROR "JIT fail on ${name}: the output differs\n"
+                            "closures:\n${closures_output}\njit:\n${jit_output}")
+    endif ()
+endforeach ()
+message("JIT OK")